@@ -26,8 +26,9 @@ extern "C"
 
 #include "stm32f7xx_hal.h" // or your HAL header
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
-#include "stream_buffer.h"
+#include "event_groups.h"
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -38,6 +39,10 @@ extern "C"
 #define UAT_RX_BUFFER_SIZE 512     /**< Size of RX buffer */
 #endif
 
+#ifndef UAT_RX_RING_SIZE
+#define UAT_RX_RING_SIZE 512       /**< Size of the ISR-to-task receive ring, a power of two */
+#endif
+
 #ifndef UAT_TX_BUFFER_SIZE
 #define UAT_TX_BUFFER_SIZE 512     /**< Size of TX buffer */
 #endif
@@ -46,6 +51,31 @@ extern "C"
 #define UAT_MAX_CMD_HANDLERS 10    /**< Max number of command handlers */
 #endif
 
+/* Handlers known at build time. Define as a file name listing them, one
+ * UAT_HANDLER(command, function) per line, sorted by command in strcmp()
+ * order:
+ *
+ *     UAT_HANDLER("+CMTI:", sms_handler)
+ *     UAT_HANDLER("+CREG:", creg_handler)
+ *
+ * The list is compiled into a const table searched by binary search, so no
+ * registration runs at boot and the table takes no RAM; UAT_MAX_CMD_HANDLERS
+ * then only needs to cover runtime registrations.
+ * Functions must not be static. The longest prefix of a line wins across
+ * listed commands and runtime registrations, and a runtime registration of
+ * the same length overrides a listed command, so a short runtime catch-all
+ * such as "+C" does not hide longer listed commands. uAT_Init() fails if
+ * the list is out of order. */
+/* #define UAT_STATIC_HANDLERS "uat_handlers.def" */
+
+#ifndef UAT_MAX_SUBSCRIBERS
+#define UAT_MAX_SUBSCRIBERS 4      /**< Handlers of one command: its registered handler and uAT_Subscribe() ones */
+#endif
+
+#ifndef UAT_MATCH_MAX_NODES
+#define UAT_MATCH_MAX_NODES (UAT_MAX_CMD_HANDLERS * 16) /**< Dispatch trie nodes, about one per command byte */
+#endif
+
 #ifndef UAT_LINE_TERMINATOR
 #define UAT_LINE_TERMINATOR "\r\n" /**< Line terminator for AT commands */
 #endif
@@ -58,15 +88,113 @@ extern "C"
 #define UAT_MUTEX_TIMEOUT_MS 500   /**< Timeout for mutex acquisition in ms */
 #endif
 
+/* Commands sent with uAT_TxnSubmit(), uAT_SendReceive() or
+ * uAT_SendReceiveLines() wait in a queue of this many slots. The next one is
+ * sent as soon as the final line of the one before it arrives. A finished
+ * transaction keeps its slot until its result is collected. */
+#ifndef UAT_TXN_QUEUE_LEN
+#define UAT_TXN_QUEUE_LEN 4        /**< Transactions queued or awaiting collection */
+#endif
+
 #ifndef UAT_DMA_RX_SIZE
 #define UAT_DMA_RX_SIZE 512        /**< Size of DMA RX buffer */
 #endif
 
-/* Enable/disable DMA reception */
-#ifndef UAT_USE_DMA
+/* Enable/disable DMA reception. DMA is the default; define UAT_USE_IT
+ * to receive byte by byte with HAL_UART_Receive_IT() instead. */
+#if !defined(UAT_USE_DMA) && !defined(UAT_USE_IT)
 #define UAT_USE_DMA               /**< Define to use DMA for reception */
 #endif
 
+#ifndef UAT_IT_BATCH_SIZE
+#define UAT_IT_BATCH_SIZE 32       /**< Interrupt mode: bytes staged in the ISR before a hand-over */
+#endif
+
+/* Enable zero-copy line extraction from the circular DMA buffer (DMA mode only).
+ * The IDLE handler only publishes the DMA write index; uAT_Task finds lines
+ * in place and no receive ring is allocated. Extended handlers then get views
+ * into the DMA buffer. The DMA keeps receiving while they run; if it laps a
+ * line before its handlers return, the overrun is counted and the bytes it
+ * overwrote are dropped, see uAT_GetRxStats(). */
+/* #define UAT_DMA_ZERO_COPY */
+
+/* Receive with HAL ReceiveToIdle DMA (DMA mode only). The DMA channel must be
+ * in circular mode. HAL reports IDLE, half-transfer and transfer-complete
+ * events through HAL_UARTEx_RxEventCallback(), so long bursts are handed over
+ * at least twice per lap of the DMA buffer and no IRQ handler needs patching.
+ * The UART and RX DMA interrupts must have the same priority. */
+/* #define UAT_DMA_RX_EVENT */
+
+/* Receive into two DMA buffers in turn (DMA mode only). Each half of the DMA
+ * buffer is filled by one ReceiveToIdle transfer in normal (not circular) DMA
+ * mode and handed to uAT_Task on IDLE or when full, while the DMA fills the
+ * other half. Data arriving while uAT_Task still owns both halves is dropped
+ * and counted instead of overwriting unparsed data, see uAT_GetRxStats().
+ * Cannot be combined with UAT_DMA_ZERO_COPY or UAT_DMA_RX_EVENT. */
+/* #define UAT_DMA_PINGPONG */
+
+/* Run URC handlers in their own task. uAT_Task still matches every line, URCs
+ * first, but copies a line matched by a uAT_RegisterURC() handler into one of
+ * UAT_URC_QUEUE_LEN slots and wakes uAT_URCTask() to run the handler. Create
+ * uAT_URCTask at a higher priority than uAT_Task so URCs preempt response
+ * handlers. Queued lines are held in the line pool, see UAT_LINE_POOL_SIZE. */
+/* #define UAT_URC_TASK */
+
+#ifndef UAT_URC_QUEUE_LEN
+#define UAT_URC_QUEUE_LEN 4        /**< URC lines waiting for uAT_URCTask */
+#endif
+
+/* Run command handlers on a pool of worker tasks. Define as the number of
+ * workers, each created with uAT_WorkerTask() and its index as parameter.
+ * uAT_Task then only matches lines and queues each one to a worker, so a
+ * slow handler does not hold up reception. The worker is picked by command,
+ * so lines for one command run in order, one at a time, even when its
+ * handler is replaced meanwhile. A full worker queue
+ * makes uAT_Task wait, see uAT_GetWorkerStats(). Queued lines are held in
+ * the line pool, see UAT_LINE_POOL_SIZE. URCs still go to uAT_URCTask when
+ * UAT_URC_TASK is defined. */
+/* #define UAT_WORKER_TASKS 2 */
+
+#ifndef UAT_WORKER_QUEUE_LEN
+#define UAT_WORKER_QUEUE_LEN 4     /**< Lines waiting for each uAT_WorkerTask */
+#endif
+
+/* With UAT_URC_TASK or UAT_WORKER_TASKS, a line handed to other tasks is
+ * copied once into a pooled buffer shared by every handler it goes to, and
+ * the buffer is reused once the last of them returns. Each buffer takes
+ * about UAT_RX_BUFFER_SIZE bytes of RAM. uAT_Task waits when all are in use. */
+#ifndef UAT_LINE_POOL_SIZE
+#define UAT_LINE_POOL_SIZE 8       /**< Received lines shared by queued handler calls */
+#endif
+
+/* Lend responses from a pool instead of copying them into caller buffers.
+ * Define as the number of pooled buffers of UAT_RESP_BUF_SIZE bytes each.
+ * A transaction requested with loan set captures its lines straight into a
+ * free buffer, laid out like a uAT_SendReceiveLines() arena, and hands it
+ * to the caller with the result; see uAT_SendReceiveLoan() and
+ * uAT_ReleaseResponse(). Buffers are never cleared. */
+/* #define UAT_RESP_POOL 2 */
+
+#ifndef UAT_RESP_BUF_SIZE
+#define UAT_RESP_BUF_SIZE 1024     /**< Bytes per pooled response buffer, line views included */
+#endif
+
+/* Count and time every handler call, and keep the start of lines no handler
+ * matched, see uAT_GetHandlerStats() and uAT_GetUnmatchedStats(). Times are
+ * in UAT_PROFILE_NOW() units: core cycles from the DWT cycle counter where
+ * CMSIS provides DWT, otherwise nanoseconds from CLOCK_MONOTONIC (host
+ * builds). Define UAT_PROFILE_NOW() to use another 32-bit counter. Costs two
+ * counter reads per handler call and about 24 bytes of RAM per handler slot. */
+/* #define UAT_ENABLE_PROFILING */
+
+#ifndef UAT_PROFILE_UNMATCHED
+#define UAT_PROFILE_UNMATCHED 4    /**< Unmatched line prefixes kept */
+#endif
+
+#ifndef UAT_PROFILE_PREFIX_LEN
+#define UAT_PROFILE_PREFIX_LEN 12  /**< Characters kept of each unmatched line */
+#endif
+
 /* -------------------- End Configuration -------------------- */
 
     /** 
@@ -84,7 +212,8 @@ extern "C"
         UAT_ERR_SEND_FAIL,      ///< Failed to send data
         UAT_ERR_INIT_FAIL,      ///< Initialization failed
         UAT_ERR_INT,            ///< Internal error
-        UAT_ERR_RESOURCE        ///< Resource allocation failed
+        UAT_ERR_RESOURCE,       ///< Resource allocation failed
+        UAT_ERR_RESPONSE        ///< Response ended without the expected line
     } uAT_Result_t;
 
     // Forward declaration of the uAT handle (opaque in user code)
@@ -95,6 +224,201 @@ extern "C"
     // Ex: if command == "OK", handler receives "param1,param2" when lineBuf == "OK param1,param2\r\n"
     typedef void (*uAT_CommandHandler)(const char *args);
 
+    // Extended command handler callback prototype
+    // args points to the first character after the registered command and
+    // leading spaces, inside the receive buffer: it is not null-terminated
+    // and only valid during the call. len excludes the line terminator.
+    // ctx is the pointer given at registration, tick the tick count when
+    // uAT_Task picked up the received line.
+    // Ex: if command == "OK", handler receives "param1,param2" and len 13 when lineBuf == "OK param1,param2\r\n"
+    typedef void (*uAT_CommandHandlerEx)(const char *args, size_t len, void *ctx, TickType_t tick);
+
+    /**
+     * @brief One received line of a multi-line response
+     *
+     * text excludes the line terminator but is null-terminated.
+     */
+    typedef struct {
+        const char *text;         ///< Line text, stored in the caller's arena
+        size_t len;               ///< Length of text
+    } uAT_LineView_t;
+
+    // Multi-line response callback prototype, see uAT_SendReceiveLines()
+    // lines[0] to lines[count - 1] are the response lines in the order
+    // received, ending with the final line; only valid during the call.
+    typedef void (*uAT_LinesHandler)(const uAT_LineView_t *lines, size_t count, void *ctx);
+
+    // Transaction handle, see uAT_TxnSubmit(); 0 is never a valid handle
+    typedef uint32_t uAT_TxnHandle_t;
+
+    /**
+     * @brief Response lines lent from the response pool, see UAT_RESP_POOL
+     */
+    typedef struct {
+        const uAT_LineView_t *lines;    ///< Lines in order, ending with the final line, or NULL
+        size_t count;                   ///< Number of lines
+    } uAT_ResponseLoan_t;
+
+    /**
+     * @brief V.250 and 3GPP final result codes ending a transaction
+     */
+    typedef enum {
+        UAT_FINAL_NONE = 0,     ///< No final result code: timed out, or ended by a prompt or a line in finals
+        UAT_FINAL_OK,           ///< "OK"
+        UAT_FINAL_CONNECT,      ///< "CONNECT", with or without a rate
+        UAT_FINAL_ERROR,        ///< "ERROR"
+        UAT_FINAL_CME_ERROR,    ///< "+CME ERROR: <err>"
+        UAT_FINAL_CMS_ERROR,    ///< "+CMS ERROR: <err>"
+        UAT_FINAL_NO_CARRIER,   ///< "NO CARRIER"
+        UAT_FINAL_BUSY,         ///< "BUSY"
+        UAT_FINAL_NO_ANSWER,    ///< "NO ANSWER"
+        UAT_FINAL_NO_DIALTONE   ///< "NO DIALTONE"
+    } uAT_FinalCode_t;
+
+    /**
+     * @brief Outcome of a finished transaction
+     *
+     * result is UAT_OK whenever the modem ended the response, whatever the
+     * final result code; finalCode and errorCode tell which one it was.
+     */
+    typedef struct {
+        uAT_Result_t result;            ///< UAT_OK, UAT_ERR_TIMEOUT or UAT_ERR_SEND_FAIL (command or payload)
+        int32_t terminator;             ///< Index in terminators of the first line matching one, -1 if none
+        int32_t finalMatch;             ///< Index in finals of the line that ended it, -1 if none
+        uAT_FinalCode_t finalCode;      ///< Final result code of the final line, if it is one
+        int32_t errorCode;              ///< Number of a +CME/+CMS ERROR, -1 if none or verbose
+        size_t lineCount;               ///< Lines received, including the final line; the
+                                        ///< lines before it are the intermediate ones
+        size_t linesDropped;            ///< Lines the sink had no room for, in part or whole
+        size_t bytesCaptured;           ///< Text bytes stored in the sink
+        size_t linesSkipped;            ///< Unsolicited lines left out of the sink and lineCount
+        uAT_ResponseLoan_t loan;        ///< Lent lines if requested, see uAT_ReleaseResponse()
+    } uAT_TxnResult_t;
+
+    // Transaction completion callback prototype, see uAT_TxnRequest_t
+    // Runs in the task that finished the transaction, usually uAT_Task, so
+    // it must not block; it may submit further transactions. result is only
+    // valid during the call, apart from a loan which the callback now owns,
+    // and handle no longer valid once it is called.
+    typedef void (*uAT_TxnCallback)(uAT_TxnHandle_t handle, const uAT_TxnResult_t *result, void *ctx);
+
+    /**
+     * @brief A command for the transaction queue, see uAT_TxnSubmit()
+     *
+     * Lines received from sending cmd up to and including the final line
+     * are stored in the sink. The final line is the first final result code
+     * (see uAT_FinalCode_t) or "> " prompt, so an error ends the transaction
+     * at once. With payload set, the first prompt is answered with the
+     * payload instead, such as SMS text ending with Ctrl-Z, and the
+     * transaction goes on to the final result code after it; no other
+     * command is sent in between. A line starting with one of terminators, such as "+CSQ:",
+     * only marks the transaction successful and does not end it, so the
+     * modem's "OK" after it never ends the next transaction instead. A line
+     * starting with one of finals, such as "SHUT OK" or "SEND OK", ends it
+     * like a final result code, for commands the modem answers without
+     * one; list it in terminators as well to mark success. The
+     * sink gets the lines as text into outBuf like uAT_SendReceive(), or as
+     * line views into arena like uAT_SendReceiveLines(). At most one of them
+     * is given; with neither, only the result is reported. With loan set
+     * instead, the lines go into a pooled buffer lent with the result, so
+     * the caller needs no buffer of its own. cmd, terminators, finals,
+     * payload and the sink must stay valid until the result is collected or
+     * the transaction cancelled.
+     *
+     * Unsolicited lines arriving meanwhile are kept out of the sink and only
+     * counted; they still reach their handlers. With echoPrefix set, an
+     * intermediate line belongs to the transaction only if it starts with
+     * it. Otherwise every line does except those of handlers registered
+     * with uAT_RegisterURC(), unless they echo the command's name, such as
+     * "+CREG:" for "AT+CREG?".
+     *
+     * Completion can be signalled in any mix of three ways. With onComplete
+     * the result goes to the callback and the slot is freed after it
+     * returns; otherwise it waits for uAT_TxnPoll() or uAT_TxnWait(). The
+     * task notification and the event group bits are set after that, so a
+     * task driving many transactions can wait on one of them and then
+     * collect every finished handle. Fields left zero are not used.
+     */
+    typedef struct {
+        const char *cmd;                ///< Null-terminated AT command (no CRLF)
+        const char *const *terminators; ///< Prefixes of lines marking success, ending with NULL, or NULL
+        const char *const *finals;      ///< Prefixes of lines ending the transaction, ending with NULL, or NULL
+        const char *payload;            ///< Data sent after the "> " prompt, or NULL
+        size_t payloadLen;              ///< Bytes of payload, or 0 for strlen(payload)
+        const char *echoPrefix;         ///< Prefix of the intermediate lines, e.g. "+CSQ:", or NULL
+        char *outBuf;                   ///< Response text, null-terminated, or NULL
+        size_t bufLen;                  ///< Size of outBuf
+        void *arena;                    ///< Response lines, aligned like a pointer, or NULL
+        size_t arenaLen;                ///< Size of arena
+        bool loan;                      ///< Capture into a lent pooled buffer, needs UAT_RESP_POOL
+        TickType_t timeout;             ///< Ticks from sending cmd to the final line, or portMAX_DELAY
+        uAT_TxnCallback onComplete;     ///< Called with the result once finished, or NULL
+        void *ctx;                      ///< Pointer passed to onComplete unchanged
+        TaskHandle_t notifyTask;        ///< Task notified once finished, or NULL
+        uint32_t notifyBits;            ///< Bits set in notifyTask's notification value
+        EventGroupHandle_t eventGroup;  ///< Event group signalled once finished, or NULL
+        EventBits_t eventBits;          ///< Bits set in eventGroup
+    } uAT_TxnRequest_t;
+
+    /**
+     * @brief Receive path statistics
+     *
+     * Counters run from uAT_Init() and wrap around at 2^32. Each field is a
+     * single word written by one context only (the receive ISR or uAT_Task),
+     * so reading them needs no lock; fields are not sampled as one snapshot.
+     */
+    typedef struct {
+        uint32_t bytesReceived;   ///< Bytes received from the UART
+        uint32_t bytesDropped;    ///< Bytes dropped in the ISR because uAT_Task was behind
+        uint32_t dmaOverruns;     ///< DMA laps over unparsed data (zero-copy) or dropped blocks (ping-pong)
+        uint32_t rxHighWater;     ///< Highest number of bytes waiting for uAT_Task
+        uint32_t linesTruncated;  ///< Lines longer than UAT_RX_BUFFER_SIZE, dropped up to their terminator
+        uint32_t resyncs;         ///< Times line assembly restarted after received data was lost
+        uint32_t dmaRestartFailures; ///< Times the DMA could not be restarted after an event (ping-pong); uAT_Task retries
+    } uAT_RxStats_t;
+
+#ifdef UAT_WORKER_TASKS
+    /**
+     * @brief Worker queue statistics
+     *
+     * Read without a lock, like uAT_RxStats_t.
+     */
+    typedef struct {
+        uint32_t queueLen;        ///< Lines the queue holds, UAT_WORKER_QUEUE_LEN
+        uint32_t queued;          ///< Lines queued or being handled now
+        uint32_t highWater;       ///< Most lines queued at once
+        uint32_t stalls;          ///< Times uAT_Task waited because the queue was full
+    } uAT_WorkerStats_t;
+#endif
+
+#ifdef UAT_ENABLE_PROFILING
+    /**
+     * @brief Execution statistics of one handler
+     *
+     * Counters start at the first call of the handler. Times are in
+     * UAT_PROFILE_NOW() units. Read without a lock, so a call finishing
+     * during the read may show in some fields only.
+     */
+    typedef struct {
+        const char *command;      ///< Command or pattern the handler is registered for
+        uint32_t hits;            ///< Handler calls
+        uint64_t totalTime;       ///< Sum of all call times
+        uint32_t maxTime;         ///< Longest call
+        uint32_t lastTime;        ///< Latest call
+    } uAT_HandlerStats_t;
+
+    /**
+     * @brief Lines no handler matched
+     *
+     * The final line completing a transaction is not counted.
+     */
+    typedef struct {
+        uint32_t lines;           ///< Unmatched lines since uAT_Init()
+        uint32_t kept;            ///< Prefixes below, at most UAT_PROFILE_UNMATCHED
+        char prefixes[UAT_PROFILE_UNMATCHED][UAT_PROFILE_PREFIX_LEN + 1]; ///< Newest first, without terminator
+    } uAT_UnmatchedStats_t;
+#endif
+
     // API
 
     /**
@@ -118,6 +442,57 @@ extern "C"
      */
     uAT_Result_t uAT_RegisterCommand(const char *cmd, uAT_CommandHandler handler);
 
+    /**
+     * @brief  Register a command string and an extended handler
+     *
+     * Unlike uAT_RegisterCommand(), the handler gets a length-bounded view
+     * of the arguments in place, so the line is not copied to null-terminate
+     * it, and a context pointer instead of having to reach for globals.
+     * Registering a command again replaces its handler of either kind.
+     *
+     * @param  cmd     Null-terminated string to match at start of line
+     * @param  handler Function called when a line beginning with cmd arrives
+     * @param  ctx     Pointer passed to handler unchanged, may be NULL
+     * @return UAT_OK if registered, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If cmd or handler is NULL
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_RESOURCE: If handler table is full
+     */
+    uAT_Result_t uAT_RegisterCommandEx(const char *cmd, uAT_CommandHandlerEx handler, void *ctx);
+
+    /**
+     * @brief  Register a glob pattern and its handler
+     *
+     * Registers one handler for a family of lines, e.g. "+C?REG:" for
+     * +CREG:, +CGREG: and +CEREG:, or "+Q*URC:". '?' matches any one byte,
+     * '*' any run of bytes, "[abc]" or "[a-c]" one listed byte and "[!abc]"
+     * any other byte; '\\' makes the next byte literal. The pattern is
+     * compiled into the dispatch trie next to the plain commands, so it is
+     * matched in the same pass over the line. The handler gets the rest of
+     * the line after the shortest match. Unregister with
+     * uAT_UnregisterCommand().
+     *
+     * @param  pattern Null-terminated glob pattern to match at start of line
+     * @param  handler Function called when a line matching pattern arrives
+     * @return UAT_OK if registered, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If pattern or handler is NULL, or pattern is malformed
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_RESOURCE: If handler table, trie or class table is full
+     */
+    uAT_Result_t uAT_RegisterPattern(const char *pattern, uAT_CommandHandler handler);
+
+    /**
+     * @brief  Register a glob pattern and an extended handler, see uAT_RegisterPattern()
+     * @param  pattern Null-terminated glob pattern to match at start of line
+     * @param  handler Function called when a line matching pattern arrives
+     * @param  ctx     Pointer passed to handler unchanged, may be NULL
+     * @return UAT_OK if registered, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If pattern or handler is NULL, or pattern is malformed
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_RESOURCE: If handler table, trie or class table is full
+     */
+    uAT_Result_t uAT_RegisterPatternEx(const char *pattern, uAT_CommandHandlerEx handler, void *ctx);
+
     /**
      * @brief  Register a URC handler with high priority
      * @param  cmd     Null-terminated string to match at start of line
@@ -130,11 +505,57 @@ extern "C"
     uAT_Result_t uAT_RegisterURC(const char *cmd, uAT_CommandHandler handler);
 
     /**
-     * @brief  Unregister a previously registered command
-     * @note   This function should be called with `uat.handlerMutex` already taken
+     * @brief  Register a URC with an extended handler, see uAT_RegisterCommandEx()
+     * @param  cmd     Null-terminated string to match at start of line
+     * @param  handler Function called when a line beginning with cmd arrives
+     * @param  ctx     Pointer passed to handler unchanged, may be NULL
+     * @return UAT_OK if registered, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If cmd or handler is NULL
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_RESOURCE: If handler table is full
+     */
+    uAT_Result_t uAT_RegisterURCEx(const char *cmd, uAT_CommandHandlerEx handler, void *ctx);
+
+    /**
+     * @brief  Add a handler to the lines beginning with a command
+     *
+     * Unlike registering, subscribing never replaces a handler: each line
+     * of the command goes to every handler added for it, registered or
+     * subscribed, in the order they were added, a URC first. Subscribers run like
+     * command handlers, in uAT_Task or on a worker. All of them get a view
+     * of the same copy of the line, so handlers must not keep it after
+     * returning. Up to UAT_MAX_SUBSCRIBERS handlers per command; each
+     * subscriber takes one of the UAT_MAX_CMD_HANDLERS slots.
+     *
+     * @param  cmd     Null-terminated string to match at start of line
+     * @param  handler Function called when a line beginning with cmd arrives
+     * @param  ctx     Pointer passed to handler unchanged, may be NULL
+     * @return UAT_OK if subscribed or already subscribed, or error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If cmd or handler is NULL
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_RESOURCE: If handler table is full, or cmd has UAT_MAX_SUBSCRIBERS handlers
+     */
+    uAT_Result_t uAT_Subscribe(const char *cmd, uAT_CommandHandlerEx handler, void *ctx);
+
+    /**
+     * @brief  Remove a handler added with uAT_Subscribe()
+     * @param  cmd     Command the handler subscribed to
+     * @param  handler Handler passed to uAT_Subscribe()
+     * @param  ctx     Context passed to uAT_Subscribe()
+     * @return UAT_OK if unsubscribed, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If cmd or handler is NULL
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
+     *         - UAT_ERR_NOT_FOUND: If handler and ctx are not subscribed to cmd
+     */
+    uAT_Result_t uAT_Unsubscribe(const char *cmd, uAT_CommandHandlerEx handler, void *ctx);
+
+    /**
+     * @brief  Unregister a previously registered command or pattern
+     * @note   Subscribers of the command stay, see uAT_Unsubscribe()
      * @param  cmd Null-terminated string of the command to unregister
      * @return UAT_OK if unregistered, or appropriate error code on failure:
      *         - UAT_ERR_INVALID_ARG: If cmd is NULL
+     *         - UAT_ERR_BUSY: If mutex acquisition fails
      *         - UAT_ERR_NOT_FOUND: If command not found in handler table
      */
     uAT_Result_t uAT_UnregisterCommand(const char *cmd);
@@ -152,17 +573,31 @@ extern "C"
 
     /**
      * @brief  Send a command and wait for a specific response prefix.
+     *
+     * Lines received meanwhile are copied to outBuf and still dispatched to
+     * their handlers. The call returns once the response ends with a final
+     * result code such as "OK" or "ERROR", see uAT_FinalCode_t, which is not
+     * dispatched; a line starting with expected must have come by then. An
+     * expected line not starting with '+', such as "SHUT OK" or "SEND OK",
+     * also ends the response, since some commands get no final result code
+     * after it; an information response such as "+CSQ:" is always followed
+     * by one. The command waits its turn in the transaction queue, see
+     * uAT_TxnSubmit(); timeoutTicks counts from this call.
+     *
      * @param  cmd            Null-terminated AT command (no CRLF)
      * @param  expected       Prefix to match (e.g. "OK" or "+CREG")
-     * @param  outBuf         Buffer to receive the full line (incl. CRLF)
+     * @param  outBuf         Buffer to receive every solicited response line
+     *                        up to and including the final one, each with
+     *                        its CRLF, null-terminated
      * @param  bufLen         Length of outBuf
      * @param  timeoutTicks   How many RTOS ticks to wait
      * @return UAT_OK on success, or appropriate error code on failure:
      *         - UAT_ERR_INVALID_ARG: If any parameter is invalid
-     *         - UAT_ERR_BUSY: If another SendReceive operation is in progress
-     *         - UAT_ERR_INT: If internal error occurs
+     *         - UAT_ERR_BUSY: If no transaction slot was freed in time
      *         - UAT_ERR_SEND_FAIL: If command transmission fails
      *         - UAT_ERR_TIMEOUT: If response not received within timeout
+     *         - UAT_ERR_RESPONSE: If the response ended without the
+     *           expected line, e.g. on "ERROR"; it is in the response too
      */
     uAT_Result_t uAT_SendReceive(const char *cmd,
                                  const char *expected,
@@ -170,20 +605,251 @@ extern "C"
                                  size_t bufLen,
                                  TickType_t timeoutTicks);
 
+    /**
+     * @brief  Send a command and collect every response line into an arena
+     *
+     * Like uAT_SendReceive(), but each line received up to and including the
+     * final one is stored in arena as it arrives: an array of line views
+     * from the start of the arena, their text from the end. handler gets the
+     * whole array once, so line N is lines[N] without scanning the response.
+     * A few bytes more than the response text plus one uAT_LineView_t per
+     * line is enough.
+     *
+     * @param  cmd          Null-terminated AT command (no CRLF)
+     * @param  expected     Prefix of a line the response must contain (e.g. "OK")
+     * @param  arena        Storage for the lines, aligned like a pointer
+     * @param  arenaLen     Size of arena
+     * @param  handler      Called with the lines before this returns
+     * @param  ctx          Pointer passed to handler unchanged, may be NULL
+     * @param  timeoutTicks How many RTOS ticks to wait
+     * @return UAT_OK on success, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If any parameter is invalid or arena is misaligned
+     *         - UAT_ERR_BUSY: If no transaction slot was freed in time
+     *         - UAT_ERR_SEND_FAIL: If command transmission fails
+     *         - UAT_ERR_TIMEOUT: If response not received within timeout
+     *         - UAT_ERR_RESPONSE: If the response ended without the
+     *           expected line, e.g. on "ERROR"; handler still got the lines
+     *         - UAT_ERR_RESOURCE: If lines did not fit in arena; handler
+     *           still got the lines that did
+     */
+    uAT_Result_t uAT_SendReceiveLines(const char *cmd,
+                                      const char *expected,
+                                      void *arena,
+                                      size_t arenaLen,
+                                      uAT_LinesHandler handler,
+                                      void *ctx,
+                                      TickType_t timeoutTicks);
+
+#ifdef UAT_RESP_POOL
+    /**
+     * @brief  Send a command and borrow its response from the response pool
+     *
+     * Like uAT_SendReceive(), but the lines are captured into a pooled
+     * buffer and lent to the caller as line views, without clearing or
+     * copying anything. Release the loan with uAT_ReleaseResponse() whenever
+     * loan->lines is not NULL.
+     *
+     * @param  cmd          Null-terminated AT command (no CRLF)
+     * @param  expected     Prefix of a line the response must contain, or
+     *                      NULL to take any response
+     * @param  loan         Set to the lent lines once the modem answered
+     * @param  timeoutTicks How many RTOS ticks to wait
+     * @return UAT_OK on success, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If any parameter is invalid
+     *         - UAT_ERR_BUSY: If no transaction slot was freed in time
+     *         - UAT_ERR_SEND_FAIL: If command transmission fails
+     *         - UAT_ERR_TIMEOUT: If response not received within timeout
+     *         - UAT_ERR_RESPONSE: If the response ended without the
+     *           expected line; the lines are still lent
+     *         - UAT_ERR_RESOURCE: If every pooled buffer is lent, or lines
+     *           did not fit in one; those that did are still lent
+     */
+    uAT_Result_t uAT_SendReceiveLoan(const char *cmd,
+                                     const char *expected,
+                                     uAT_ResponseLoan_t *loan,
+                                     TickType_t timeoutTicks);
+
+    /**
+     * @brief  Give a lent response buffer back to the pool
+     *
+     * @param  loan  Loan from uAT_SendReceiveLoan() or a transaction
+     *               result; cleared on return
+     * @return UAT_OK on success, or UAT_ERR_INVALID_ARG if loan is NULL or
+     *         not lent
+     */
+    uAT_Result_t uAT_ReleaseResponse(uAT_ResponseLoan_t *loan);
+#endif
+
+    /**
+     * @brief  Queue a command and return without waiting for its response
+     *
+     * The command is sent right away if no other transaction is in progress,
+     * otherwise by uAT_Task as soon as the final line of the one before it
+     * arrives. Lines received meanwhile still reach their handlers; the
+     * final line does not. Collect the result with uAT_TxnPoll() or
+     * uAT_TxnWait(), or give the slot back with uAT_TxnCancel().
+     *
+     * Commands go out one at a time in the order they were submitted, so a
+     * command waits for every one before it to end or time out. A finished
+     * transaction keeps its slot until it is collected but no longer holds
+     * up the commands behind it. With all UAT_TXN_QUEUE_LEN slots in use,
+     * this waits up to req->timeout for one to be freed; called from
+     * uAT_Task, e.g. from a handler or callback, it never waits.
+     *
+     * @param  req     Command, terminators, sink and timeout
+     * @param  handle  Set to the handle of the queued transaction
+     * @return UAT_OK on success, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If a parameter is invalid, more than
+     *           one sink is given or arena is misaligned
+     *         - UAT_ERR_BUSY: If no slot was freed within req->timeout
+     *         - UAT_ERR_RESOURCE: If loan is set and every pooled buffer is lent
+     */
+    uAT_Result_t uAT_TxnSubmit(const uAT_TxnRequest_t *req, uAT_TxnHandle_t *handle);
+
+    /**
+     * @brief  Send a command without blocking and get the result in a callback
+     *
+     * Shorthand for uAT_TxnSubmit() with a text sink and onComplete, so one
+     * task can keep many commands outstanding without a stack per waiter.
+     * The command is queued like any other transaction.
+     *
+     * @param  cmd          Null-terminated AT command (no CRLF)
+     * @param  terminators  Prefixes of lines marking success, ending with NULL, or NULL
+     * @param  outBuf       Response text, null-terminated, or NULL
+     * @param  bufLen       Size of outBuf
+     * @param  timeout      Ticks from sending cmd to the final line, or portMAX_DELAY
+     * @param  onComplete   Called with the result once finished, or NULL
+     * @param  ctx          Pointer passed to onComplete unchanged, may be NULL
+     * @param  handle       Set to the transaction handle, may be NULL if
+     *                      onComplete is given
+     * @return UAT_OK on success, or appropriate error code on failure:
+     *         - UAT_ERR_INVALID_ARG: If a parameter is invalid, or both
+     *           onComplete and handle are NULL
+     *         - UAT_ERR_BUSY: If no transaction slot was freed in time
+     */
+    uAT_Result_t uAT_SendAsync(const char *cmd,
+                               const char *const *terminators,
+                               char *outBuf,
+                               size_t bufLen,
+                               TickType_t timeout,
+                               uAT_TxnCallback onComplete,
+                               void *ctx,
+                               uAT_TxnHandle_t *handle);
+
+    /**
+     * @brief  Collect the result of a transaction if it has finished
+     *
+     * @param  handle  Handle from uAT_TxnSubmit()
+     * @param  result  Set to the outcome once finished, may be NULL
+     * @return UAT_OK if finished; the handle is no longer valid, or:
+     *         - UAT_ERR_BUSY: If the transaction is queued or in progress
+     *         - UAT_ERR_NOT_FOUND: If handle is unknown or already collected,
+     *           or the result went to an onComplete callback
+     */
+    uAT_Result_t uAT_TxnPoll(uAT_TxnHandle_t handle, uAT_TxnResult_t *result);
+
+    /**
+     * @brief  Wait for a transaction to finish and collect its result
+     *
+     * @param  handle     Handle from uAT_TxnSubmit()
+     * @param  result     Set to the outcome once finished, may be NULL
+     * @param  waitTicks  How many RTOS ticks to wait
+     * @return UAT_OK if finished; the handle is no longer valid, or:
+     *         - UAT_ERR_TIMEOUT: If still pending after waitTicks; the
+     *           transaction goes on and the handle stays valid
+     *         - UAT_ERR_NOT_FOUND: If handle is unknown or already collected
+     */
+    uAT_Result_t uAT_TxnWait(uAT_TxnHandle_t handle, uAT_TxnResult_t *result, TickType_t waitTicks);
+
+    /**
+     * @brief  Drop a transaction and give its slot back
+     *
+     * A queued command is never sent. For a command already sent, capture
+     * stops before this returns and the next command is sent. Either way the
+     * sink is no longer written once this returns. A transaction another task
+     * is sending or finishing at that moment is freed by that task, so this
+     * never waits for it.
+     *
+     * @param  handle  Handle from uAT_TxnSubmit()
+     * @return UAT_OK on success, or UAT_ERR_NOT_FOUND if handle is unknown
+     *         or already collected
+     */
+    uAT_Result_t uAT_TxnCancel(uAT_TxnHandle_t handle);
+
     /**
      * @brief  FreeRTOS task to process incoming lines and dispatch handlers
      * @param  params Unused
      */
     void uAT_Task(void *params);
 
+#ifdef UAT_URC_TASK
+    /**
+     * @brief  FreeRTOS task to run URC handlers, at a higher priority than uAT_Task
+     * @param  params Unused
+     */
+    void uAT_URCTask(void *params);
+#endif
+
+#ifdef UAT_WORKER_TASKS
+    /**
+     * @brief  FreeRTOS task to run command handlers queued by uAT_Task
+     * @param  params Worker index, 0 to UAT_WORKER_TASKS - 1, cast to a pointer
+     */
+    void uAT_WorkerTask(void *params);
+#endif
+
 // ISR hooks (implement or forward in application IRQ)
-#ifdef UAT_USE_DMA
     /**
      * @brief  Must be called from UART IRQ handler on IDLE line event
-     *         Extracts new bytes from DMA buffer into stream buffer
-     * @return nothing
+     *         Extracts new bytes from DMA buffer into the receive ring, or with
+     *         UAT_DMA_ZERO_COPY only publishes the new DMA write index.
+     *         Not needed with UAT_DMA_RX_EVENT, where HAL_UARTEx_RxEventCallback()
+     *         does the same on IDLE, half-transfer and transfer-complete.
+     *         With UAT_USE_IT hands over the bytes staged by the RX ISR
+     * @return true if the new data was handed to uAT_Task, false on error
      */
     bool uAT_UART_IdleHandler(void);
+
+    /**
+     * @brief  Get the receive path statistics
+     * @note   Lock-free, may be called from any task
+     * @param  stats Pointer to store the counters
+     * @return UAT_OK on success, or UAT_ERR_INVALID_ARG if stats is NULL
+     */
+    uAT_Result_t uAT_GetRxStats(uAT_RxStats_t *stats);
+
+#ifdef UAT_WORKER_TASKS
+    /**
+     * @brief  Get the queue depth and occupancy of one worker
+     * @note   Lock-free, may be called from any task
+     * @param  worker Worker index, 0 to UAT_WORKER_TASKS - 1
+     * @param  stats  Pointer to store the counters
+     * @return UAT_OK on success, or UAT_ERR_INVALID_ARG if worker or stats is invalid
+     */
+    uAT_Result_t uAT_GetWorkerStats(uint32_t worker, uAT_WorkerStats_t *stats);
+#endif
+
+#ifdef UAT_ENABLE_PROFILING
+    /**
+     * @brief  Get the execution statistics of every handler called so far
+     * @note   Lock-free, may be called from any task. Counters of an
+     *         unregistered command are kept until its slot is reused
+     * @param  stats    Array to store the statistics
+     * @param  maxStats Number of entries in stats
+     * @param  count    Pointer to store the number of entries written
+     * @return UAT_OK on success, UAT_ERR_INVALID_ARG if stats or count is NULL,
+     *         or UAT_ERR_RESOURCE if more handlers than maxStats were called
+     */
+    uAT_Result_t uAT_GetHandlerStats(uAT_HandlerStats_t *stats, size_t maxStats, size_t *count);
+
+    /**
+     * @brief  Get the count and the latest prefixes of lines no handler matched
+     * @note   Lock-free, may be called from any task; never waits for uAT_Task
+     * @param  stats Pointer to store the statistics
+     * @return UAT_OK on success, UAT_ERR_INVALID_ARG if stats is NULL, or
+     *         UAT_ERR_BUSY if uAT_Task was recording a line meanwhile; try again
+     */
+    uAT_Result_t uAT_GetUnmatchedStats(uAT_UnmatchedStats_t *stats);
 #endif
 
     /**
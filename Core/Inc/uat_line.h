@@ -0,0 +1,138 @@
+/**
+ * @file uat_line.h
+ * @brief Block-oriented, resumable line assembler
+ *
+ * This module splits a byte stream into terminator-delimited lines. Data is
+ * written in blocks directly into the assembler's buffer, only the newly
+ * written bytes are scanned for the terminator, and a partial line is kept
+ * across calls until the rest of it arrives. Only complete lines are returned.
+ *
+ * A line that cannot be parsed correctly, because it is longer than the
+ * buffer or because received data was lost, is never returned: the
+ * assembler drops it and discards input up to the next terminator.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#ifndef UAT_LINE_H
+#define UAT_LINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Line assembler state
+ *
+ * The buffer holds [start, end) of received but not yet returned bytes;
+ * bytes before scan have already been searched for the terminator.
+ */
+typedef struct
+{
+    char *buf;           ///< Caller-provided storage
+    size_t size;         ///< Capacity of buf, also the maximum line length
+    size_t start;        ///< Offset of the first byte of the current line
+    size_t scan;         ///< Offset of the first byte not yet scanned
+    size_t end;          ///< Offset one past the last received byte
+    const char *term;    ///< Line terminator (e.g. "\r\n")
+    size_t termLen;      ///< Length of term
+    const char *prompt;  ///< Unterminated prompt returned as a line (e.g. "> "), or NULL
+    size_t promptLen;    ///< Length of prompt
+    bool discard;        ///< Dropping input up to the next terminator
+    size_t overLength;   ///< Number of over-length lines dropped
+} uAT_LineAssembler_t;
+
+/**
+ * @brief Initialize a line assembler
+ *
+ * @param la Assembler to initialize
+ * @param buf Storage for received bytes
+ * @param size Size of buf
+ * @param terminator Null-terminated, non-empty line terminator
+ */
+void uAT_Line_Init(uAT_LineAssembler_t *la, char *buf, size_t size,
+                   const char *terminator);
+
+/**
+ * @brief Set a prompt that is returned as a line without a terminator
+ *
+ * Modems send a data prompt such as "> " and then wait for input, so it
+ * must not be held back as a partial line. Pending data that is exactly
+ * the prompt is returned by uAT_Line_Next().
+ *
+ * @param la Assembler to configure
+ * @param prompt Null-terminated prompt, or NULL to disable
+ */
+void uAT_Line_SetPrompt(uAT_LineAssembler_t *la, const char *prompt);
+
+/**
+ * @brief Discard all buffered data, including a partial line
+ *
+ * @param la Assembler to reset
+ */
+void uAT_Line_Reset(uAT_LineAssembler_t *la);
+
+/**
+ * @brief Drop the partial line and discard input up to the next terminator
+ *
+ * Call after received data was lost, once every line before the loss has
+ * been returned: the line around the loss is dropped as a whole instead of
+ * being returned as a fragment.
+ *
+ * @param la Assembler to resync
+ */
+void uAT_Line_Resync(uAT_LineAssembler_t *la);
+
+/**
+ * @brief Get the free space where new data can be written
+ *
+ * Moves a partial line to the front of the buffer when the tail is full,
+ * so the space returned is as large as possible.
+ *
+ * @param la Assembler to write into
+ * @param space Pointer to store the number of writable bytes
+ * @return Pointer to the first writable byte
+ */
+char *uAT_Line_WritePtr(uAT_LineAssembler_t *la, size_t *space);
+
+/**
+ * @brief Account for bytes written at uAT_Line_WritePtr()
+ *
+ * @param la Assembler written into
+ * @param len Number of bytes written, at most the space returned
+ */
+void uAT_Line_Commit(uAT_LineAssembler_t *la, size_t len);
+
+/**
+ * @brief Copy a block of data into the assembler
+ *
+ * @param la Assembler to write into
+ * @param data Data to append
+ * @param len Length of data
+ * @return Number of bytes accepted (less than len if the buffer is full)
+ */
+size_t uAT_Line_Write(uAT_LineAssembler_t *la, const char *data, size_t len);
+
+/**
+ * @brief Get the next complete line
+ *
+ * A line longer than the buffer is dropped up to its terminator and counted
+ * in overLength. The returned view (including terminator, not null-terminated) is valid
+ * until the next call that writes into the assembler.
+ *
+ * @param la Assembler to read from
+ * @param line Pointer to store the start of the line
+ * @param len Pointer to store the length of the line
+ * @return true if a line was returned, false if only a partial line is buffered
+ */
+bool uAT_Line_Next(uAT_LineAssembler_t *la, const char **line, size_t *len);
+
+/**
+ * @brief Get the number of buffered bytes not yet returned as a line
+ *
+ * @param la Assembler to query
+ * @return Number of received bytes not yet returned by uAT_Line_Next()
+ */
+size_t uAT_Line_Pending(const uAT_LineAssembler_t *la);
+
+#endif // UAT_LINE_H
@@ -0,0 +1,204 @@
+/**
+ * @file uat_match.h
+ * @brief Prefix trie for command dispatch
+ *
+ * This module maps registered command prefixes to small integer values and
+ * finds every registered prefix of a received line in one pass over the
+ * line, independent of how many prefixes are registered. The first byte is
+ * looked up in a jump table; below it each node keeps its children in a
+ * sibling list sorted by byte.
+ *
+ * Prefixes may also be glob patterns, see uAT_Match_InsertPattern(). A
+ * pattern is compiled into the same trie: its literal bytes share nodes with
+ * plain prefixes and each wildcard becomes one node on a separate list of
+ * its parent. A lookup follows several paths at once only where a wildcard
+ * edge leaves the path it is on, so lines that never reach a wildcard cost
+ * the same as without patterns.
+ *
+ * Nodes come from a caller-provided pool. Removing a prefix only clears its
+ * value, the nodes stay in place for reuse; uAT_Match_Clear() and inserting
+ * the live prefixes again compacts the pool.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#ifndef UAT_MATCH_H
+#define UAT_MATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define UAT_MATCH_NONE 0xFFFFu ///< No value stored
+
+#ifndef UAT_MATCH_MAX_CLASSES
+#define UAT_MATCH_MAX_CLASSES 8    ///< Distinct [...] classes in all patterns
+#endif
+
+#ifndef UAT_MATCH_MAX_ACTIVE
+#define UAT_MATCH_MAX_ACTIVE 16    ///< Paths followed at once through patterns
+#endif
+
+/**
+ * @brief Edge kinds
+ */
+enum
+{
+    UAT_MATCH_LITERAL = 0,  ///< One byte, c
+    UAT_MATCH_ANY,          ///< '?': any one byte
+    UAT_MATCH_CLASS,        ///< '[...]': one byte of class c
+    UAT_MATCH_STAR          ///< '*': any run of bytes, including none
+};
+
+/**
+ * @brief Trie node
+ */
+typedef struct
+{
+    uint16_t child;    ///< First literal child, 0 if none (node 0 is the root)
+    uint16_t sibling;  ///< Next sibling: a greater byte, or the next wildcard
+    uint16_t value;    ///< Value of the prefix ending here, or UAT_MATCH_NONE
+    uint16_t wild;     ///< First wildcard child, 0 if none
+    char c;            ///< Byte on the edge into this node, or its class
+    uint8_t kind;      ///< Kind of the edge into this node
+} uAT_MatchNode_t;
+
+/**
+ * @brief Matcher state
+ */
+typedef struct
+{
+    uAT_MatchNode_t *nodes;  ///< Caller-provided node pool
+    size_t maxNodes;         ///< Size of the pool
+    size_t used;             ///< Nodes in use, including the root
+    size_t classCount;       ///< Classes in use
+    uint16_t first[256];     ///< Node for each first byte, 0 if none
+    uint8_t classes[UAT_MATCH_MAX_CLASSES][32]; ///< Bitmap of the bytes in each class
+} uAT_Matcher_t;
+
+/**
+ * @brief Initialize a matcher
+ *
+ * @param m Matcher to initialize
+ * @param nodes Node pool
+ * @param maxNodes Number of nodes in the pool, 2 to 65535
+ * @return true on success, false on invalid arguments
+ */
+bool uAT_Match_Init(uAT_Matcher_t *m, uAT_MatchNode_t *nodes, size_t maxNodes);
+
+/**
+ * @brief Remove all prefixes and release all nodes
+ *
+ * @param m Matcher to clear
+ */
+void uAT_Match_Clear(uAT_Matcher_t *m);
+
+/**
+ * @brief Store a value for a prefix, replacing any value it had
+ *
+ * @param m Matcher to insert into
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix, at least 1
+ * @param value Value to store, not UAT_MATCH_NONE
+ * @return true on success, false if the node pool is exhausted
+ */
+bool uAT_Match_Insert(uAT_Matcher_t *m, const char *prefix, size_t len, uint16_t value);
+
+/**
+ * @brief Get the value stored for exactly this prefix
+ *
+ * @param m Matcher to search
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix
+ * @return Stored value, or UAT_MATCH_NONE
+ */
+uint16_t uAT_Match_Get(const uAT_Matcher_t *m, const char *prefix, size_t len);
+
+/**
+ * @brief Remove the value stored for a prefix
+ *
+ * @param m Matcher to remove from
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix
+ * @return true if a value was removed, false if the prefix had none
+ */
+bool uAT_Match_Remove(uAT_Matcher_t *m, const char *prefix, size_t len);
+
+/**
+ * @brief Check the syntax of a glob pattern
+ *
+ * A pattern is matched against the start of a line, like a prefix. '?'
+ * matches any one byte, '*' any run of bytes, "[abc]" or "[a-c]" one of the
+ * listed bytes and "[!abc]" any other byte; '\\' makes the next byte
+ * literal. A pattern without any of these is the same as a plain prefix.
+ *
+ * @param pattern Pattern bytes (need not be null-terminated)
+ * @param len Length of pattern
+ * @return true if the pattern is valid and not empty
+ */
+bool uAT_Match_PatternValid(const char *pattern, size_t len);
+
+/**
+ * @brief Store a value for a glob pattern, replacing any value it had
+ *
+ * @param m Matcher to insert into
+ * @param pattern Pattern bytes, see uAT_Match_PatternValid()
+ * @param len Length of pattern
+ * @param value Value to store, not UAT_MATCH_NONE
+ * @return true on success, false if the pattern is invalid or the node pool
+ *         or the class table is exhausted
+ */
+bool uAT_Match_InsertPattern(uAT_Matcher_t *m, const char *pattern, size_t len, uint16_t value);
+
+/**
+ * @brief Get the value stored for exactly this glob pattern
+ *
+ * @param m Matcher to search
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @return Stored value, or UAT_MATCH_NONE
+ */
+uint16_t uAT_Match_GetPattern(const uAT_Matcher_t *m, const char *pattern, size_t len);
+
+/**
+ * @brief Remove the value stored for a glob pattern
+ *
+ * @param m Matcher to remove from
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @return true if a value was removed, false if the pattern had none
+ */
+bool uAT_Match_RemovePattern(uAT_Matcher_t *m, const char *pattern, size_t len);
+
+/**
+ * @brief Find the values of all stored prefixes of a line
+ *
+ * @param m Matcher to search
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @param values Array to store the values, shortest prefix first
+ * @param maxValues Size of values; longer prefixes beyond it are ignored
+ * @return Number of values stored
+ */
+size_t uAT_Match_Find(const uAT_Matcher_t *m, const char *line, size_t len,
+                      uint16_t *values, size_t maxValues);
+
+/**
+ * @brief Find the values of all stored prefixes and patterns matching a line
+ *
+ * A pattern matching several starts of the line is reported once, at the
+ * shortest one. At most UAT_MATCH_MAX_ACTIVE paths are followed at once.
+ *
+ * @param m Matcher to search
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @param values Array to store the values, shortest match first
+ * @param ends Array to store the length of each match, or NULL
+ * @param maxValues Size of values and ends; longer matches beyond it are ignored
+ * @return Number of values stored
+ */
+size_t uAT_Match_FindEx(const uAT_Matcher_t *m, const char *line, size_t len,
+                        uint16_t *values, size_t *ends, size_t maxValues);
+
+#endif // UAT_MATCH_H
@@ -0,0 +1,125 @@
+/**
+ * @file uat_ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring
+ *
+ * This module is the channel from the receive ISR (producer) to uAT_Task
+ * (consumer). Both indices run freely and are only masked on access, so the
+ * ring size must be a power of two and all of it can be used. The producer
+ * only writes head and the consumer only writes tail; each side publishes
+ * its index with release semantics and reads the other side's with acquire
+ * semantics, so no critical section is needed.
+ *
+ * The span API hands out contiguous regions of the ring so data can be
+ * written or parsed in place; the copy API is built on top of it.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#ifndef UAT_RING_H
+#define UAT_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Ring state
+ */
+typedef struct
+{
+    uint8_t *buf;    ///< Caller-provided storage
+    uint32_t mask;   ///< Size of buf minus one
+    uint32_t head;   ///< Total bytes written, only written by the producer
+    uint32_t tail;   ///< Total bytes read, only written by the consumer
+} uAT_Ring_t;
+
+/**
+ * @brief Initialize a ring
+ *
+ * @param ring Ring to initialize
+ * @param buf Storage for the ring
+ * @param size Size of buf, a power of two
+ * @return true on success, false if size is not a power of two
+ */
+bool uAT_Ring_Init(uAT_Ring_t *ring, uint8_t *buf, size_t size);
+
+/**
+ * @brief Discard all data
+ *
+ * @note Neither side may use the ring while it is reset
+ * @param ring Ring to reset
+ */
+void uAT_Ring_Reset(uAT_Ring_t *ring);
+
+/**
+ * @brief Get the number of bytes waiting to be read
+ *
+ * @param ring Ring to query
+ * @return Number of readable bytes
+ */
+size_t uAT_Ring_Used(const uAT_Ring_t *ring);
+
+/**
+ * @brief Get the number of bytes that can be written
+ *
+ * @param ring Ring to query
+ * @return Number of writable bytes
+ */
+size_t uAT_Ring_Free(const uAT_Ring_t *ring);
+
+/**
+ * @brief Get the contiguous free span at the write position (producer)
+ *
+ * @param ring Ring to write into
+ * @param span Pointer to store the start of the span
+ * @return Length of the span, 0 if the ring is full
+ */
+size_t uAT_Ring_WriteSpan(uAT_Ring_t *ring, uint8_t **span);
+
+/**
+ * @brief Publish bytes written into the span (producer)
+ *
+ * @param ring Ring written into
+ * @param len Number of bytes written, at most the span length
+ */
+void uAT_Ring_Produce(uAT_Ring_t *ring, size_t len);
+
+/**
+ * @brief Copy a block of data into the ring (producer)
+ *
+ * @param ring Ring to write into
+ * @param data Data to append
+ * @param len Length of data
+ * @return Number of bytes written (less than len if the ring is full)
+ */
+size_t uAT_Ring_Write(uAT_Ring_t *ring, const void *data, size_t len);
+
+/**
+ * @brief Get the contiguous readable span at the read position (consumer)
+ *
+ * @param ring Ring to read from
+ * @param span Pointer to store the start of the span
+ * @return Length of the span, 0 if the ring is empty
+ */
+size_t uAT_Ring_ReadSpan(uAT_Ring_t *ring, const uint8_t **span);
+
+/**
+ * @brief Release bytes read from the span (consumer)
+ *
+ * @param ring Ring read from
+ * @param len Number of bytes consumed, at most the span length
+ */
+void uAT_Ring_Consume(uAT_Ring_t *ring, size_t len);
+
+/**
+ * @brief Copy data out of the ring (consumer)
+ *
+ * @param ring Ring to read from
+ * @param data Destination buffer
+ * @param len Size of data
+ * @return Number of bytes read
+ */
+size_t uAT_Ring_Read(uAT_Ring_t *ring, void *data, size_t len);
+
+#endif // UAT_RING_H
@@ -0,0 +1,71 @@
+/**
+ * @file uat_scan.h
+ * @brief Word-at-a-time scanning kernels for line terminators and prompts
+ *
+ * This module finds bytes and short markers in received data several bytes
+ * per step. On cores with the ARMv7E-M DSP extension (Cortex-M4/M7) each
+ * 32-bit word is tested with UADD8/SEL; elsewhere a portable SWAR fallback
+ * tests a native word (4 or 8 bytes) with carry-free bit tricks.
+ *
+ * Define UAT_SCAN_NO_SIMD to force the portable fallback.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#ifndef UAT_SCAN_H
+#define UAT_SCAN_H
+
+#include <stddef.h>
+
+#define UAT_SCAN_PROMPT "> " ///< Data prompt sent by modems (e.g. after AT+CMGS)
+
+/**
+ * @brief Find the first occurrence of a byte
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param c Byte to find
+ * @return Pointer to the first match, or NULL if not found
+ */
+const char *uAT_ScanByte(const char *data, size_t len, char c);
+
+/**
+ * @brief Find the first occurrence of either of two bytes
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param a First byte to find
+ * @param b Second byte to find
+ * @return Pointer to the first match, or NULL if not found
+ */
+const char *uAT_ScanByte2(const char *data, size_t len, char a, char b);
+
+/**
+ * @brief Find the first complete occurrence of a short marker
+ *
+ * Used for UAT_LINE_TERMINATOR and UAT_SCAN_PROMPT. A marker cut off at the
+ * end of data is not reported.
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param marker Marker to find
+ * @param markerLen Length of marker
+ * @return Pointer to the start of the first match, or NULL if not found
+ */
+const char *uAT_ScanMarker(const char *data, size_t len,
+                           const char *marker, size_t markerLen);
+
+/**
+ * @brief Find the first CR that is not followed by LF
+ *
+ * A CR in the last byte of data is not reported, since the LF may still
+ * be on its way.
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @return Pointer to the bare CR, or NULL if not found
+ */
+const char *uAT_ScanBareCR(const char *data, size_t len);
+
+#endif // UAT_SCAN_H
@@ -10,6 +10,12 @@
  * @date [06/05/2025]
  */
 
+// clock_gettime() for the host profiling clock, see UAT_PROFILE_NOW(); must
+// come before any system header
+#if defined(UAT_ENABLE_PROFILING) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include "stm32f756xx.h"
 #include "stm32f7xx_hal.h"
 #include "stm32f7xx_hal_uart.h"
@@ -18,17 +24,59 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
-#include "stream_buffer.h"
+#include "event_groups.h"
 #include "string.h"
 #include "stdbool.h"
 #include "stdio.h"
 #include "main.h"
 
 #include "uat_freertos.h"
+#include "uat_line.h"
+#include "uat_scan.h"
+#include "uat_ring.h"
+#include "uat_match.h"
+
+#if defined(UAT_DMA_PINGPONG) && (defined(UAT_DMA_ZERO_COPY) || defined(UAT_DMA_RX_EVENT))
+#error "UAT_DMA_PINGPONG cannot be combined with UAT_DMA_ZERO_COPY or UAT_DMA_RX_EVENT"
+#endif
+
+// Received bytes reach uAT_Task through the receive ring, except in the DMA
+// modes where the task reads the DMA buffer itself
+#if !defined(UAT_USE_DMA) || (!defined(UAT_DMA_ZERO_COPY) && !defined(UAT_DMA_PINGPONG))
+#define UAT_RX_RING
+_Static_assert((UAT_RX_RING_SIZE & (UAT_RX_RING_SIZE - 1)) == 0, "UAT_RX_RING_SIZE must be a power of two");
+#endif
 
 #ifdef UAT_USE_DMA
 static uint8_t uart_dma_rx_buf[UAT_DMA_RX_SIZE];
-static volatile size_t dma_last_pos __attribute__((aligned(4))) = 0;
+#if defined(UAT_DMA_PINGPONG)
+#define UAT_PP_HALF (UAT_DMA_RX_SIZE / 2)         // Each half of uart_dma_rx_buf is one buffer
+#define UAT_PP_DMA  0                             // Buffer owned by the ISR/DMA
+#define UAT_PP_TASK 1                             // Buffer handed to uAT_Task
+static volatile uint8_t dma_pp_owner[2];          // Written by the ISR to hand over, by the task to give back
+static volatile uint16_t dma_pp_len[2];           // ISR: bytes in a buffer handed to the task
+static volatile bool dma_pp_gap[2];               // ISR: data was dropped before a buffer handed to the task
+static volatile bool dma_pp_midline[2];           // ISR: ... and the buffer starts in the middle of a line
+static bool dma_pp_lost = false;                  // ISR: data dropped since the last hand-over
+static bool dma_pp_lost_midline = false;          // ISR: the dropped data did not end on a line end
+static uint8_t dma_pp_active = 0;                 // ISR: buffer the DMA is filling
+static uint8_t dma_pp_next = 0;                   // Task: next buffer to parse
+static volatile bool dma_pp_stopped = false;      // ISR: DMA could not be restarted, uAT_Task retries
+#elif defined(UAT_DMA_ZERO_COPY)
+static volatile size_t dma_write_pos __attribute__((aligned(4))) = 0; // Published by the IDLE ISR
+static volatile size_t dma_read_pos = 0;         // Published by the task: oldest byte not yet parsed
+static uint32_t dma_overruns_seen = 0;           // Task: overruns already recovered from
+static bool dma_discard = false;                 // Task: dropping input up to the next terminator
+static volatile size_t dma_scan_pos = 0;         // Published by the task: first byte not yet scanned, read by the ISR
+static size_t dma_line_len = 0;                  // Task: bytes of the partial line before dma_scan_pos
+static char dma_wrap_buf[UAT_RX_BUFFER_SIZE];    // Task: stitches lines that wrap the ring
+#else
+static size_t dma_last_pos = 0;                  // Receive ISRs: DMA position already handed over
+#endif
+#else
+static uint8_t it_rx_byte;                       // HAL_UART_Receive_IT() target
+static uint8_t it_stage[UAT_IT_BATCH_SIZE];      // ISR: bytes not yet handed to uAT_Task
+static size_t it_stage_len = 0;
 #endif
 
 // Forward declaration
@@ -43,10 +91,219 @@ typedef void (*uAT_CommandHandler)(const char *args);
  */
 typedef struct
 {
-    const char *command;         ///< Command string to match
-    uAT_CommandHandler handler;  ///< Function to call when command is received
+    const char *command;         ///< Command string to match, NULL if the slot is free
+    size_t length;               ///< Cached strlen(command)
+    uAT_CommandHandler handler;  ///< Function to call when command is received, or NULL
+    uAT_CommandHandlerEx handlerEx; ///< Extended handler, called instead of handler if set
+    void *ctx;                   ///< Context passed to handlerEx
+    int32_t order;               ///< Registration order, lower wins when prefixes overlap
+    bool urc;                    ///< Registered with uAT_RegisterURC(), runs in uAT_URCTask
+    bool pattern;                ///< command is a glob pattern, see uAT_RegisterPattern()
+    bool subscriber;             ///< Added with uAT_Subscribe(), never replaced by a registration
+    uint16_t next;               ///< Next entry for the same command by order, or UAT_MATCH_NONE
 } uAT_CommandEntry;
 
+// Registered prefixes of one line considered at dispatch
+#define UAT_MAX_NESTED_MATCHES 8
+
+/**
+ * @brief Handler table snapshot
+ *
+ * uAT_Task dispatches from one snapshot without a lock while writers build
+ * the next one in the other, see uAT_AcquireTable().
+ */
+typedef struct
+{
+    uAT_CommandEntry cmdHandlers[UAT_MAX_CMD_HANDLERS]; ///< Registered commands, by slot
+    size_t cmdCount;                                    ///< Number of registered commands
+    int32_t cmdOrderFirst;                              ///< Order of the earliest entry (URCs go before it)
+    int32_t cmdOrderLast;                               ///< Order of the latest entry
+    uAT_Matcher_t cmdMatcher;                           ///< Command prefix -> slot of its earliest entry
+    uAT_MatchNode_t cmdNodes[UAT_MATCH_MAX_NODES];      ///< Storage for cmdMatcher
+} uAT_HandlerTable_t;
+
+#define UAT_TABLE_NONE 2 // tableReader: uAT_Task holds no snapshot
+
+/**
+ * @brief Handler picked for a line, copied out of the snapshot
+ */
+typedef struct
+{
+    uAT_CommandHandler handler;     ///< Plain handler, or NULL
+    uAT_CommandHandlerEx handlerEx; ///< Extended handler, or NULL
+    void *ctx;                      ///< Context passed to handlerEx
+#ifdef UAT_URC_TASK
+    bool urc;                       ///< Run in uAT_URCTask
+#endif
+#ifdef UAT_WORKER_TASKS
+    uint32_t worker;                ///< Worker running the handler, picked by command
+#endif
+#ifdef UAT_ENABLE_PROFILING
+    const char *command;            ///< Command of the entry, identifies its statistics
+    uint16_t profSlot;              ///< Index of the entry's statistics in uat.profile
+#endif
+} uAT_Call_t;
+
+#ifdef UAT_ENABLE_PROFILING
+#ifndef UAT_PROFILE_NOW
+#ifdef DWT
+// Core cycle counter, started in uAT_Init()
+#define UAT_PROFILE_NOW() (DWT->CYCCNT)
+#define UAT_PROFILE_DWT
+#else
+#include <time.h>
+
+// Host build: monotonic clock in nanoseconds
+static inline uint32_t uAT_ProfileNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#define UAT_PROFILE_NOW() uAT_ProfileNow()
+#endif
+#endif
+
+/**
+ * @brief Execution statistics of one handler table slot
+ */
+typedef struct
+{
+    const char *command;            ///< Command the counters belong to, NULL if unused
+    volatile uint32_t hits;         ///< Handler calls
+    volatile uint64_t totalTime;    ///< Sum of execution times
+    volatile uint32_t maxTime;      ///< Longest execution time
+    volatile uint32_t lastTime;     ///< Latest execution time
+} uAT_ProfileEntry_t;
+#endif
+
+#if defined(UAT_URC_TASK) || defined(UAT_WORKER_TASKS)
+#define UAT_WORK_QUEUES // Some handlers run outside uAT_Task
+
+/**
+ * @brief Arguments of a matched line, shared by every handler it is queued to
+ *
+ * Taken from uat.linePool by uAT_Task only; each handler task gives back its
+ * reference when its call returns.
+ */
+typedef struct
+{
+    volatile uint32_t refs;         ///< Queued calls not yet returned, 0 if the buffer is free
+    size_t len;                     ///< Length of args, including the terminator
+    char args[UAT_RX_BUFFER_SIZE];  ///< Arguments, null-terminated
+} uAT_SharedLine_t;
+
+/**
+ * @brief Matched line handed from uAT_Task to the task running its handler
+ */
+typedef struct
+{
+    uAT_Call_t call;                ///< Handler to run
+    TickType_t tick;                ///< Tick when the line was picked up
+    uAT_SharedLine_t *line;         ///< Arguments, shared with the other handlers of the line
+} uAT_WorkItem_t;
+
+/**
+ * @brief Work items queued by uAT_Task for one handler task, in order
+ *
+ * uAT_Task is the only producer and the handler task the only consumer.
+ * head and tail run freely and are published with UAT_SHARED_STORE().
+ */
+typedef struct
+{
+    uAT_WorkItem_t *items;          ///< Storage for size items
+    uint32_t size;                  ///< Number of items
+    volatile uint32_t head;         ///< uAT_Task: items filled
+    volatile uint32_t tail;         ///< Handler task: items done
+    volatile TaskHandle_t task;     ///< Handler task, woken per queued item
+    volatile uint32_t highWater;    ///< uAT_Task: most items queued at once
+    volatile uint32_t stalls;       ///< uAT_Task: times it waited for a free item
+} uAT_WorkQueue_t;
+#endif
+
+// Flags shared by uAT_Task and other tasks without a lock. Each side stores
+// its own flag before loading the other's, which needs sequential consistency
+#define UAT_SHARED_LOAD(p)     __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define UAT_SHARED_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define UAT_SHARED_ADD(p, v)   __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define UAT_SHARED_SUB(p, v)   __atomic_sub_fetch((p), (v), __ATOMIC_SEQ_CST)
+// Store v if *p still holds *e, else load *p into *e; true if stored
+#define UAT_SHARED_CAS(p, e, v) __atomic_compare_exchange_n((p), (e), (v), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+#ifdef UAT_STATIC_HANDLERS
+// Handlers listed in UAT_STATIC_HANDLERS are defined by the application
+#define UAT_HANDLER(cmd, fn) void fn(const char *args);
+#include UAT_STATIC_HANDLERS
+#undef UAT_HANDLER
+
+// Build-time handlers, sorted by command; lives in flash
+static const uAT_CommandEntry uAT_StaticHandlers[] = {
+#define UAT_HANDLER(cmd, fn) { .command = cmd, .length = sizeof(cmd) - 1, .handler = fn },
+#include UAT_STATIC_HANDLERS
+#undef UAT_HANDLER
+};
+
+#define UAT_STATIC_COUNT (sizeof(uAT_StaticHandlers) / sizeof(uAT_StaticHandlers[0]))
+#endif
+
+#ifdef UAT_ENABLE_PROFILING
+// Statistics of runtime slots, then of the build-time table
+#ifdef UAT_STATIC_HANDLERS
+#define UAT_PROFILE_SLOTS (UAT_MAX_CMD_HANDLERS + UAT_STATIC_COUNT)
+#else
+#define UAT_PROFILE_SLOTS UAT_MAX_CMD_HANDLERS
+#endif
+#endif
+
+// Transaction slot states, see uAT_TxnKick()
+enum {
+    UAT_TXN_FREE,           // Not in use, uAT_TxnSubmit() may fill it
+    UAT_TXN_QUEUED,         // Waiting for the transactions before it
+    UAT_TXN_STARTING,       // Claimed by the task about to send the command
+    UAT_TXN_ACTIVE,         // Command sent, uAT_Task captures the response
+    UAT_TXN_CAPTURING,      // uAT_Task is writing a line to the sink
+    UAT_TXN_COMPLETING,     // Being taken off the queue
+    UAT_TXN_DONE,           // Off the queue, result waiting to be collected
+    UAT_TXN_CANCELLED       // Cancelled while queued, skipped when its turn comes
+};
+
+/**
+ * @brief One transaction of the queue
+ *
+ * The submitter fills the slot before publishing it as queued. Afterwards
+ * only the task that moved the state on by UAT_SHARED_CAS() writes it;
+ * uAT_Task moves an active slot to capturing to write the sink and result
+ * counters.
+ */
+typedef struct
+{
+    volatile uint8_t state;             // UAT_TXN_*
+    uAT_TxnHandle_t handle;             // Handle given to the submitter
+    volatile uAT_TxnHandle_t cancel;    // Set to handle by uAT_TxnCancel(), 0 otherwise
+    const char *cmd;                    // Command to send
+    const char *const *terminators;     // Prefixes of lines marking success, NULL-terminated
+    const char *const *finals;          // Prefixes of lines ending the transaction, NULL-terminated
+    const char *echoPrefix;             // Prefix of the intermediate lines, or NULL
+    char *buf;                          // Text sink, or NULL
+    size_t bufSize;                     // Size of buf
+    uint8_t *arenaLow;                  // Line view sink: end of the views, growing up, or NULL
+    uint8_t *arenaHigh;                 // Line view sink: start of the text, growing down
+    uint8_t loan;                       // Pooled buffer lent as the sink, plus one, or 0
+    const char *payload;                // Sent after the "> " prompt, or NULL
+    size_t payloadLen;                  // Bytes of payload
+    bool payloadSent;                   // Task capturing: payload sent, a later prompt is final
+    TickType_t timeout;                 // Ticks allowed from start
+    TickType_t start;                   // Tick the command was sent
+    uAT_TxnResult_t result;             // Counters kept while active, outcome once done
+    uAT_TxnCallback onComplete;         // Gets the result instead of the submitter, or NULL
+    void *ctx;                          // Passed to onComplete
+    TaskHandle_t notifyTask;            // Notified with notifyBits once finished, or NULL
+    uint32_t notifyBits;                // Bits for notifyTask
+    EventGroupHandle_t eventGroup;      // Gets eventBits once finished, or NULL
+    EventBits_t eventBits;              // Bits for eventGroup
+    SemaphoreHandle_t done;             // Given when the slot becomes UAT_TXN_DONE
+} uAT_TxnSlot_t;
+
 /**
  * @brief Main uAT handle structure
  *
@@ -56,797 +313,3254 @@ typedef struct
 typedef struct uAT_HandleStruct
 {
     UART_HandleTypeDef *huart;                          // UART handle that connect to modem (e.g. UART2)
-    StreamBufferHandle_t rxStream;                      // Stream buffer for RX
+#ifdef UAT_RX_RING
+    uAT_Ring_t rxRing;                                  // Receive ring, ISR to uAT_Task
+    uint8_t rxRingBuf[UAT_RX_RING_SIZE];                // Storage for rxRing
+#endif
+    TaskHandle_t rxTask;                                // uAT_Task, woken by the receive ISR
+    volatile uint32_t rxLinesSeen;                      // Running count of line ends seen by the ISR
+    volatile uAT_RxStats_t rxStats;                     // Receive counters, see uAT_GetRxStats()
+#ifdef UAT_RX_RING
+    volatile uint32_t rxGapPos;                         // ISR: ring position of the newest loss
+    volatile uint32_t rxGapCount;                       // ISR: number of losses, published after rxGapPos
+    uint32_t rxGapsSeen;                                // Task: losses already resynced
+    bool rxDropping;                                    // ISR: dropping the rest of a line that lost bytes
+#endif
+    TickType_t rxTick;                                  // Task: tick when the data being parsed was picked up
     SemaphoreHandle_t txComplete;                       // For UART transmission
     SemaphoreHandle_t txMutex;                          // For UART transmission
-    SemaphoreHandle_t handlerMutex;                     // For command handler management
-    SemaphoreHandle_t sendReceiveSem;                   // For SendReceive
+    SemaphoreHandle_t handlerMutex;                     // Serializes handler table writers and transaction submitters
     uint8_t txBuffer[UAT_TX_BUFFER_SIZE];               // Transmit buffer
-    uAT_CommandEntry cmdHandlers[UAT_MAX_CMD_HANDLERS]; // Registered commands
-    size_t cmdCount;                                    // Number of registered commands
-
-    // SendReceive state
-    bool inSendReceive;  // True if currently in SendReceive
-    char *srBuffer;      // Buffer for SendReceive
-    size_t srBufferSize; // Size of srBuffer
-    size_t srBufferPos;  // Current position in srBuffer
+    uAT_HandlerTable_t tables[2];                       // Handler table snapshots
+    volatile uint8_t tableActive;                       // Writers: snapshot uAT_Task dispatches from
+    volatile uint8_t tableReader;                       // Task: snapshot being read, or UAT_TABLE_NONE
+    volatile bool tableWaiting;                         // Writers: blocked on tableFreed for the reader to leave
+    SemaphoreHandle_t tableFreed;                       // Given by uAT_Task when it leaves a snapshot a writer waits on
+
+#ifdef UAT_URC_TASK
+    uAT_WorkQueue_t urcQueue;                           // URC lines, uAT_Task to uAT_URCTask
+    uAT_WorkItem_t urcItems[UAT_URC_QUEUE_LEN];         // Storage for urcQueue
+#endif
+#ifdef UAT_WORKER_TASKS
+    uAT_WorkQueue_t workerQueues[UAT_WORKER_TASKS];     // Other lines, uAT_Task to each uAT_WorkerTask
+    uAT_WorkItem_t workerItems[UAT_WORKER_TASKS][UAT_WORKER_QUEUE_LEN]; // Storage for workerQueues
+#endif
+#ifdef UAT_WORK_QUEUES
+    uAT_SharedLine_t linePool[UAT_LINE_POOL_SIZE];      // Lines of queued calls, taken by uAT_Task
+    uint32_t linePoolNext;                              // Task: where to look for a free line first
+    volatile bool workWaiting;                          // Task: blocked on workFreed for a handler task to give back an item or a line
+    SemaphoreHandle_t workFreed;                        // Given by a handler task when uAT_Task waits on it
+#endif
+#ifdef UAT_ENABLE_PROFILING
+    uAT_ProfileEntry_t profile[UAT_PROFILE_SLOTS];      // Task running the handler: statistics per slot
+    volatile uint32_t unmatchedLines;                   // Task: lines no handler matched
+    volatile uint32_t unmatchedSeq;                     // Task: odd while a prefix is being written
+    char unmatched[UAT_PROFILE_UNMATCHED][UAT_PROFILE_PREFIX_LEN + 1]; // Task: ring of the latest prefixes
+#endif
+
+    // Transaction queue, the slots listed in txnOrder from txnTail (the
+    // front) to txnHead; one entry more than slots, so it is never full
+    uAT_TxnSlot_t txns[UAT_TXN_QUEUE_LEN];              // Transaction slots
+    volatile uint8_t txnOrder[UAT_TXN_QUEUE_LEN + 1];   // Slots in the order they were submitted
+    volatile uint32_t txnHead;                          // Submitters, under handlerMutex: next entry to fill
+    volatile uint32_t txnTail;                          // Task finishing the front: entry sent or next to send
+    uAT_TxnHandle_t txnLast;                            // Submitters, under handlerMutex: last handle given
+    volatile uint32_t txnWaiters;                       // Submitters: blocked on txnFreed for a free slot
+    SemaphoreHandle_t txnFreed;                         // Given when a slot is freed while submitters wait
+    volatile uint32_t sinkWaiters;                      // Other tasks: blocked on sinkFreed for a capture to end
+    SemaphoreHandle_t sinkFreed;                        // Given by uAT_Task when it leaves a slot capturing
+#ifdef UAT_RESP_POOL
+    void *respPool[UAT_RESP_POOL][UAT_RESP_BUF_SIZE / sizeof(void *)]; // Response buffers, aligned for line views
+    volatile bool respLent[UAT_RESP_POOL];              // Taken by submitters under handlerMutex, cleared on release
+#endif
+
+#ifndef UAT_DMA_ZERO_COPY
+    // Line assembly state, owned by uAT_Task
+    uAT_LineAssembler_t rxLine;               // Keeps partial lines across receives
+    char rxLineBuf[UAT_RX_BUFFER_SIZE];       // Storage for rxLine
+#endif
 } uAT_Handle_t;
 
 static uAT_Handle_t uat;
 
-// Push single received byte into stream buffer
-static inline void uAT_PushRxByte(uint8_t byte)
+/**
+ * @brief Wake uAT_Task from the receive ISR
+ *
+ * The notification value is the running count of line ends seen by the ISR.
+ * The task is only woken when that count moves, or when force is set for
+ * data that must be handled without a terminator (a "> " prompt, or one
+ * long line filling up the receive buffer).
+ *
+ * @param lines Number of line ends in the newly received data
+ * @param force Wake the task even if no line was completed
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a context switch is needed
+ */
+static void uAT_WakeTaskFromISR(uint32_t lines, bool force, BaseType_t *pxHigherPriorityTaskWoken)
 {
-    BaseType_t xHigher = pdFALSE;
-    xStreamBufferSendFromISR(uat.rxStream, &byte, 1, &xHigher);
-    portYIELD_FROM_ISR(xHigher);
+    uat.rxLinesSeen += lines;
+
+    if ((lines > 0 || force) && uat.rxTask != NULL) {
+        xTaskNotifyFromISR(uat.rxTask, uat.rxLinesSeen, eSetValueWithOverwrite,
+                           pxHigherPriorityTaskWoken);
+    }
+}
+
+// Track the highest number of bytes waiting for uAT_Task (ISR context)
+static inline void uAT_RxHighWater(size_t pending)
+{
+    if (pending > uat.rxStats.rxHighWater) {
+        uat.rxStats.rxHighWater = (uint32_t)pending;
+    }
 }
 
-#ifdef UAT_USE_DMA
-// Idle line IRQ handler to copy new DMA data into stream buffer
 /**
- * @brief Handles UART IDLE line interrupt for DMA-based reception
- * 
- * This function processes incoming data from the DMA receive buffer when an IDLE line
- * interrupt occurs. It manages circular buffer wrapping and transfers received data
- * to the stream buffer, tracking the last processed position.
- * 
- * @note This function is designed to be called from the UART IDLE line interrupt handler
- * @return true if data was successfully processed, false on error
+ * @brief Count line ends in newly received data (ISR context)
+ *
+ * @param data Newly received data
+ * @param len Length of data
+ * @return Number of occurrences of the last character of UAT_LINE_TERMINATOR
  */
-bool uAT_UART_IdleHandler(void)
+static uint32_t uAT_CountLineEnds(const uint8_t *data, size_t len)
 {
-    if (uat.huart == NULL || uat.huart->hdmarx == NULL || uat.rxStream == NULL) {
-        return false; // Safety check for null pointers
-    }
+    static const char term[] = UAT_LINE_TERMINATOR;
+    const char *p = (const char *)data;
+    const char *end = p + len;
+    uint32_t lines = 0;
 
-    UBaseType_t uxSavedInterruptStatus;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    bool success = true;
-    
-    // Get current DMA position atomically
-    size_t current_pos = UAT_DMA_RX_SIZE - __HAL_DMA_GET_COUNTER(uat.huart->hdmarx);
-    
-    // Enter critical section to get last position
-    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
-    size_t last_pos = dma_last_pos;
-    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
-    
-    // No new data
-    if (current_pos == last_pos) {
-        return true; // No error, just no new data
+    while ((p = uAT_ScanByte(p, (size_t)(end - p), term[sizeof(term) - 2])) != NULL) {
+        lines++;
+        p++;
     }
-    
-    // Handle normal case (no buffer wrap)
-    if (current_pos > last_pos) {
-        size_t data_len = current_pos - last_pos;
-        
-        // Check for buffer overflow
-        if (data_len > UAT_DMA_RX_SIZE) {
-            // This should never happen, but handle it safely
-            data_len = UAT_DMA_RX_SIZE - last_pos;
-            success = false;
-        }
-        
-        // Send data to stream buffer
-        size_t bytes_sent = xStreamBufferSendFromISR(
-            uat.rxStream,
-            &uart_dma_rx_buf[last_pos], 
-            data_len, 
-            &xHigherPriorityTaskWoken
-        );
-        
-        // Check if all bytes were sent
-        if (bytes_sent < data_len) {
-            success = false; // Stream buffer might be full
-        }
+    return lines;
+}
+
+#ifdef UAT_RX_RING
+/**
+ * @brief Copy received bytes into the receive ring (ISR context)
+ *
+ * Bytes that do not fit are dropped, and so is the rest of the line they
+ * belong to. The ring position of the loss is published so uAT_Task can drop
+ * the start of that line too; parsing resumes with the next whole line.
+ * Consecutive losses with nothing written in between count as one.
+ *
+ * @param data Received bytes
+ * @param len Length of data
+ * @return Number of line ends in the bytes written
+ */
+static uint32_t uAT_RxRingWrite(const uint8_t *data, size_t len)
+{
+    static const char term[] = UAT_LINE_TERMINATOR;
+    const char lineEnd = term[sizeof(term) - 2];
+
+    uat.rxStats.bytesReceived += len;
+
+    if (uat.rxDropping) {
+        // Rest of a line that lost bytes, drop it up to its end
+        const char *hit = uAT_ScanByte((const char *)data, len, lineEnd);
+        size_t skip = hit ? (size_t)(hit - (const char *)data) + 1 : len;
+        uat.rxStats.bytesDropped += skip;
+        uat.rxDropping = (hit == NULL);
+        data += skip;
+        len -= skip;
     }
-    // Handle buffer wrap case
-    else {
-        // Data from last_pos to end of buffer
-        size_t tail_len = UAT_DMA_RX_SIZE - last_pos;
-        
-        if (tail_len > 0) {
-            size_t bytes_sent = xStreamBufferSendFromISR(
-                uat.rxStream,
-                &uart_dma_rx_buf[last_pos], 
-                tail_len, 
-                &xHigherPriorityTaskWoken
-            );
-            
-            if (bytes_sent < tail_len) {
-                success = false;
-            }
-        }
-        
-        // Data from start of buffer to current position
-        if (current_pos > 0 && success) {
-            size_t bytes_sent = xStreamBufferSendFromISR(
-                uat.rxStream,
-                &uart_dma_rx_buf[0], 
-                current_pos, 
-                &xHigherPriorityTaskWoken
-            );
-            
-            if (bytes_sent < current_pos) {
-                success = false;
-            }
+
+    size_t written = uAT_Ring_Write(&uat.rxRing, data, len);
+
+    if (written < len) {
+        uat.rxStats.bytesDropped += len - written;
+
+        // Producer's own index, no ordering needed to read it
+        uint32_t head = uat.rxRing.head;
+        if (head != uat.rxGapPos || uat.rxGapCount == 0) {
+            uat.rxGapPos = head;
+            uat.rxGapCount++;
         }
+
+        // Unless the loss ended on a line end, the rest of its line follows
+        uat.rxDropping = (data[len - 1] != (uint8_t)lineEnd);
     }
-    
-    // Update position tracking atomically
-    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
-    dma_last_pos = current_pos;
-    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
-    
-    // Yield if needed
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-    
-    return success;
+
+    uAT_RxHighWater(uAT_Ring_Used(&uat.rxRing));
+    return uAT_CountLineEnds(data, written);
 }
+#endif
 
-// ISR: called from UART IRQ when IDLE flag set
-// add to USARTx_IRQHandler in stm32f7xx_it.c file
-// Note: the checking and calling uAT_UART_IdleHandler() is done before USARTx_IRQHandler.
-void USARTx_IRQHandler(void)
+#ifdef UAT_USE_DMA
+#ifndef UAT_DMA_PINGPONG
+/**
+ * @brief Check whether the DMA data ending at pos is a "> " prompt
+ *
+ * @param pos DMA write position just past the newest byte
+ * @return true if the two newest bytes are UAT_SCAN_PROMPT
+ */
+static bool uAT_DmaEndsWithPrompt(size_t pos)
 {
-    // Check if this is our UART and if IDLE flag is set
-    if (uat.huart != NULL && __HAL_UART_GET_FLAG(uat.huart, UART_FLAG_IDLE))
-    {
-        // Clear the IDLE flag
-        __HAL_UART_CLEAR_IDLEFLAG(uat.huart);
-        
-        // Process received data
-        uAT_UART_IdleHandler();
+    size_t last = (pos + UAT_DMA_RX_SIZE - 1) % UAT_DMA_RX_SIZE;
+    size_t prev = (pos + UAT_DMA_RX_SIZE - 2) % UAT_DMA_RX_SIZE;
+    return uart_dma_rx_buf[prev] == (uint8_t)UAT_SCAN_PROMPT[0] &&
+           uart_dma_rx_buf[last] == (uint8_t)UAT_SCAN_PROMPT[1];
+}
+#endif
+#else
+/**
+ * @brief Hand the staged bytes over to uAT_Task (ISR context)
+ *
+ * @param force Wake the task even if no line was completed
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a context switch is needed
+ */
+static void uAT_FlushRxStage(bool force, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (it_stage_len == 0) {
+        return;
     }
-    
-    // Call the HAL UART IRQ handler
-    HAL_UART_IRQHandler(uat.huart);
+
+    // Bytes that do not fit into a full ring are dropped
+    uint32_t lines = uAT_RxRingWrite(it_stage, it_stage_len);
+    it_stage_len = 0;
+
+    bool filling = uAT_Ring_Used(&uat.rxRing) >= UAT_RX_RING_SIZE / 2;
+    uAT_WakeTaskFromISR(lines, force || filling, pxHigherPriorityTaskWoken);
 }
 
-#else
-// Byte-by-byte interrupt-driven receive
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+// Stage single received byte, hand the batch over on a line end, prompt or full stage
+static inline void uAT_PushRxByte(uint8_t byte)
 {
-    static uint8_t rxByte;
-    
-    // Check if this is our UART
-    if (huart == uat.huart)
-    {
-        // Push the received byte to the stream buffer
-        uAT_PushRxByte(rxByte);
-        
-        // Restart reception for the next byte
-        HAL_UART_Receive_IT(uat.huart, &rxByte, 1);
+    static const char term[] = UAT_LINE_TERMINATOR;
+    static uint8_t prevByte;
+    BaseType_t xHigher = pdFALSE;
+
+    it_stage[it_stage_len++] = byte;
+
+    bool lineEnd = (byte == (uint8_t)term[sizeof(term) - 2]);
+    bool prompt = (prevByte == (uint8_t)UAT_SCAN_PROMPT[0] && byte == (uint8_t)UAT_SCAN_PROMPT[1]);
+    prevByte = byte;
+
+    if (lineEnd || prompt || it_stage_len == UAT_IT_BATCH_SIZE) {
+        uAT_FlushRxStage(prompt, &xHigher);
+        portYIELD_FROM_ISR(xHigher);
     }
 }
 #endif
 
-// Common TX complete callback (for both IT and DMA)
+#ifdef UAT_USE_DMA
 /**
- * @brief Callback function for UART transmission complete event
- * 
- * This function is called when a UART transmission is completed. It gives a binary semaphore
- * to signal the transmission is finished, allowing waiting tasks to proceed.
- * 
- * @param huart Pointer to the UART handle that completed transmission
- * 
- * @note This is an ISR (Interrupt Service Routine) callback function
+ * @brief Start DMA reception into uart_dma_rx_buf
+ *
+ * Uses HAL ReceiveToIdle with UAT_DMA_RX_EVENT, which enables the IDLE interrupt
+ * itself; otherwise starts plain DMA reception and enables the IDLE interrupt
+ * for uAT_UART_IdleHandler(). With UAT_DMA_PINGPONG starts a single ReceiveToIdle
+ * transfer into the active half.
+ *
+ * @return HAL status of the receive request
  */
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+static HAL_StatusTypeDef uAT_StartDmaRx(void)
 {
-    // Check if this is our UART
-    if (huart == uat.huart)
-    {
-        BaseType_t xHigher = pdFALSE;
-        
-        // Signal that transmission is complete
-        xSemaphoreGiveFromISR(uat.txComplete, &xHigher);
-        
-        // Yield if a higher priority task was woken
-        portYIELD_FROM_ISR(xHigher);
+#if defined(UAT_DMA_PINGPONG)
+    HAL_StatusTypeDef status = HAL_UARTEx_ReceiveToIdle_DMA(uat.huart,
+                                                            &uart_dma_rx_buf[dma_pp_active * UAT_PP_HALF],
+                                                            UAT_PP_HALF);
+    if (status == HAL_OK) {
+        // Hand over on IDLE or a full half only, not at half transfer
+        __HAL_DMA_DISABLE_IT(uat.huart->hdmarx, DMA_IT_HT);
+    }
+    return status;
+#elif defined(UAT_DMA_RX_EVENT)
+    return HAL_UARTEx_ReceiveToIdle_DMA(uat.huart, uart_dma_rx_buf, UAT_DMA_RX_SIZE);
+#else
+    HAL_StatusTypeDef status = HAL_UART_Receive_DMA(uat.huart, uart_dma_rx_buf, UAT_DMA_RX_SIZE);
+    if (status == HAL_OK) {
+        // Enable IDLE interrupt
+        __HAL_UART_CLEAR_IDLEFLAG(uat.huart);
+        __HAL_UART_ENABLE_IT(uat.huart, UART_IT_IDLE);
     }
+    return status;
+#endif
 }
+#endif
 
-// === CORE API ===
-
+#ifdef UAT_USE_DMA
+#if defined(UAT_DMA_PINGPONG)
 /**
- * @brief  Initialize the uAT parser module
- * @param  huart Pointer to HAL UART handle
- * @return UAT_OK if successful, or appropriate error code on failure
+ * @brief HAL ReceiveToIdle event callback (ping-pong mode)
+ *
+ * The DMA fills one half of uart_dma_rx_buf in normal mode and stops on IDLE
+ * or when the half is full. The filled half is handed to uAT_Task and the DMA
+ * restarts on the other half, but only if the task has given that one back.
+ * Otherwise the new data is dropped and counted, so data the task has not
+ * parsed yet is never overwritten.
+ *
+ * Ownership is a flag per half: only the ISR sets it to UAT_PP_TASK and only
+ * the task sets it back to UAT_PP_DMA, so no critical section is needed.
+ *
+ * @param huart UART handle that raised the event
+ * @param Size Number of bytes received into the active half
  */
-uAT_Result_t uAT_Init(UART_HandleTypeDef *huart)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
-    // Validate input parameters
-    if (!huart) {
-        return UAT_ERR_INVALID_ARG;
+    // Check if this is our UART
+    if (huart != uat.huart)
+    {
+        return;
     }
 
-    // Clear the handle structure
-    memset(&uat, 0, sizeof(uat));
-    uat.huart = huart;
-    
-    // Create FreeRTOS primitives
-    uat.rxStream = xStreamBufferCreate(UAT_RX_BUFFER_SIZE, 1);
-    if (!uat.rxStream) {
-        return UAT_ERR_RESOURCE;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t filled = dma_pp_active;
+    uint8_t other = filled ^ 1;
+
+    uat.rxStats.bytesReceived += Size;
+
+    if (Size > 0 && dma_pp_owner[other] == UAT_PP_DMA)
+    {
+        // Hand the filled half over and continue on the other one
+        dma_pp_len[filled] = Size;
+        dma_pp_gap[filled] = dma_pp_lost;
+        dma_pp_midline[filled] = dma_pp_lost_midline;
+        dma_pp_lost = false;
+        dma_pp_owner[filled] = UAT_PP_TASK;
+        dma_pp_active = other;
+        uAT_RxHighWater(Size);
+
+        uint32_t lines = uAT_CountLineEnds(&uart_dma_rx_buf[filled * UAT_PP_HALF], Size);
+        uAT_WakeTaskFromISR(lines, true, &xHigherPriorityTaskWoken);
     }
-    
-    uat.txComplete = xSemaphoreCreateBinary();
-    if (!uat.txComplete) {
-        vStreamBufferDelete(uat.rxStream);
-        return UAT_ERR_RESOURCE;
+    else if (Size > 0)
+    {
+        // Task still owns the other half, receive into this one again
+        uat.rxStats.dmaOverruns++;
+        uat.rxStats.bytesDropped += Size;
+        dma_pp_lost = true;
+        dma_pp_lost_midline = uart_dma_rx_buf[filled * UAT_PP_HALF + Size - 1] !=
+                              (uint8_t)UAT_LINE_TERMINATOR[sizeof(UAT_LINE_TERMINATOR) - 2];
     }
-    
-    uat.txMutex = xSemaphoreCreateMutex();
-    if (!uat.txMutex) {
-        vStreamBufferDelete(uat.rxStream);
-        vSemaphoreDelete(uat.txComplete);
-        return UAT_ERR_RESOURCE;
+
+    if (uAT_StartDmaRx() != HAL_OK) {
+        // Nothing is received until uAT_Task restarts the DMA, and a line
+        // may be cut meanwhile
+        uat.rxStats.dmaRestartFailures++;
+        dma_pp_lost = true;
+        dma_pp_lost_midline = true;
+        UAT_SHARED_STORE(&dma_pp_stopped, true);
+        uAT_WakeTaskFromISR(0, true, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief Handles UART IDLE line interrupt (ping-pong mode)
+ *
+ * Nothing to do: HAL reports IDLE through HAL_UARTEx_RxEventCallback().
+ *
+ * @return Always true
+ */
+bool uAT_UART_IdleHandler(void)
+{
+    return true;
+}
+#else
+#ifdef UAT_DMA_ZERO_COPY
+/**
+ * @brief Hand new DMA data over to uAT_Task (zero-copy)
+ *
+ * Only publishes the current DMA write index and wakes uAT_Task, which then
+ * extracts lines directly from the circular DMA buffer. No data is copied here;
+ * the new bytes are only scanned to count line ends for the wake-up.
+ *
+ * @note Called from ISR context
+ * @param current_pos DMA write position, in [0, UAT_DMA_RX_SIZE)
+ * @return true if the write index was published, false on error
+ */
+static bool uAT_DmaRxPublish(size_t current_pos)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // No new data
+    if (current_pos == dma_write_pos) {
+        return true;
+    }
+
+    // Count line ends in the new bytes, which may wrap the ring
+    size_t last_pos = dma_write_pos;
+    size_t fresh = (current_pos + UAT_DMA_RX_SIZE - last_pos) % UAT_DMA_RX_SIZE;
+    size_t pending = (last_pos + UAT_DMA_RX_SIZE - dma_read_pos) % UAT_DMA_RX_SIZE;
+    uint32_t lines;
+    if (current_pos > last_pos) {
+        lines = uAT_CountLineEnds(&uart_dma_rx_buf[last_pos], current_pos - last_pos);
+    } else {
+        lines = uAT_CountLineEnds(&uart_dma_rx_buf[last_pos], UAT_DMA_RX_SIZE - last_pos) +
+                uAT_CountLineEnds(uart_dma_rx_buf, current_pos);
+    }
+
+    // Aligned word store, the task sees either the old or the new index
+    dma_write_pos = current_pos;
+    uat.rxStats.bytesReceived += fresh;
+
+    // The DMA wrote over bytes the task has not parsed yet, the task resyncs
+    // after seeing the new count (published after the write index)
+    if (pending + fresh >= UAT_DMA_RX_SIZE) {
+        uat.rxStats.dmaOverruns++;
+        uAT_RxHighWater(UAT_DMA_RX_SIZE);
+    } else {
+        uAT_RxHighWater(pending + fresh);
+    }
+
+    // A long line must be flushed before the DMA laps it
+    size_t unscanned = (current_pos + UAT_DMA_RX_SIZE - dma_scan_pos) % UAT_DMA_RX_SIZE;
+    bool force = uAT_DmaEndsWithPrompt(current_pos) || unscanned >= UAT_RX_BUFFER_SIZE / 2;
+
+    uAT_WakeTaskFromISR(lines, force, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+    return true;
+}
+#else
+// Copy new DMA data into the receive ring
+/**
+ * @brief Hand new DMA data over to uAT_Task
+ * 
+ * This function copies incoming data from the DMA receive buffer up to the given
+ * write position into the receive ring. It manages circular buffer wrapping and
+ * tracks the last processed position.
+ * 
+ * @note Called from ISR context. dma_last_pos and the producer side of the ring
+ *       are only used by the receive ISRs, which must not preempt each other.
+ * @param current_pos DMA write position, in [0, UAT_DMA_RX_SIZE)
+ * @return true if data was successfully processed, false if the ring was full
+ */
+static bool uAT_DmaRxPublish(size_t current_pos)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    size_t last_pos = dma_last_pos;
+    
+    // No new data
+    if (current_pos == last_pos) {
+        return true; // No error, just no new data
+    }
+    
+    // New data runs up to current_pos, or up to the end of the buffer and on from its start
+    size_t tail_len = (current_pos > last_pos) ? current_pos - last_pos : UAT_DMA_RX_SIZE - last_pos;
+    size_t head_len = (current_pos > last_pos) ? 0 : current_pos;
+    
+    uint32_t dropped = uat.rxStats.bytesDropped;
+    uint32_t lines = uAT_RxRingWrite(&uart_dma_rx_buf[last_pos], tail_len);
+    if (head_len > 0) {
+        lines += uAT_RxRingWrite(uart_dma_rx_buf, head_len);
+    }
+    
+    // Bytes that do not fit into a full ring are dropped
+    bool success = (uat.rxStats.bytesDropped == dropped);
+    dma_last_pos = current_pos;
+    
+    // Wake the task for complete lines, a prompt, or a filling ring
+    bool force = uAT_DmaEndsWithPrompt(current_pos) ||
+                 uAT_Ring_Used(&uat.rxRing) >= UAT_RX_RING_SIZE / 2;
+    uAT_WakeTaskFromISR(lines, force, &xHigherPriorityTaskWoken);
+    
+    // Yield if needed
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    
+    return success;
+}
+#endif
+
+/**
+ * @brief Handles UART IDLE line interrupt for DMA-based reception
+ * 
+ * Reads the current DMA write position and hands the new data over to uAT_Task.
+ * 
+ * @note This function is designed to be called from the UART IDLE line interrupt handler
+ * @return true if data was successfully processed, false on error
+ */
+bool uAT_UART_IdleHandler(void)
+{
+    if (uat.huart == NULL || uat.huart->hdmarx == NULL) {
+        return false; // Safety check for null pointers
+    }
+
+    // Counter reloads to UAT_DMA_RX_SIZE, so position UAT_DMA_RX_SIZE is the start
+    size_t current_pos = (UAT_DMA_RX_SIZE - __HAL_DMA_GET_COUNTER(uat.huart->hdmarx)) % UAT_DMA_RX_SIZE;
+
+    return uAT_DmaRxPublish(current_pos);
+}
+
+#ifdef UAT_DMA_RX_EVENT
+/**
+ * @brief HAL ReceiveToIdle event callback
+ *
+ * In circular ReceiveToIdle DMA mode HAL reports half-transfer, transfer-complete
+ * and IDLE events. Size is the DMA write position in uart_dma_rx_buf, so a burst
+ * without any idle gap is still handed over twice per lap of the buffer.
+ *
+ * @param huart UART handle that raised the event
+ * @param Size Number of bytes received since the start of the buffer
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    // Check if this is our UART
+    if (huart == uat.huart)
+    {
+        // Transfer complete reports Size == UAT_DMA_RX_SIZE, the start of the next lap
+        uAT_DmaRxPublish(Size % UAT_DMA_RX_SIZE);
+    }
+}
+#endif
+#endif
+
+#else
+/**
+ * @brief Handles UART IDLE line interrupt for interrupt-driven reception
+ * 
+ * Hands over bytes still staged by uAT_PushRxByte(), so data without a line
+ * end (e.g. a raw payload) does not wait for the next byte to arrive.
+ * 
+ * @note This function is designed to be called from the UART IDLE line interrupt handler
+ * @return true if the staged data was handed to uAT_Task, false on error
+ */
+bool uAT_UART_IdleHandler(void)
+{
+    if (uat.huart == NULL) {
+        return false; // Not initialized
+    }
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uAT_FlushRxStage(true, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+    return true;
+}
+
+// Byte-by-byte interrupt-driven receive
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    // Check if this is our UART
+    if (huart == uat.huart)
+    {
+        // Stage the received byte for the task
+        uAT_PushRxByte(it_rx_byte);
+        
+        // Restart reception for the next byte
+        HAL_UART_Receive_IT(uat.huart, &it_rx_byte, 1);
+    }
+}
+#endif
+
+#if !defined(UAT_DMA_RX_EVENT) && !defined(UAT_DMA_PINGPONG)
+// ISR: called from UART IRQ when IDLE flag set
+// add to USARTx_IRQHandler in stm32f7xx_it.c file
+// Note: the checking and calling uAT_UART_IdleHandler() is done before USARTx_IRQHandler.
+void USARTx_IRQHandler(void)
+{
+    // Check if this is our UART and if IDLE flag is set
+    if (uat.huart != NULL && __HAL_UART_GET_FLAG(uat.huart, UART_FLAG_IDLE))
+    {
+        // Clear the IDLE flag
+        __HAL_UART_CLEAR_IDLEFLAG(uat.huart);
+        
+        // Process received data
+        uAT_UART_IdleHandler();
+    }
+    
+    // Call the HAL UART IRQ handler
+    HAL_UART_IRQHandler(uat.huart);
+}
+#endif
+
+// Common TX complete callback (for both IT and DMA)
+/**
+ * @brief Callback function for UART transmission complete event
+ * 
+ * This function is called when a UART transmission is completed. It gives a binary semaphore
+ * to signal the transmission is finished, allowing waiting tasks to proceed.
+ * 
+ * @param huart Pointer to the UART handle that completed transmission
+ * 
+ * @note This is an ISR (Interrupt Service Routine) callback function
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    // Check if this is our UART
+    if (huart == uat.huart)
+    {
+        BaseType_t xHigher = pdFALSE;
+        
+        // Signal that transmission is complete
+        xSemaphoreGiveFromISR(uat.txComplete, &xHigher);
+        
+        // Yield if a higher priority task was woken
+        portYIELD_FROM_ISR(xHigher);
+    }
+}
+
+#ifdef UAT_STATIC_HANDLERS
+/**
+ * @brief Compare a static command with the first bytes of a line
+ *
+ * @param entry Static table entry
+ * @param line Line bytes
+ * @param len Number of line bytes to compare
+ * @return <0, 0 or >0 as the command sorts before, equal to or after them
+ */
+static int uAT_CompareStatic(const uAT_CommandEntry *entry, const char *line, size_t len)
+{
+    size_t n = entry->length < len ? entry->length : len;
+    int diff = memcmp(entry->command, line, n);
+    if (diff != 0) {
+        return diff;
+    }
+    return (entry->length > len) - (entry->length < len);
+}
+
+/**
+ * @brief Check the static table is sorted, without duplicate or empty commands
+ *
+ * @return true if uAT_FindStatic() can search the table
+ */
+static bool uAT_StaticTableValid(void)
+{
+    for (size_t i = 0; i < UAT_STATIC_COUNT; i++) {
+        const uAT_CommandEntry *entry = &uAT_StaticHandlers[i];
+        if (entry->length == 0 || entry->length >= UAT_RX_BUFFER_SIZE || entry->handler == NULL) {
+            return false;
+        }
+        if (i > 0 && strcmp(uAT_StaticHandlers[i - 1].command, entry->command) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Find the longest static command that is a prefix of a line
+ *
+ * Every prefix of the line sorts at or before the line, and at or before
+ * the greatest command that does. If that command is not a prefix itself,
+ * any prefix that is must also be a prefix of the bytes the two share, so
+ * the search repeats on those with a shorter key.
+ *
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @return Matching entry, or NULL if none
+ */
+static const uAT_CommandEntry *uAT_FindStatic(const char *line, size_t len)
+{
+    size_t end = UAT_STATIC_COUNT;
+
+    while (end > 0 && len > 0) {
+        // Binary search for the first entry after line[0..len)
+        size_t lo = 0;
+        size_t hi = end;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (uAT_CompareStatic(&uAT_StaticHandlers[mid], line, len) <= 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) {
+            return NULL;
+        }
+
+        const uAT_CommandEntry *entry = &uAT_StaticHandlers[lo - 1];
+        size_t common = 0;
+        while (common < entry->length && common < len && entry->command[common] == line[common]) {
+            common++;
+        }
+        if (common == entry->length) {
+            return entry;
+        }
+        len = common;
+        end = lo - 1;
+    }
+    return NULL;
+}
+#endif
+
+// === CORE API ===
+
+#ifdef UAT_WORK_QUEUES
+/**
+ * @brief Set up an empty work queue
+ *
+ * @param q Queue to set up
+ * @param items Storage for the queued items
+ * @param size Number of items in storage
+ */
+static void uAT_WorkQueue_Init(uAT_WorkQueue_t *q, uAT_WorkItem_t *items, uint32_t size)
+{
+    q->items = items;
+    q->size = size;
+    q->head = 0;
+    q->tail = 0;
+    q->task = NULL;
+    q->highWater = 0;
+    q->stalls = 0;
+}
+#endif
+
+/**
+ * @brief Delete the completion semaphores of the first count transaction slots
+ *
+ * @param count Number of slots whose semaphore was created
+ */
+static void uAT_DeleteTxnSems(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        vSemaphoreDelete(uat.txns[i].done);
+    }
+}
+
+/**
+ * @brief  Initialize the uAT parser module
+ * @param  huart Pointer to HAL UART handle
+ * @return UAT_OK if successful, or appropriate error code on failure
+ */
+uAT_Result_t uAT_Init(UART_HandleTypeDef *huart)
+{
+    // Validate input parameters
+    if (!huart) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+#ifdef UAT_STATIC_HANDLERS
+    // Binary search needs the build-time list in order
+    if (!uAT_StaticTableValid()) {
+        return UAT_ERR_INIT_FAIL;
+    }
+#endif
+
+    // Clear the handle structure
+    memset(&uat, 0, sizeof(uat));
+    uat.huart = huart;
+    
+#ifdef UAT_RX_RING
+    // Size is checked at compile time, cannot fail
+    uAT_Ring_Init(&uat.rxRing, uat.rxRingBuf, sizeof(uat.rxRingBuf));
+#endif
+    
+    // Create FreeRTOS primitives
+    uat.txComplete = xSemaphoreCreateBinary();
+    if (!uat.txComplete) {
+        return UAT_ERR_RESOURCE;
+    }
+    
+    uat.txMutex = xSemaphoreCreateMutex();
+    if (!uat.txMutex) {
+        vSemaphoreDelete(uat.txComplete);
+        return UAT_ERR_RESOURCE;
     }
     
     uat.handlerMutex = xSemaphoreCreateMutex();
     if (!uat.handlerMutex) {
-        vStreamBufferDelete(uat.rxStream);
         vSemaphoreDelete(uat.txComplete);
         vSemaphoreDelete(uat.txMutex);
         return UAT_ERR_RESOURCE;
     }
-    
-    uat.sendReceiveSem = xSemaphoreCreateBinary();
-    if (!uat.sendReceiveSem) {
-        vStreamBufferDelete(uat.rxStream);
-        vSemaphoreDelete(uat.txComplete);
-        vSemaphoreDelete(uat.txMutex);
-        vSemaphoreDelete(uat.handlerMutex);
-        return UAT_ERR_RESOURCE;
+    
+    uat.tableFreed = xSemaphoreCreateBinary();
+    if (!uat.tableFreed) {
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        return UAT_ERR_RESOURCE;
+    }
+    
+    uat.sinkFreed = xSemaphoreCreateBinary();
+    if (!uat.sinkFreed) {
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        vSemaphoreDelete(uat.tableFreed);
+        return UAT_ERR_RESOURCE;
+    }
+    
+    uat.txnFreed = xSemaphoreCreateBinary();
+    if (!uat.txnFreed) {
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        vSemaphoreDelete(uat.tableFreed);
+        vSemaphoreDelete(uat.sinkFreed);
+        return UAT_ERR_RESOURCE;
+    }
+    
+#ifdef UAT_WORK_QUEUES
+    uat.workFreed = xSemaphoreCreateBinary();
+    if (!uat.workFreed) {
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        vSemaphoreDelete(uat.tableFreed);
+        vSemaphoreDelete(uat.sinkFreed);
+        vSemaphoreDelete(uat.txnFreed);
+        return UAT_ERR_RESOURCE;
+    }
+#endif
+    
+    for (uint32_t i = 0; i < UAT_TXN_QUEUE_LEN; i++) {
+        uat.txns[i].state = UAT_TXN_FREE;
+        uat.txns[i].done = xSemaphoreCreateBinary();
+        if (!uat.txns[i].done) {
+            vSemaphoreDelete(uat.txComplete);
+            vSemaphoreDelete(uat.txMutex);
+            vSemaphoreDelete(uat.handlerMutex);
+            vSemaphoreDelete(uat.tableFreed);
+            vSemaphoreDelete(uat.sinkFreed);
+            vSemaphoreDelete(uat.txnFreed);
+#ifdef UAT_WORK_QUEUES
+            vSemaphoreDelete(uat.workFreed);
+#endif
+            uAT_DeleteTxnSems(i);
+            return UAT_ERR_RESOURCE;
+        }
+    }
+    
+    // Initialize state variables
+    uat.txnHead = 0;
+    uat.txnTail = 0;
+    uat.txnWaiters = 0;
+#ifdef UAT_RESP_POOL
+    memset((void *)uat.respLent, 0, sizeof(uat.respLent));
+#endif
+    uAT_Match_Init(&uat.tables[0].cmdMatcher, uat.tables[0].cmdNodes, UAT_MATCH_MAX_NODES);
+    uAT_Match_Init(&uat.tables[1].cmdMatcher, uat.tables[1].cmdNodes, UAT_MATCH_MAX_NODES);
+    uat.tableActive = 0;
+    uat.tableReader = UAT_TABLE_NONE;
+#ifdef UAT_URC_TASK
+    uAT_WorkQueue_Init(&uat.urcQueue, uat.urcItems, UAT_URC_QUEUE_LEN);
+#endif
+#ifdef UAT_WORKER_TASKS
+    for (uint32_t i = 0; i < UAT_WORKER_TASKS; i++) {
+        uAT_WorkQueue_Init(&uat.workerQueues[i], uat.workerItems[i], UAT_WORKER_QUEUE_LEN);
+    }
+#endif
+#ifdef UAT_PROFILE_DWT
+    // Start the cycle counter behind UAT_PROFILE_NOW()
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+#ifndef UAT_DMA_ZERO_COPY
+    // One spare byte so a line never reaches UAT_RX_BUFFER_SIZE
+    uAT_Line_Init(&uat.rxLine, uat.rxLineBuf, sizeof(uat.rxLineBuf) - 1, UAT_LINE_TERMINATOR);
+    uAT_Line_SetPrompt(&uat.rxLine, UAT_SCAN_PROMPT);
+#endif
+
+#ifdef UAT_USE_DMA
+    // Reset DMA position tracking
+#if defined(UAT_DMA_PINGPONG)
+    dma_pp_owner[0] = UAT_PP_DMA;
+    dma_pp_owner[1] = UAT_PP_DMA;
+    dma_pp_active = 0;
+    dma_pp_next = 0;
+    dma_pp_lost = false;
+    dma_pp_stopped = false;
+#elif defined(UAT_DMA_ZERO_COPY)
+    dma_write_pos = 0;
+    dma_read_pos = 0;
+    dma_scan_pos = 0;
+    dma_line_len = 0;
+    dma_overruns_seen = 0;
+    dma_discard = false;
+#else
+    dma_last_pos = 0;
+#endif
+    
+    // Start circular DMA reception
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    if (uAT_StartDmaRx() != HAL_OK) {
+        // Clean up all resources on failure
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        vSemaphoreDelete(uat.tableFreed);
+        vSemaphoreDelete(uat.sinkFreed);
+        vSemaphoreDelete(uat.txnFreed);
+#ifdef UAT_WORK_QUEUES
+        vSemaphoreDelete(uat.workFreed);
+#endif
+        uAT_DeleteTxnSems(UAT_TXN_QUEUE_LEN);
+        return UAT_ERR_INIT_FAIL;
+    }
+#else
+    // Start byte-by-byte IRQ reception
+    it_stage_len = 0;
+    if (HAL_UART_Receive_IT(huart, &it_rx_byte, 1) != HAL_OK) {
+        // Clean up all resources on failure
+        vSemaphoreDelete(uat.txComplete);
+        vSemaphoreDelete(uat.txMutex);
+        vSemaphoreDelete(uat.handlerMutex);
+        vSemaphoreDelete(uat.tableFreed);
+        vSemaphoreDelete(uat.sinkFreed);
+        vSemaphoreDelete(uat.txnFreed);
+#ifdef UAT_WORK_QUEUES
+        vSemaphoreDelete(uat.workFreed);
+#endif
+        uAT_DeleteTxnSems(UAT_TXN_QUEUE_LEN);
+        return UAT_ERR_INIT_FAIL;
+    }
+
+    // IDLE flushes the staged bytes
+    __HAL_UART_CLEAR_IDLEFLAG(huart);
+    __HAL_UART_ENABLE_IT(uat.huart, UART_IT_IDLE);
+#endif
+
+    return UAT_OK;
+}
+
+/**
+ * @brief Take the active handler table snapshot for reading
+ *
+ * Only uAT_Task reads the table. It announces the snapshot it reads, then
+ * checks that the snapshot is still the active one, so a writer that swapped
+ * in between cannot miss the announcement in uAT_BeginTableUpdate().
+ *
+ * @return Snapshot to dispatch from, valid until uAT_ReleaseTable()
+ */
+static const uAT_HandlerTable_t *uAT_AcquireTable(void)
+{
+    uint8_t index;
+    do {
+        index = UAT_SHARED_LOAD(&uat.tableActive);
+        UAT_SHARED_STORE(&uat.tableReader, index);
+    } while (UAT_SHARED_LOAD(&uat.tableActive) != index);
+    return &uat.tables[index];
+}
+
+/**
+ * @brief Release the snapshot taken by uAT_AcquireTable()
+ */
+static void uAT_ReleaseTable(void)
+{
+    UAT_SHARED_STORE(&uat.tableReader, UAT_TABLE_NONE);
+    if (UAT_SHARED_LOAD(&uat.tableWaiting)) {
+        xSemaphoreGive(uat.tableFreed);
+    }
+}
+
+/**
+ * @brief Start a change to the handler table
+ * @note  This function should be called with `uat.handlerMutex` already taken
+ *
+ * Copies the active snapshot into the spare one for the writer to modify.
+ * uAT_Task may still be reading the spare one if it took it before the last
+ * swap; that is at most one lookup, so the writer blocks on tableFreed until
+ * uAT_ReleaseTable() gives it. The writer raises tableWaiting before checking
+ * the reader and uAT_Task leaves before checking tableWaiting, so one of the
+ * two always sees the other.
+ *
+ * @return Spare snapshot to modify
+ */
+static uAT_HandlerTable_t *uAT_BeginTableUpdate(void)
+{
+    uint8_t spare = (uint8_t)(1 - uat.tableActive);
+    UAT_SHARED_STORE(&uat.tableWaiting, true);
+    while (UAT_SHARED_LOAD(&uat.tableReader) == spare) {
+        xSemaphoreTake(uat.tableFreed, portMAX_DELAY);
+    }
+    UAT_SHARED_STORE(&uat.tableWaiting, false);
+
+    uAT_HandlerTable_t *t = &uat.tables[spare];
+    memcpy(t, &uat.tables[uat.tableActive], sizeof(*t));
+    t->cmdMatcher.nodes = t->cmdNodes;
+    return t;
+}
+
+/**
+ * @brief Check whether two entries are for the same command or pattern
+ */
+static bool uAT_SameCommand(const uAT_CommandEntry *a, const uAT_CommandEntry *b)
+{
+    return a->pattern == b->pattern && a->length == b->length &&
+           memcmp(a->command, b->command, a->length) == 0;
+}
+
+/**
+ * @brief Chain every entry to the next one for the same command
+ *
+ * The matcher points at the earliest entry of a command; dispatch follows
+ * next from there to reach the others in order.
+ *
+ * @param t Snapshot being modified
+ */
+static void uAT_LinkEntries(uAT_HandlerTable_t *t)
+{
+    for (size_t i = 0; i < UAT_MAX_CMD_HANDLERS; i++) {
+        uAT_CommandEntry *entry = &t->cmdHandlers[i];
+        if (entry->command == NULL) {
+            continue;
+        }
+        entry->next = UAT_MATCH_NONE;
+        for (size_t j = 0; j < UAT_MAX_CMD_HANDLERS; j++) {
+            const uAT_CommandEntry *other = &t->cmdHandlers[j];
+            if (other->command != NULL && other->order > entry->order &&
+                (entry->next == UAT_MATCH_NONE || other->order < t->cmdHandlers[entry->next].order) &&
+                uAT_SameCommand(entry, other)) {
+                entry->next = (uint16_t)j;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Publish the snapshot prepared since uAT_BeginTableUpdate()
+ * @note  This function should be called with `uat.handlerMutex` already taken
+ */
+static void uAT_CommitTableUpdate(void)
+{
+    uAT_LinkEntries(&uat.tables[1 - uat.tableActive]);
+    UAT_SHARED_STORE(&uat.tableActive, (uint8_t)(1 - uat.tableActive));
+}
+
+/**
+ * @brief Get the slot the matcher holds for a command or pattern
+ *
+ * @param t Snapshot to search
+ * @param cmd Command string
+ * @param len Length of cmd
+ * @param pattern true if cmd is a glob pattern
+ * @return Slot, or UAT_MATCH_NONE
+ */
+static uint16_t uAT_MatcherGet(const uAT_HandlerTable_t *t, const char *cmd, size_t len, bool pattern)
+{
+    return pattern ? uAT_Match_GetPattern(&t->cmdMatcher, cmd, len)
+                   : uAT_Match_Get(&t->cmdMatcher, cmd, len);
+}
+
+/**
+ * @brief Point the matcher at a slot if it is the earliest entry for its command
+ *
+ * @param t Snapshot being modified
+ * @param slot Slot in cmdHandlers
+ * @return true on success, false if the trie node pool is exhausted
+ */
+static bool uAT_IndexHandler(uAT_HandlerTable_t *t, size_t slot)
+{
+    const uAT_CommandEntry *entry = &t->cmdHandlers[slot];
+    uint16_t current = uAT_MatcherGet(t, entry->command, entry->length, entry->pattern);
+
+    if (current != UAT_MATCH_NONE && t->cmdHandlers[current].order < entry->order) {
+        return true; // An earlier entry for the same command keeps priority
+    }
+    if (entry->pattern) {
+        return uAT_Match_InsertPattern(&t->cmdMatcher, entry->command, entry->length, (uint16_t)slot);
+    }
+    return uAT_Match_Insert(&t->cmdMatcher, entry->command, entry->length, (uint16_t)slot);
+}
+
+/**
+ * @brief Rebuild the matcher from the handler table
+ *
+ * Removed commands leave unused trie nodes behind; rebuilding releases them.
+ *
+ * @param t Snapshot being modified
+ * @return true on success, false if the live commands do not fit
+ */
+static bool uAT_RebuildMatcher(uAT_HandlerTable_t *t)
+{
+    uAT_Match_Clear(&t->cmdMatcher);
+    for (size_t i = 0; i < UAT_MAX_CMD_HANDLERS; i++) {
+        if (t->cmdHandlers[i].command != NULL && !uAT_IndexHandler(t, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Add an entry to the handler table and the matcher
+ *
+ * @param t Snapshot being modified
+ * @param cmd Null-terminated command string
+ * @param len Length of cmd
+ * @param handler Handler to call, or NULL if handlerEx is set
+ * @param handlerEx Extended handler to call, or NULL if handler is set
+ * @param ctx Context passed to handlerEx
+ * @param first true to give the entry priority over all others (URC)
+ * @param pattern true if cmd is a glob pattern
+ * @param subscriber true if added with uAT_Subscribe()
+ * @return UAT_OK on success, or UAT_ERR_RESOURCE if the table or trie is full
+ */
+static uAT_Result_t uAT_AddHandler(uAT_HandlerTable_t *t, const char *cmd, size_t len,
+                                   uAT_CommandHandler handler, uAT_CommandHandlerEx handlerEx,
+                                   void *ctx, bool first, bool pattern, bool subscriber)
+{
+    size_t slot = 0;
+    while (slot < UAT_MAX_CMD_HANDLERS && t->cmdHandlers[slot].command != NULL) {
+        slot++;
+    }
+    if (slot == UAT_MAX_CMD_HANDLERS) {
+        return UAT_ERR_RESOURCE;
+    }
+
+    uAT_CommandEntry *entry = &t->cmdHandlers[slot];
+    entry->command = cmd;
+    entry->length = len;
+    entry->handler = handler;
+    entry->handlerEx = handlerEx;
+    entry->ctx = ctx;
+    entry->order = first ? --t->cmdOrderFirst : ++t->cmdOrderLast;
+    entry->urc = first;
+    entry->pattern = pattern;
+    entry->subscriber = subscriber;
+
+    // A full trie may only hold nodes of removed commands, compact it once.
+    // On failure the snapshot is simply not published
+    if (!uAT_IndexHandler(t, slot) && !uAT_RebuildMatcher(t)) {
+        return UAT_ERR_RESOURCE;
+    }
+
+    t->cmdCount++;
+    return UAT_OK;
+}
+
+/**
+ * @brief Remove an entry from the handler table and the matcher
+ *
+ * @param t Snapshot being modified
+ * @param slot Slot in cmdHandlers
+ */
+static void uAT_RemoveHandler(uAT_HandlerTable_t *t, size_t slot)
+{
+    uAT_CommandEntry *entry = &t->cmdHandlers[slot];
+    const char *cmd = entry->command;
+    size_t len = entry->length;
+    bool pattern = entry->pattern;
+
+    entry->command = NULL;
+    entry->handler = NULL;
+    entry->handlerEx = NULL;
+    t->cmdCount--;
+
+    if (uAT_MatcherGet(t, cmd, len, pattern) != (uint16_t)slot) {
+        return;
+    }
+    if (pattern) {
+        uAT_Match_RemovePattern(&t->cmdMatcher, cmd, len);
+    } else {
+        uAT_Match_Remove(&t->cmdMatcher, cmd, len);
+    }
+
+    // Another entry for the same command takes over, its path already exists
+    for (size_t i = 0; i < UAT_MAX_CMD_HANDLERS; i++) {
+        if (t->cmdHandlers[i].command != NULL && t->cmdHandlers[i].pattern == pattern &&
+            t->cmdHandlers[i].length == len && memcmp(t->cmdHandlers[i].command, cmd, len) == 0) {
+            uAT_IndexHandler(t, i);
+        }
+    }
+}
+
+/**
+ * @brief Find an entry for a command, following the chain from its earliest
+ *
+ * @param t Snapshot to search
+ * @param cmd Command string
+ * @param len Length of cmd
+ * @param pattern true if cmd is a glob pattern
+ * @param subscriber Find an entry added with uAT_Subscribe() rather than the registered one
+ * @param handlerEx Subscriber: its handler
+ * @param ctx Subscriber: its context
+ * @param count If not NULL, set to the number of entries for the command
+ * @return Slot, or UAT_MATCH_NONE
+ */
+static uint16_t uAT_FindEntry(const uAT_HandlerTable_t *t, const char *cmd, size_t len, bool pattern,
+                              bool subscriber, uAT_CommandHandlerEx handlerEx, void *ctx, size_t *count)
+{
+    uint16_t found = UAT_MATCH_NONE;
+    size_t n = 0;
+
+    for (uint16_t slot = uAT_MatcherGet(t, cmd, len, pattern); slot != UAT_MATCH_NONE;
+         slot = t->cmdHandlers[slot].next) {
+        const uAT_CommandEntry *entry = &t->cmdHandlers[slot];
+        if (found == UAT_MATCH_NONE && entry->subscriber == subscriber &&
+            (!subscriber || (entry->handlerEx == handlerEx && entry->ctx == ctx))) {
+            found = slot;
+        }
+        n++;
+    }
+    if (count != NULL) {
+        *count = n;
+    }
+    return found;
+}
+
+/**
+ * @brief Register a command with either kind of handler
+ *
+ * @param cmd Null-terminated string to match at start of line
+ * @param handler Handler to call, or NULL if handlerEx is set
+ * @param handlerEx Extended handler to call, or NULL if handler is set
+ * @param ctx Context passed to handlerEx
+ * @param urc true to remove any entry for cmd and insert ahead of all others
+ * @param pattern true if cmd is a glob pattern
+ * @return UAT_OK if registered, or appropriate error code on failure
+ */
+static uAT_Result_t uAT_Register(const char *cmd, uAT_CommandHandler handler,
+                                 uAT_CommandHandlerEx handlerEx, void *ctx, bool urc, bool pattern)
+{
+    // Validate input parameters
+    if (!cmd || (!handler && !handlerEx)) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    
+    // Check command length
+    size_t cmdLen = strlen(cmd);
+    if (cmdLen == 0 || cmdLen >= UAT_RX_BUFFER_SIZE) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    if (pattern && !uAT_Match_PatternValid(cmd, cmdLen)) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Writers are serialized; uAT_Task keeps dispatching from the active snapshot
+    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
+        return UAT_ERR_BUSY;
+    }
+
+    uAT_HandlerTable_t *t = uAT_BeginTableUpdate();
+    uAT_Result_t result;
+
+    // Check if command already exists; subscribers are left alone
+    size_t count;
+    uint16_t slot = uAT_FindEntry(t, cmd, cmdLen, pattern, false, NULL, NULL, &count);
+    if (slot == UAT_MATCH_NONE && count >= UAT_MAX_SUBSCRIBERS) {
+        result = UAT_ERR_RESOURCE;
+    } else if (slot != UAT_MATCH_NONE && !urc) {
+        // Update existing handler
+        t->cmdHandlers[slot].handler = handler;
+        t->cmdHandlers[slot].handlerEx = handlerEx;
+        t->cmdHandlers[slot].ctx = ctx;
+        result = UAT_OK;
+    } else {
+        // A URC is reinserted with priority
+        if (slot != UAT_MATCH_NONE) {
+            uAT_RemoveHandler(t, slot);
+        }
+        result = uAT_AddHandler(t, cmd, cmdLen, handler, handlerEx, ctx, urc, pattern, false);
+    }
+
+    if (result == UAT_OK) {
+        uAT_CommitTableUpdate();
+    }
+    xSemaphoreGive(uat.handlerMutex);
+    return result;
+}
+
+/**
+ * @brief  Register a command string and its handler
+ * @param  cmd     Null-terminated string to match at start of line
+ * @param  handler Function called when a line beginning with cmd arrives
+ * @return UAT_OK if registered, or appropriate error code on failure
+ */
+uAT_Result_t uAT_RegisterCommand(const char *cmd, uAT_CommandHandler handler)
+{
+    if (!handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    return uAT_Register(cmd, handler, NULL, NULL, false, false);
+}
+
+/**
+ * @brief  Register a command string and an extended handler
+ * @param  cmd     Null-terminated string to match at start of line
+ * @param  handler Function called with a view of the arguments when a line beginning with cmd arrives
+ * @param  ctx     Pointer passed to handler unchanged
+ * @return UAT_OK if registered, or appropriate error code on failure
+ */
+uAT_Result_t uAT_RegisterCommandEx(const char *cmd, uAT_CommandHandlerEx handler, void *ctx)
+{
+    if (!handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    return uAT_Register(cmd, NULL, handler, ctx, false, false);
+}
+
+/**
+ * @brief  Register a glob pattern and its handler
+ * @param  pattern Null-terminated glob pattern to match at start of line
+ * @param  handler Function called when a line matching pattern arrives
+ * @return UAT_OK if registered, or appropriate error code on failure
+ */
+uAT_Result_t uAT_RegisterPattern(const char *pattern, uAT_CommandHandler handler)
+{
+    if (!handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    return uAT_Register(pattern, handler, NULL, NULL, false, true);
+}
+
+/**
+ * @brief  Register a glob pattern and an extended handler
+ * @param  pattern Null-terminated glob pattern to match at start of line
+ * @param  handler Function called with a view of the arguments when a line matching pattern arrives
+ * @param  ctx     Pointer passed to handler unchanged
+ * @return UAT_OK if registered, or appropriate error code on failure
+ */
+uAT_Result_t uAT_RegisterPatternEx(const char *pattern, uAT_CommandHandlerEx handler, void *ctx)
+{
+    if (!handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    return uAT_Register(pattern, NULL, handler, ctx, false, true);
+}
+
+/**
+ * @brief  Unregister a previously registered command
+ * @param  cmd Null-terminated string of the command to unregister
+ * @return UAT_OK if unregistered, or appropriate error code on failure
+ */
+uAT_Result_t uAT_UnregisterCommand(const char *cmd)
+{
+    // Validate input parameters
+    if (!cmd) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
+        return UAT_ERR_BUSY;
+    }
+    
+    // Only the registered handler goes, subscribers stay
+    uAT_HandlerTable_t *t = uAT_BeginTableUpdate();
+    uint16_t slot = uAT_FindEntry(t, cmd, strlen(cmd), false, false, NULL, NULL, NULL);
+    if (slot == UAT_MATCH_NONE) {
+        slot = uAT_FindEntry(t, cmd, strlen(cmd), true, false, NULL, NULL, NULL);
+    }
+    if (slot == UAT_MATCH_NONE) {
+        // Command not found
+        xSemaphoreGive(uat.handlerMutex);
+        return UAT_ERR_NOT_FOUND;
+    }
+
+    uAT_RemoveHandler(t, slot);
+    uAT_CommitTableUpdate();
+    xSemaphoreGive(uat.handlerMutex);
+    return UAT_OK;
+}
+
+/**
+ * @brief  Add a handler to the lines beginning with a command
+ * @param  cmd Null-terminated string to match at start of line
+ * @param  handler Function called when a line beginning with cmd arrives
+ * @param  ctx Pointer passed to handler unchanged
+ * @return UAT_OK if subscribed or already subscribed, or appropriate error code on failure
+ */
+uAT_Result_t uAT_Subscribe(const char *cmd, uAT_CommandHandlerEx handler, void *ctx)
+{
+    if (!cmd || !handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    size_t cmdLen = strlen(cmd);
+    if (cmdLen == 0 || cmdLen >= UAT_RX_BUFFER_SIZE) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
+        return UAT_ERR_BUSY;
+    }
+
+    uAT_HandlerTable_t *t = uAT_BeginTableUpdate();
+    uAT_Result_t result;
+    size_t count;
+    if (uAT_FindEntry(t, cmd, cmdLen, false, true, handler, ctx, &count) != UAT_MATCH_NONE) {
+        xSemaphoreGive(uat.handlerMutex);
+        return UAT_OK;
+    }
+    if (count >= UAT_MAX_SUBSCRIBERS) {
+        result = UAT_ERR_RESOURCE;
+    } else {
+        result = uAT_AddHandler(t, cmd, cmdLen, NULL, handler, ctx, false, false, true);
+    }
+
+    if (result == UAT_OK) {
+        uAT_CommitTableUpdate();
+    }
+    xSemaphoreGive(uat.handlerMutex);
+    return result;
+}
+
+/**
+ * @brief  Remove a handler added with uAT_Subscribe()
+ * @param  cmd Command the handler subscribed to
+ * @param  handler Handler passed to uAT_Subscribe()
+ * @param  ctx Context passed to uAT_Subscribe()
+ * @return UAT_OK if unsubscribed, or appropriate error code on failure
+ */
+uAT_Result_t uAT_Unsubscribe(const char *cmd, uAT_CommandHandlerEx handler, void *ctx)
+{
+    if (!cmd || !handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
+        return UAT_ERR_BUSY;
+    }
+
+    uAT_HandlerTable_t *t = uAT_BeginTableUpdate();
+    uint16_t slot = uAT_FindEntry(t, cmd, strlen(cmd), false, true, handler, ctx, NULL);
+    if (slot == UAT_MATCH_NONE) {
+        xSemaphoreGive(uat.handlerMutex);
+        return UAT_ERR_NOT_FOUND;
+    }
+
+    uAT_RemoveHandler(t, slot);
+    uAT_CommitTableUpdate();
+    xSemaphoreGive(uat.handlerMutex);
+    return UAT_OK;
+}
+
+/**
+ * @brief Length of arguments without the line terminator
+ *
+ * @param args Arguments of a received line
+ * @param len Length of args, possibly including the terminator
+ * @return Length of args for an extended handler
+ */
+static size_t uAT_ViewLength(const char *args, size_t len)
+{
+    static const char term[] = UAT_LINE_TERMINATOR;
+    const size_t termLen = sizeof(term) - 1;
+
+    if (len >= termLen && memcmp(args + len - termLen, term, termLen) == 0) {
+        len -= termLen;
+    }
+    return len;
+}
+
+/**
+ * @brief Append a received line to a transaction's text sink
+ *
+ * The line is cut short when the buffer is full and counted as dropped.
+ *
+ * @param slot Active transaction with a text sink
+ * @param data Received line including terminator
+ * @param len Length of the line
+ */
+static void uAT_AppendToResponseBuffer(uAT_TxnSlot_t *slot, const char *data, size_t len)
+{
+    // bytesCaptured is the write position in buf
+    size_t pos = slot->result.bytesCaptured;
+    size_t spaceLeft = slot->bufSize - pos - 1; // -1 for null terminator
+
+    if (len > spaceLeft) {
+        len = spaceLeft;
+        slot->result.linesDropped++;
+    }
+
+    memcpy(slot->buf + pos, data, len);
+    slot->buf[pos + len] = '\0'; // Ensure null termination
+    slot->result.bytesCaptured = pos + len;
+}
+
+/**
+ * @brief Store a received line in a transaction's line view sink
+ *
+ * Line views are stored from the start of the arena so they form an array,
+ * their text (without terminator, null-terminated) from the end.
+ *
+ * @param slot Active transaction with a line view sink
+ * @param line Received line including terminator
+ * @param len Length of line
+ */
+static void uAT_AppendToArena(uAT_TxnSlot_t *slot, const char *line, size_t len)
+{
+    size_t textLen = uAT_ViewLength(line, len);
+
+    if ((size_t)(slot->arenaHigh - slot->arenaLow) < sizeof(uAT_LineView_t) + textLen + 1) {
+        slot->result.linesDropped++;
+        return;
+    }
+
+    slot->arenaHigh -= textLen + 1;
+    memcpy(slot->arenaHigh, line, textLen);
+    slot->arenaHigh[textLen] = '\0';
+
+    uAT_LineView_t *view = (uAT_LineView_t *)slot->arenaLow;
+    view->text = (const char *)slot->arenaHigh;
+    view->len = textLen;
+    slot->arenaLow += sizeof(uAT_LineView_t);
+    slot->result.bytesCaptured += textLen;
+}
+
+/**
+ * @brief Final result codes, see uAT_FinalCode()
+ */
+static const struct {
+    const char *text;
+    uint8_t len;
+    uAT_FinalCode_t code;
+} uAT_FinalCodes[] = {
+    { "OK",          2,  UAT_FINAL_OK },
+    { "ERROR",       5,  UAT_FINAL_ERROR },
+    { "+CME ERROR:", 11, UAT_FINAL_CME_ERROR },
+    { "+CMS ERROR:", 11, UAT_FINAL_CMS_ERROR },
+    { "CONNECT",     7,  UAT_FINAL_CONNECT },
+    { "NO CARRIER",  10, UAT_FINAL_NO_CARRIER },
+    { "BUSY",        4,  UAT_FINAL_BUSY },
+    { "NO ANSWER",   9,  UAT_FINAL_NO_ANSWER },
+    { "NO DIALTONE", 11, UAT_FINAL_NO_DIALTONE },
+};
+
+/**
+ * @brief Recognize a V.250 or 3GPP final result code
+ *
+ * The error lines take a number or, in verbose mode, text after the colon;
+ * CONNECT may be followed by a rate. The other codes are the whole line.
+ *
+ * @param line Received line including terminator (need not be null-terminated)
+ * @param len Length of line
+ * @param errorCode Set to the +CME/+CMS ERROR number, left alone otherwise
+ * @return The final result code, or UAT_FINAL_NONE for any other line
+ */
+static uAT_FinalCode_t uAT_FinalCode(const char *line, size_t len, int32_t *errorCode)
+{
+    size_t textLen = uAT_ViewLength(line, len);
+
+    for (size_t i = 0; i < sizeof(uAT_FinalCodes) / sizeof(uAT_FinalCodes[0]); i++) {
+        size_t codeLen = uAT_FinalCodes[i].len;
+        if (textLen < codeLen || memcmp(line, uAT_FinalCodes[i].text, codeLen) != 0) {
+            continue;
+        }
+
+        uAT_FinalCode_t code = uAT_FinalCodes[i].code;
+        if (code == UAT_FINAL_CME_ERROR || code == UAT_FINAL_CMS_ERROR) {
+            size_t pos = codeLen;
+            while (pos < textLen && line[pos] == ' ') {
+                pos++;
+            }
+            if (pos < textLen && line[pos] >= '0' && line[pos] <= '9') {
+                int32_t value = 0;
+                while (pos < textLen && line[pos] >= '0' && line[pos] <= '9' && value < 100000) {
+                    value = value * 10 + (line[pos++] - '0');
+                }
+                *errorCode = value;
+            }
+            return code;
+        }
+        if (textLen == codeLen || (code == UAT_FINAL_CONNECT && line[codeLen] == ' ')) {
+            return code;
+        }
+    }
+    return UAT_FINAL_NONE;
+}
+
+/**
+ * @brief Free a transaction slot along with any buffer it was lent
+ *
+ * Wakes a submitter waiting for a slot, see uAT_TxnSubmit(). The slot is
+ * freed before the waiters are checked and a submitter counts itself
+ * before looking for a slot, so the wakeup is not missed.
+ *
+ * @param slot Transaction nobody will collect
+ */
+static void uAT_TxnFree(uAT_TxnSlot_t *slot)
+{
+#ifdef UAT_RESP_POOL
+    if (slot->loan != 0) {
+        UAT_SHARED_STORE(&uat.respLent[slot->loan - 1], false);
+    }
+#endif
+    UAT_SHARED_STORE(&slot->state, UAT_TXN_FREE);
+    if (UAT_SHARED_LOAD(&uat.txnWaiters) != 0) {
+        xSemaphoreGive(uat.txnFreed);
+    }
+}
+
+/**
+ * @brief Slot at the front of the queue
+ *
+ * @return The slot sent or next to send; its state tells whether it is in
+ *         the queue at all
+ */
+static uAT_TxnSlot_t *uAT_TxnFront(void)
+{
+    return &uat.txns[uat.txnOrder[UAT_SHARED_LOAD(&uat.txnTail)]];
+}
+
+/**
+ * @brief Wait for uAT_Task to finish writing a line to a transaction's sink
+ *
+ * Blocks on sinkFreed, given by uAT_CaptureResponse() when it sees
+ * sinkWaiters. The waiter counts itself before checking the state and
+ * uAT_Task stores the state before checking the count, so the wakeup is not
+ * missed. Each waiter passes the wakeup on to the next one.
+ *
+ * @param slot Transaction being captured
+ * @param handle Handle of the transaction, in case the slot is reused meanwhile
+ */
+static void uAT_TxnWaitCapture(uAT_TxnSlot_t *slot, uAT_TxnHandle_t handle)
+{
+    UAT_SHARED_ADD(&uat.sinkWaiters, 1);
+    while (UAT_SHARED_LOAD(&slot->state) == UAT_TXN_CAPTURING && UAT_SHARED_LOAD(&slot->handle) == handle) {
+        xSemaphoreTake(uat.sinkFreed, portMAX_DELAY);
+    }
+    if (UAT_SHARED_SUB(&uat.sinkWaiters, 1) != 0) {
+        xSemaphoreGive(uat.sinkFreed);
+    }
+}
+
+/**
+ * @brief Take the active transaction off the queue
+ *
+ * Called by uAT_Task when the final line arrives or the timeout runs out,
+ * by the task that failed to send the command, or by uAT_TxnCancel(); the
+ * first one wins. uAT_Task only writes the sink after moving the slot from
+ * active to capturing (see uAT_CaptureResponse()), so once this has moved
+ * it to completing no line is written any more. Another task finishing a
+ * slot that is being captured waits for the line to be written first.
+ *
+ * A transaction uAT_TxnCancel() asked to drop while it was completing is
+ * freed here instead of being kept for collection.
+ *
+ * @param slot Transaction to finish
+ * @param result Outcome to report
+ * @param release Free the slot instead of keeping the result for collection
+ * @return true if this call finished the transaction
+ */
+static bool uAT_TxnFinish(uAT_TxnSlot_t *slot, uAT_Result_t result, bool release)
+{
+    uAT_TxnHandle_t handle = slot->handle;
+    uint8_t state = UAT_TXN_ACTIVE;
+    while (!UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_COMPLETING)) {
+        if (state != UAT_TXN_CAPTURING) {
+            return false;
+        }
+        // Never uAT_Task, which does not finish a slot in the middle of a capture
+        uAT_TxnWaitCapture(slot, handle);
+        if (slot->handle != handle) {
+            return false;
+        }
+        state = UAT_TXN_ACTIVE;
+    }
+
+    slot->result.result = result;
+#ifdef UAT_RESP_POOL
+    if (slot->loan != 0) {
+        // A line either fits in the buffer whole or is dropped
+        slot->result.loan.lines = (const uAT_LineView_t *)uat.respPool[slot->loan - 1];
+        slot->result.loan.count = slot->result.lineCount - slot->result.linesDropped;
+    }
+#endif
+
+    // Off the queue before the slot can be reused; only the front is ever active
+    UAT_SHARED_STORE(&uat.txnTail, (UAT_SHARED_LOAD(&uat.txnTail) + 1) % (UAT_TXN_QUEUE_LEN + 1));
+    if (release) {
+        uAT_TxnFree(slot);
+        return true;
+    }
+
+    // The slot may be reused as soon as it is freed or collected
+    TaskHandle_t notifyTask = slot->notifyTask;
+    uint32_t notifyBits = slot->notifyBits;
+    EventGroupHandle_t eventGroup = slot->eventGroup;
+    EventBits_t eventBits = slot->eventBits;
+
+    if (slot->onComplete != NULL) {
+        // Still completing, so the callback has the result to itself; the
+        // loan, if any, goes with it
+        slot->onComplete(slot->handle, &slot->result, slot->ctx);
+        slot->loan = 0;
+        uAT_TxnFree(slot);
+    } else {
+        // Done before checking for a cancel, see uAT_TxnCancel()
+        UAT_SHARED_STORE(&slot->state, UAT_TXN_DONE);
+        state = UAT_TXN_DONE;
+        if (UAT_SHARED_LOAD(&slot->cancel) != handle) {
+            xSemaphoreGive(slot->done);
+        } else if (UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_COMPLETING)) {
+            uAT_TxnFree(slot);
+        }
+    }
+
+    if (notifyTask != NULL) {
+        xTaskNotify(notifyTask, notifyBits, eSetBits);
+    }
+    if (eventGroup != NULL) {
+        xEventGroupSetBits(eventGroup, eventBits);
+    }
+    return true;
+}
+
+/**
+ * @brief Send the command at the front of the queue if nothing is in progress
+ *
+ * Called by submitters, by uAT_Task right after the final line of the
+ * previous transaction, and after a timeout or cancel, so the next command
+ * goes out without waiting for another task to run. Claiming the front with
+ * UAT_SHARED_CAS() makes sure only one caller sends it; cancelled fronts are
+ * skipped and failed sends finished on the way.
+ */
+static void uAT_TxnKick(void)
+{
+    while (1) {
+        uint32_t pos = UAT_SHARED_LOAD(&uat.txnTail);
+        if (pos == UAT_SHARED_LOAD(&uat.txnHead)) {
+            return;
+        }
+        uint8_t index = uat.txnOrder[pos];
+        uAT_TxnSlot_t *slot = &uat.txns[index];
+        uint8_t state = UAT_SHARED_LOAD(&slot->state);
+
+        if (state != UAT_TXN_QUEUED && state != UAT_TXN_CANCELLED) {
+            // The front is in progress and whoever finishes it kicks again
+            return;
+        }
+        uint8_t claimed = state;
+        if (!UAT_SHARED_CAS(&slot->state, &claimed,
+                            state == UAT_TXN_QUEUED ? UAT_TXN_STARTING : UAT_TXN_COMPLETING)) {
+            continue;
+        }
+        if (UAT_SHARED_LOAD(&uat.txnTail) != pos || uat.txnOrder[pos] != index) {
+            // The slot left the front meanwhile and was queued again behind it
+            UAT_SHARED_STORE(&slot->state, state);
+            continue;
+        }
+
+        if (state == UAT_TXN_CANCELLED) {
+            UAT_SHARED_STORE(&uat.txnTail, (pos + 1) % (UAT_TXN_QUEUE_LEN + 1));
+            uAT_TxnFree(slot);
+            continue;
+        }
+
+        // Active before sending, so a fast reply is captured, and before
+        // checking for a cancel, see uAT_TxnCancel()
+        slot->start = xTaskGetTickCount();
+        UAT_SHARED_STORE(&slot->state, UAT_TXN_ACTIVE);
+        if (UAT_SHARED_LOAD(&slot->cancel) == slot->handle) {
+            uAT_TxnFinish(slot, UAT_ERR_TIMEOUT, true);
+            continue;
+        }
+        if (uAT_SendCommand(slot->cmd) == UAT_OK) {
+            return;
+        }
+        uAT_TxnFinish(slot, UAT_ERR_SEND_FAIL, false);
+    }
+}
+
+/**
+ * @brief Time out the front transaction if its time is up
+ *
+ * Called by uAT_Task between receives.
+ *
+ * @return Ticks until the front transaction times out, or portMAX_DELAY
+ */
+static TickType_t uAT_TxnExpire(void)
+{
+    while (1) {
+        uAT_TxnSlot_t *slot = uAT_TxnFront();
+        if (UAT_SHARED_LOAD(&slot->state) != UAT_TXN_ACTIVE || slot->timeout == portMAX_DELAY) {
+            return portMAX_DELAY;
+        }
+
+        TickType_t elapsed = xTaskGetTickCount() - slot->start;
+        if (elapsed < slot->timeout) {
+            return slot->timeout - elapsed;
+        }
+        if (uAT_TxnFinish(slot, UAT_ERR_TIMEOUT, false)) {
+            uAT_TxnKick();
+        }
+    }
+}
+
+/**
+ * @brief Find the slot of a transaction not collected yet
+ *
+ * @param handle Handle from uAT_TxnSubmit()
+ * @return The slot, or NULL if handle is unknown, collected or cancelled
+ */
+static uAT_TxnSlot_t *uAT_FindTxn(uAT_TxnHandle_t handle)
+{
+    if (handle == 0) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < UAT_TXN_QUEUE_LEN; i++) {
+        uAT_TxnSlot_t *slot = &uat.txns[i];
+        uint8_t state = UAT_SHARED_LOAD(&slot->state);
+        if (slot->handle == handle && state != UAT_TXN_FREE && state != UAT_TXN_CANCELLED) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find a free transaction slot
+ *
+ * @return The first free slot, or NULL if every slot is in use
+ */
+static uAT_TxnSlot_t *uAT_TxnFindFree(void)
+{
+    for (uint32_t i = 0; i < UAT_TXN_QUEUE_LEN; i++) {
+        if (UAT_SHARED_LOAD(&uat.txns[i].state) == UAT_TXN_FREE) {
+            return &uat.txns[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Queue a command, sending it right away if the modem is idle
+ *
+ * Any free slot will do; the queue keeps the submission order in txnOrder.
+ * With every slot in use, waits up to req->timeout for one to be freed,
+ * blocking on txnFreed like uAT_Task on tableFreed. uAT_Task itself never
+ * waits, since it is the task that times transactions out.
+ *
+ * @param req Command, terminators, sink and timeout
+ * @param handle Set to the handle of the queued transaction
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_TxnSubmit(const uAT_TxnRequest_t *req, uAT_TxnHandle_t *handle)
+{
+    // Validate input parameters
+    if (!req || !handle || !req->cmd) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // One sink at most, usable as given
+    if ((req->outBuf != NULL && req->bufLen == 0) || (req->outBuf != NULL && req->arena != NULL)) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Line views go first, so the arena start must suit them
+    if (req->arena != NULL && (uintptr_t)req->arena % _Alignof(uAT_LineView_t) != 0) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+#ifdef UAT_RESP_POOL
+    if (req->loan && (req->outBuf != NULL || req->arena != NULL)) {
+        return UAT_ERR_INVALID_ARG;
+    }
+#else
+    if (req->loan) {
+        return UAT_ERR_INVALID_ARG;
+    }
+#endif
+
+    TickType_t waitStart = xTaskGetTickCount();
+    uAT_TxnSlot_t *slot;
+    while (1) {
+        if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
+            return UAT_ERR_BUSY;
+        }
+        slot = uAT_TxnFindFree();
+        if (slot != NULL) {
+            break;
+        }
+        xSemaphoreGive(uat.handlerMutex);
+
+        TickType_t waited = xTaskGetTickCount() - waitStart;
+        if (xTaskGetCurrentTaskHandle() == uat.rxTask || waited >= req->timeout) {
+            return UAT_ERR_BUSY;
+        }
+        // Counted before looking again, see uAT_TxnFree()
+        UAT_SHARED_ADD(&uat.txnWaiters, 1);
+        if (uAT_TxnFindFree() == NULL) {
+            xSemaphoreTake(uat.txnFreed, req->timeout - waited);
+        }
+        UAT_SHARED_SUB(&uat.txnWaiters, 1);
+    }
+
+    slot->loan = 0;
+#ifdef UAT_RESP_POOL
+    if (req->loan) {
+        for (uint32_t i = 0; i < UAT_RESP_POOL && slot->loan == 0; i++) {
+            if (!UAT_SHARED_LOAD(&uat.respLent[i])) {
+                UAT_SHARED_STORE(&uat.respLent[i], true);
+                slot->loan = (uint8_t)(i + 1);
+            }
+        }
+        if (slot->loan == 0) {
+            xSemaphoreGive(uat.handlerMutex);
+            return UAT_ERR_RESOURCE;
+        }
+    }
+#endif
+
+    if (++uat.txnLast == 0) {
+        uat.txnLast = 1;
+    }
+    slot->handle = uat.txnLast;
+    slot->cancel = 0;
+    slot->cmd = req->cmd;
+    slot->terminators = req->terminators;
+    slot->finals = req->finals;
+    slot->payload = req->payload;
+    slot->payloadLen = req->payload != NULL && req->payloadLen == 0 ? strlen(req->payload) : req->payloadLen;
+    slot->payloadSent = false;
+    slot->echoPrefix = req->echoPrefix;
+    slot->buf = req->outBuf;
+    slot->bufSize = req->bufLen;
+    slot->arenaLow = req->arena;
+    slot->arenaHigh = req->arena != NULL ? (uint8_t *)req->arena + req->arenaLen : NULL;
+#ifdef UAT_RESP_POOL
+    if (slot->loan != 0) {
+        // Written in place as lines arrive, never cleared beforehand
+        slot->arenaLow = (uint8_t *)uat.respPool[slot->loan - 1];
+        slot->arenaHigh = slot->arenaLow + sizeof(uat.respPool[0]);
+    }
+#endif
+    slot->timeout = req->timeout;
+    slot->onComplete = req->onComplete;
+    slot->ctx = req->ctx;
+    slot->notifyTask = req->notifyTask;
+    slot->notifyBits = req->notifyBits;
+    slot->eventGroup = req->eventGroup;
+    slot->eventBits = req->eventBits;
+    memset(&slot->result, 0, sizeof(slot->result));
+    slot->result.terminator = -1;
+    slot->result.finalMatch = -1;
+    slot->result.errorCode = -1;
+    if (slot->buf != NULL) {
+        slot->buf[0] = '\0';
+    }
+
+    // The slot's previous transaction may have been collected without waiting
+    xSemaphoreTake(slot->done, 0);
+
+    // Publish the slot last; the order entry has room, since every entry
+    // from the front on holds a slot in use
+    *handle = slot->handle;
+    UAT_SHARED_STORE(&slot->state, UAT_TXN_QUEUED);
+    uat.txnOrder[uat.txnHead] = (uint8_t)(slot - uat.txns);
+    UAT_SHARED_STORE(&uat.txnHead, (uat.txnHead + 1) % (UAT_TXN_QUEUE_LEN + 1));
+    bool more = UAT_SHARED_LOAD(&uat.txnWaiters) != 0 && uAT_TxnFindFree() != NULL;
+    xSemaphoreGive(uat.handlerMutex);
+
+    if (more) {
+        // Two slots may have been freed for one wakeup, pass it on
+        xSemaphoreGive(uat.txnFreed);
+    }
+
+    uAT_TxnKick();
+
+    // uAT_Task times out the front transaction, let it pick up the deadline
+    if (uat.rxTask != NULL) {
+        xTaskNotify(uat.rxTask, 0, eNoAction);
+    }
+    return UAT_OK;
+}
+
+/**
+ * @brief Queue a command whose result goes to a callback
+ *
+ * @param cmd Command to send
+ * @param terminators Prefixes of lines marking success, ending with NULL, or NULL
+ * @param outBuf Buffer for the response text, or NULL
+ * @param bufLen Size of outBuf
+ * @param timeout Ticks allowed from sending cmd to the final line
+ * @param onComplete Called with the result, or NULL
+ * @param ctx Pointer passed to onComplete unchanged
+ * @param handle Set to the transaction handle, may be NULL with onComplete
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_SendAsync(const char *cmd, const char *const *terminators,
+                           char *outBuf, size_t bufLen, TickType_t timeout,
+                           uAT_TxnCallback onComplete, void *ctx,
+                           uAT_TxnHandle_t *handle)
+{
+    // Without either nobody would ever free the slot
+    if (onComplete == NULL && handle == NULL) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    uAT_TxnRequest_t req = {
+        .cmd = cmd,
+        .terminators = terminators,
+        .outBuf = outBuf,
+        .bufLen = bufLen,
+        .timeout = timeout,
+        .onComplete = onComplete,
+        .ctx = ctx,
+    };
+    uAT_TxnHandle_t unused;
+
+    return uAT_TxnSubmit(&req, handle != NULL ? handle : &unused);
+}
+
+/**
+ * @brief Collect the result of a finished transaction
+ *
+ * The slot is claimed by moving it from done to completing before the
+ * result is copied, so a uAT_TxnCancel() or a second collector racing this
+ * one cannot free it, and a submitter cannot refill it, in the middle of
+ * the copy.
+ *
+ * @param handle Handle from uAT_TxnSubmit()
+ * @param result Set to the outcome, may be NULL
+ * @return UAT_OK if finished, UAT_ERR_BUSY if pending, UAT_ERR_NOT_FOUND if unknown
+ */
+uAT_Result_t uAT_TxnPoll(uAT_TxnHandle_t handle, uAT_TxnResult_t *result)
+{
+    uAT_TxnSlot_t *slot = uAT_FindTxn(handle);
+    if (slot == NULL) {
+        return UAT_ERR_NOT_FOUND;
+    }
+    uint8_t state = UAT_TXN_DONE;
+    if (!UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_COMPLETING)) {
+        // Pending, or collected or cancelled by another task meanwhile
+        return state == UAT_TXN_FREE ? UAT_ERR_NOT_FOUND : UAT_ERR_BUSY;
+    }
+    if (slot->handle != handle) {
+        // Collected and reused since uAT_FindTxn(); give the result back to
+        // its owner, unless its owner cancelled it in the meantime
+        UAT_SHARED_STORE(&slot->state, UAT_TXN_DONE);
+        state = UAT_TXN_DONE;
+        if (UAT_SHARED_LOAD(&slot->cancel) == slot->handle &&
+            UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_COMPLETING)) {
+            uAT_TxnFree(slot);
+        }
+        return UAT_ERR_NOT_FOUND;
+    }
+
+    if (result != NULL) {
+        *result = slot->result;
+#ifdef UAT_RESP_POOL
+        // The loan goes to the caller, to be given back with uAT_ReleaseResponse()
+        slot->loan = 0;
+#endif
+    }
+    uAT_TxnFree(slot);
+    return UAT_OK;
+}
+
+/**
+ * @brief Wait for a transaction to finish and collect its result
+ *
+ * @param handle Handle from uAT_TxnSubmit()
+ * @param result Set to the outcome, may be NULL
+ * @param waitTicks Maximum time to wait
+ * @return UAT_OK if finished, UAT_ERR_TIMEOUT if pending, UAT_ERR_NOT_FOUND if unknown
+ */
+uAT_Result_t uAT_TxnWait(uAT_TxnHandle_t handle, uAT_TxnResult_t *result, TickType_t waitTicks)
+{
+    uAT_TxnSlot_t *slot = uAT_FindTxn(handle);
+    if (slot == NULL) {
+        return UAT_ERR_NOT_FOUND;
+    }
+    if (UAT_SHARED_LOAD(&slot->state) != UAT_TXN_DONE) {
+        xSemaphoreTake(slot->done, waitTicks);
+    }
+
+    uAT_Result_t status = uAT_TxnPoll(handle, result);
+    return status == UAT_ERR_BUSY ? UAT_ERR_TIMEOUT : status;
+}
+
+/**
+ * @brief Drop a transaction, queued or in progress, and free its slot
+ *
+ * The request is recorded in the slot's cancel field first, which
+ * uAT_CaptureResponse() checks before writing a line, and a line being
+ * written is waited for, so no line is written to the sink once this
+ * returns. Otherwise this never waits for another task to move the slot on.
+ * A slot being sent or finished by another task is freed by that task:
+ * uAT_TxnKick() and uAT_TxnFinish() store the next state before checking
+ * the field, and this checks the state after setting it, so one of the two
+ * always sees the other.
+ *
+ * @param handle Handle from uAT_TxnSubmit()
+ * @return UAT_OK on success, UAT_ERR_NOT_FOUND if unknown
+ */
+uAT_Result_t uAT_TxnCancel(uAT_TxnHandle_t handle)
+{
+    uAT_TxnSlot_t *slot = uAT_FindTxn(handle);
+    if (slot == NULL) {
+        return UAT_ERR_NOT_FOUND;
+    }
+
+    UAT_SHARED_STORE(&slot->cancel, handle);
+
+    while (1) {
+        uint8_t state = UAT_TXN_QUEUED;
+        if (slot->handle != handle) {
+            // Finished by a callback meanwhile, and the slot reused
+            return UAT_ERR_NOT_FOUND;
+        }
+        if (UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_CANCELLED)) {
+            // Freed when its turn comes, which may be now
+            uAT_TxnKick();
+            return UAT_OK;
+        }
+
+        switch (state) {
+        case UAT_TXN_ACTIVE:
+        case UAT_TXN_CAPTURING:
+            // Waits for a line being captured
+            if (uAT_TxnFinish(slot, UAT_ERR_TIMEOUT, true)) {
+                uAT_TxnKick();
+                return UAT_OK;
+            }
+            break;
+        case UAT_TXN_DONE:
+            if (UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_COMPLETING)) {
+                uAT_TxnFree(slot);
+                return UAT_OK;
+            }
+            break;
+        case UAT_TXN_STARTING:
+        case UAT_TXN_COMPLETING:
+            // Being sent or finished by another task, which frees it
+            return UAT_OK;
+        default:
+            return UAT_ERR_NOT_FOUND;
+        }
+    }
+}
+
+/**
+ * @brief Queue a command and wait for it to finish
+ *
+ * Gives up and cancels the transaction once timeoutTicks have passed, so
+ * the caller's sink is released when this returns.
+ *
+ * @param req Command, terminators, sink and timeout
+ * @param result Set to the outcome when UAT_OK is returned
+ * @return UAT_OK if finished, error code otherwise
+ */
+static uAT_Result_t uAT_Transact(const uAT_TxnRequest_t *req, uAT_TxnResult_t *result)
+{
+    uAT_TxnHandle_t handle;
+    TickType_t start = xTaskGetTickCount();
+    uAT_Result_t status = uAT_TxnSubmit(req, &handle);
+    if (status != UAT_OK) {
+        return status;
+    }
+
+    // Part of the time may have gone on waiting for a slot
+    TickType_t waitTicks = req->timeout;
+    if (waitTicks != portMAX_DELAY) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        waitTicks = waited < waitTicks ? waitTicks - waited : 0;
+    }
+    status = uAT_TxnWait(handle, result, waitTicks);
+    if (status == UAT_ERR_TIMEOUT) {
+        uAT_TxnCancel(handle);
+    }
+    return status;
+}
+
+/**
+ * @brief Sends an AT command and waits for a specific response
+ * 
+ * @param cmd Command to send
+ * @param expected Expected response prefix till end of line
+ * @param outBuf Buffer for the solicited response lines up to the final one
+ * @param bufLen Size of outBuf
+ * @param timeoutTicks Maximum time to wait for response
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_SendReceive(const char *cmd, const char *expected, char *outBuf, size_t bufLen, TickType_t timeoutTicks)
+{
+    // Validate input parameters
+    if (!cmd || !expected || !outBuf || bufLen == 0) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Validate expected response isn't too long
+    if (strlen(expected) >= UAT_RX_BUFFER_SIZE) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Stays valid until uAT_Transact() returns; ends the response too unless
+    // it is an information response, which a final result code follows
+    const char *const terminators[] = { expected, NULL };
+    uAT_TxnRequest_t req = {
+        .cmd = cmd,
+        .terminators = terminators,
+        .finals = expected[0] != '+' ? terminators : NULL,
+        .outBuf = outBuf,
+        .bufLen = bufLen,
+        .timeout = timeoutTicks,
+    };
+    uAT_TxnResult_t result;
+
+    uAT_Result_t status = uAT_Transact(&req, &result);
+    if (status != UAT_OK) {
+        return status;
+    }
+    if (result.result == UAT_OK && result.terminator < 0) {
+        return UAT_ERR_RESPONSE;
+    }
+    return result.result;
+}
+
+/**
+ * @brief Sends an AT command and hands every response line to handler at once
+ * 
+ * The lines are stored in the caller's arena as they arrive, so a long
+ * response is neither dispatched line by line to its caller nor scanned
+ * again afterwards.
+ * 
+ * @param cmd Command to send
+ * @param expected Prefix of a line the response must contain, e.g. "OK"
+ * @param arena Storage for the lines
+ * @param arenaLen Size of arena
+ * @param handler Called with the lines once the response ended
+ * @param ctx Pointer passed to handler unchanged
+ * @param timeoutTicks Maximum time to wait for response
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_SendReceiveLines(const char *cmd, const char *expected,
+                                  void *arena, size_t arenaLen,
+                                  uAT_LinesHandler handler, void *ctx,
+                                  TickType_t timeoutTicks)
+{
+    // Validate input parameters
+    if (!cmd || !expected || !arena || !handler) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Validate expected response isn't too long
+    if (strlen(expected) >= UAT_RX_BUFFER_SIZE) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Ends the response too unless it is an information response, see uAT_SendReceive()
+    const char *const terminators[] = { expected, NULL };
+    uAT_TxnRequest_t req = {
+        .cmd = cmd,
+        .terminators = terminators,
+        .finals = expected[0] != '+' ? terminators : NULL,
+        .arena = arena,
+        .arenaLen = arenaLen,
+        .timeout = timeoutTicks,
+    };
+    uAT_TxnResult_t result;
+
+    uAT_Result_t status = uAT_Transact(&req, &result);
+    if (status != UAT_OK) {
+        return status;
+    }
+    if (result.result != UAT_OK) {
+        return result.result;
+    }
+
+    // A line either fits in the arena whole or is dropped
+    handler((const uAT_LineView_t *)arena, result.lineCount - result.linesDropped, ctx);
+    if (result.terminator < 0) {
+        return UAT_ERR_RESPONSE;
+    }
+    return result.linesDropped > 0 ? UAT_ERR_RESOURCE : UAT_OK;
+}
+
+#ifdef UAT_RESP_POOL
+/**
+ * @brief Sends an AT command and lends its response lines from the pool
+ *
+ * @param cmd Command to send
+ * @param expected Prefix of a line the response must contain, or NULL for any
+ * @param loan Set to the lent lines, or cleared if none are lent
+ * @param timeoutTicks Maximum time to wait for response
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_SendReceiveLoan(const char *cmd, const char *expected,
+                                 uAT_ResponseLoan_t *loan, TickType_t timeoutTicks)
+{
+    // Validate input parameters
+    if (!cmd || !loan) {
+        return UAT_ERR_INVALID_ARG;
+    }
+    loan->lines = NULL;
+    loan->count = 0;
+
+    // Validate expected response isn't too long
+    if (expected != NULL && strlen(expected) >= UAT_RX_BUFFER_SIZE) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Ends the response too unless it is an information response, see uAT_SendReceive()
+    const char *const terminators[] = { expected, NULL };
+    uAT_TxnRequest_t req = {
+        .cmd = cmd,
+        .terminators = expected != NULL ? terminators : NULL,
+        .finals = expected != NULL && expected[0] != '+' ? terminators : NULL,
+        .loan = true,
+        .timeout = timeoutTicks,
+    };
+    uAT_TxnResult_t result;
+
+    uAT_Result_t status = uAT_Transact(&req, &result);
+    if (status != UAT_OK) {
+        return status;
+    }
+    if (result.result != UAT_OK) {
+        // Timed out or never sent, a partial response is of no use
+        uAT_ReleaseResponse(&result.loan);
+        return result.result;
+    }
+
+    *loan = result.loan;
+    if (expected != NULL && result.terminator < 0) {
+        return UAT_ERR_RESPONSE;
+    }
+    return result.linesDropped > 0 ? UAT_ERR_RESOURCE : UAT_OK;
+}
+
+/**
+ * @brief Give a lent response buffer back to the pool
+ *
+ * @param loan Lines lent with a transaction result
+ * @return UAT_OK on success, error code otherwise
+ */
+uAT_Result_t uAT_ReleaseResponse(uAT_ResponseLoan_t *loan)
+{
+    if (!loan) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    for (uint32_t i = 0; i < UAT_RESP_POOL; i++) {
+        if (loan->lines == (const uAT_LineView_t *)uat.respPool[i] && UAT_SHARED_LOAD(&uat.respLent[i])) {
+            UAT_SHARED_STORE(&uat.respLent[i], false);
+            loan->lines = NULL;
+            loan->count = 0;
+            return UAT_OK;
+        }
+    }
+    return UAT_ERR_INVALID_ARG;
+}
+#endif
+
+uAT_Result_t uAT_SendCommand(const char *cmd)
+{
+    if (!cmd)
+        return UAT_ERR_INVALID_ARG; // invalid command argument
+
+    if (xSemaphoreTake(uat.txMutex, pdMS_TO_TICKS(500)) != pdTRUE)
+        return UAT_ERR_BUSY;      // failed to take mutex, check if uart is busy
+
+    int len = snprintf((char *)uat.txBuffer,
+                       UAT_TX_BUFFER_SIZE, "%s\r\n", cmd);
+
+    if (len <= 0 || len >= UAT_TX_BUFFER_SIZE) 
+    {
+        xSemaphoreGive(uat.txMutex);
+        return UAT_ERR_INVALID_ARG; // buffer isn't valid length
+    }
+
+    // choose DMA or IT transmit automatically by HAL
+    if (HAL_UART_Transmit_DMA(uat.huart, uat.txBuffer, len) != HAL_OK)
+    {
+        xSemaphoreGive(uat.txMutex);
+        return UAT_ERR_SEND_FAIL;  // failed to transmit
     }
     
-    // Initialize state variables
-    uat.inSendReceive = false;
-    uat.srBuffer = NULL;
-    uat.srBufferSize = 0;
-    uat.srBufferPos = 0;
-    uat.cmdCount = 0;
+    // wait for completion with timeout
+    BaseType_t result = xSemaphoreTake(uat.txComplete, pdMS_TO_TICKS(1000));
+    xSemaphoreGive(uat.txMutex);
 
-#ifdef UAT_USE_DMA
-    // Reset DMA position tracking
-    dma_last_pos = 0;
-    
-    // Start circular DMA reception
-    __HAL_RCC_DMA1_CLK_ENABLE();
-    if (HAL_UART_Receive_DMA(huart, uart_dma_rx_buf, UAT_DMA_RX_SIZE) != HAL_OK) {
-        // Clean up all resources on failure
-        vStreamBufferDelete(uat.rxStream);
-        vSemaphoreDelete(uat.txComplete);
-        vSemaphoreDelete(uat.txMutex);
-        vSemaphoreDelete(uat.handlerMutex);
-        vSemaphoreDelete(uat.sendReceiveSem);
-        return UAT_ERR_INIT_FAIL;
+    return (result == pdTRUE) ? UAT_OK : UAT_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Send raw data as is, such as the payload after a "> " prompt
+ *
+ * Sent in pieces of up to UAT_TX_BUFFER_SIZE bytes through the transmit
+ * buffer, holding txMutex throughout so no command gets in between.
+ *
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return UAT_OK on success, error code otherwise
+ */
+static uAT_Result_t uAT_SendData(const char *data, size_t len)
+{
+    if (xSemaphoreTake(uat.txMutex, pdMS_TO_TICKS(UAT_MUTEX_TIMEOUT_MS)) != pdTRUE) {
+        return UAT_ERR_BUSY;
     }
 
-    // Enable IDLE interrupt
-    __HAL_UART_CLEAR_IDLEFLAG(huart);
-    __HAL_UART_ENABLE_IT(uat.huart, UART_IT_IDLE);
-#else
-    // Start byte-by-byte IRQ reception
-    static uint8_t rxByte;
-    if (HAL_UART_Receive_IT(huart, &rxByte, 1) != HAL_OK) {
-        // Clean up all resources on failure
-        vStreamBufferDelete(uat.rxStream);
-        vSemaphoreDelete(uat.txComplete);
-        vSemaphoreDelete(uat.txMutex);
-        vSemaphoreDelete(uat.handlerMutex);
-        vSemaphoreDelete(uat.sendReceiveSem);
-        return UAT_ERR_INIT_FAIL;
+    uAT_Result_t status = UAT_OK;
+    while (len > 0 && status == UAT_OK) {
+        size_t chunk = len < UAT_TX_BUFFER_SIZE ? len : UAT_TX_BUFFER_SIZE;
+        memcpy(uat.txBuffer, data, chunk);
+        if (HAL_UART_Transmit_DMA(uat.huart, uat.txBuffer, (uint16_t)chunk) != HAL_OK) {
+            status = UAT_ERR_SEND_FAIL;
+        } else if (xSemaphoreTake(uat.txComplete, pdMS_TO_TICKS(UAT_TX_TIMEOUT_MS)) != pdTRUE) {
+            status = UAT_ERR_TIMEOUT;
+        }
+        data += chunk;
+        len -= chunk;
     }
-#endif
+    xSemaphoreGive(uat.txMutex);
+    return status;
+}
 
-    return UAT_OK;
+#ifdef UAT_ENABLE_PROFILING
+/**
+ * @brief Add one handler call to the statistics of its slot
+ *
+ * Only the task running the handler writes the slot: lines of one entry
+ * are all run by uAT_Task, uAT_URCTask or the same worker.
+ *
+ * @param call Handler that was called
+ * @param elapsed Execution time in UAT_PROFILE_NOW() units
+ */
+static void uAT_ProfileCall(const uAT_Call_t *call, uint32_t elapsed)
+{
+    uAT_ProfileEntry_t *p = &uat.profile[call->profSlot];
+
+    if (p->command != call->command) {
+        // Slot reused by another command, start over
+        p->hits = 0;
+        p->totalTime = 0;
+        p->maxTime = 0;
+        p->command = call->command;
+    }
+    p->hits++;
+    p->totalTime += elapsed;
+    p->lastTime = elapsed;
+    if (elapsed > p->maxTime) {
+        p->maxTime = elapsed;
+    }
 }
 
 /**
- * @brief  Register a command string and its handler
- * @param  cmd     Null-terminated string to match at start of line
- * @param  handler Function called when a line beginning with cmd arrives
- * @return UAT_OK if registered, or appropriate error code on failure
+ * @brief Count a line no handler matched and keep its start
+ *
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of the line
  */
-uAT_Result_t uAT_RegisterCommand(const char *cmd, uAT_CommandHandler handler)
+static void uAT_ProfileUnmatched(const char *line, size_t len)
 {
-    // Validate input parameters
-    if (!cmd || !handler) {
-        return UAT_ERR_INVALID_ARG;
+    uint32_t lines = uat.unmatchedLines;
+    char *prefix = uat.unmatched[lines % UAT_PROFILE_UNMATCHED];
+    size_t n = 0;
+
+    // Readers report busy while the sequence is odd, see uAT_GetUnmatchedStats()
+    UAT_SHARED_STORE(&uat.unmatchedSeq, uat.unmatchedSeq + 1);
+    while (n < len && n < UAT_PROFILE_PREFIX_LEN && line[n] != '\r' && line[n] != '\n') {
+        prefix[n] = line[n];
+        n++;
     }
-    
-    // Check command length
-    size_t cmdLen = strlen(cmd);
-    if (cmdLen == 0 || cmdLen >= UAT_RX_BUFFER_SIZE) {
-        return UAT_ERR_INVALID_ARG;
+    prefix[n] = '\0';
+    UAT_SHARED_STORE(&uat.unmatchedLines, lines + 1);
+    UAT_SHARED_STORE(&uat.unmatchedSeq, uat.unmatchedSeq + 1);
+}
+#endif
+
+/**
+ * @brief Run a handler, timing it when profiling is enabled
+ *
+ * @param call Handler to run
+ * @param args Arguments, null-terminated for a plain handler
+ * @param len Length of args
+ * @param tick Tick when the line was picked up
+ */
+static void uAT_Invoke(const uAT_Call_t *call, const char *args, size_t len, TickType_t tick)
+{
+#ifdef UAT_ENABLE_PROFILING
+    uint32_t start = UAT_PROFILE_NOW();
+#endif
+    if (call->handlerEx != NULL) {
+        // Extended handlers get a bounded view of the line, without terminator
+        call->handlerEx(args, uAT_ViewLength(args, len), call->ctx, tick);
+    } else {
+        call->handler(args);
     }
+#ifdef UAT_ENABLE_PROFILING
+    uAT_ProfileCall(call, UAT_PROFILE_NOW() - start);
+#endif
+}
 
-    // Try to acquire mutex with timeout
-    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
-        return UAT_ERR_BUSY;
+#ifdef UAT_WORK_QUEUES
+/**
+ * @brief Copy the arguments of a line into a free pool buffer
+ *
+ * When every buffer is in use uAT_Task waits for a handler task to give one
+ * back rather than dropping the line, blocking on workFreed as in
+ * uAT_QueueWork().
+ *
+ * @param args Arguments of the received line
+ * @param len Length of args
+ * @param refs Number of calls the line will be queued to
+ * @return Buffer holding the arguments, null-terminated
+ */
+static uAT_SharedLine_t *uAT_TakeLine(const char *args, size_t len, uint32_t refs)
+{
+    bool waiting = false;
+    while (1) {
+        for (uint32_t i = 0; i < UAT_LINE_POOL_SIZE; i++) {
+            uint32_t index = (uat.linePoolNext + i) % UAT_LINE_POOL_SIZE;
+            uAT_SharedLine_t *line = &uat.linePool[index];
+            if (UAT_SHARED_LOAD(&line->refs) == 0) {
+                memcpy(line->args, args, len);
+                line->args[len] = '\0';
+                line->len = len;
+                line->refs = refs; // Published to the handler tasks with the queue heads
+                uat.linePoolNext = index + 1;
+                if (waiting) {
+                    UAT_SHARED_STORE(&uat.workWaiting, false);
+                }
+                return line;
+            }
+        }
+
+        // Raised before looking again, so a buffer given back meanwhile is seen
+        if (waiting) {
+            xSemaphoreTake(uat.workFreed, portMAX_DELAY);
+        } else {
+            UAT_SHARED_STORE(&uat.workWaiting, true);
+            waiting = true;
+        }
     }
+}
 
-    // Check if command already exists
-    for (size_t i = 0; i < uat.cmdCount; i++) {
-        if (strcmp(uat.cmdHandlers[i].command, cmd) == 0) {
-            // Update existing handler
-            uat.cmdHandlers[i].handler = handler;
-            xSemaphoreGive(uat.handlerMutex);
-            return UAT_OK;
+/**
+ * @brief Hand a matched line to the task running its handler
+ *
+ * When all items are in use uAT_Task waits for the handler task rather than
+ * dropping the line or running its handler here, where it could run
+ * concurrently with the handler task. It blocks on workFreed, given by
+ * uAT_RunWorkQueue() when it sees workWaiting; uAT_Task raises the flag
+ * before checking the queue again and the handler task gives the item back
+ * before checking the flag, so the wakeup is not missed.
+ *
+ * @param q Queue of the handler task
+ * @param call Handler to run
+ * @param line Arguments of the received line, holding a reference for this call
+ */
+static void uAT_QueueWork(uAT_WorkQueue_t *q, const uAT_Call_t *call, uAT_SharedLine_t *line)
+{
+    uint32_t head = q->head;
+    if (head - UAT_SHARED_LOAD(&q->tail) >= q->size) {
+        q->stalls++;
+        UAT_SHARED_STORE(&uat.workWaiting, true);
+        while (head - UAT_SHARED_LOAD(&q->tail) >= q->size) {
+            xSemaphoreTake(uat.workFreed, portMAX_DELAY);
         }
+        UAT_SHARED_STORE(&uat.workWaiting, false);
     }
-    
-    // Add new command handler if space available
-    uAT_Result_t result = UAT_ERR_RESOURCE;
-    if (uat.cmdCount < UAT_MAX_CMD_HANDLERS) {
-        // Store command string and handler
-        uat.cmdHandlers[uat.cmdCount].command = cmd;
-        uat.cmdHandlers[uat.cmdCount].handler = handler;
-        uat.cmdCount++;
-        result = UAT_OK;
+
+    uAT_WorkItem_t *item = &q->items[head % q->size];
+    item->call = *call;
+    item->tick = uat.rxTick;
+    item->line = line;
+
+    // Publish the item, then wake the handler task
+    UAT_SHARED_STORE(&q->head, head + 1);
+    uint32_t queued = head + 1 - UAT_SHARED_LOAD(&q->tail);
+    if (queued > q->highWater) {
+        q->highWater = queued;
+    }
+    TaskHandle_t task = UAT_SHARED_LOAD(&q->task);
+    if (task != NULL) {
+        xTaskNotify(task, 0, eIncrement);
     }
-    
-    xSemaphoreGive(uat.handlerMutex);
-    return result;
 }
 
 /**
- * @brief  Unregister a previously registered command
- * @note   This function should be called with `uat.handlerMutex` already taken
- * @param  cmd Null-terminated string of the command to unregister
- * @return UAT_OK if unregistered, or appropriate error code on failure
+ * @brief Run the handlers of queued lines, forever (handler task)
+ *
+ * @param q Queue this task consumes
  */
-uAT_Result_t uAT_UnregisterCommand(const char *cmd)
+static void uAT_RunWorkQueue(uAT_WorkQueue_t *q)
 {
-    // Validate input parameters
-    if (!cmd) {
-        return UAT_ERR_INVALID_ARG;
-    }
-    
-    // Search for the command in the handler array
-    for (size_t i = 0; i < uat.cmdCount; i++) {
-        if (strcmp(uat.cmdHandlers[i].command, cmd) == 0) {
-            // Found the command, now remove it by shifting all subsequent entries
-            for (size_t j = i; j < uat.cmdCount - 1; j++) {
-                uat.cmdHandlers[j] = uat.cmdHandlers[j + 1];
+    UAT_SHARED_STORE(&q->task, xTaskGetCurrentTaskHandle());
+
+    while (1) {
+        uint32_t tail = q->tail;
+        while (tail != UAT_SHARED_LOAD(&q->head)) {
+            uAT_WorkItem_t *item = &q->items[tail % q->size];
+            uAT_Invoke(&item->call, item->line->args, item->line->len, item->tick);
+            // Give the line and the item back only after the handler is done
+            // with them; the last handler of the line frees its buffer
+            UAT_SHARED_SUB(&item->line->refs, 1);
+            UAT_SHARED_STORE(&q->tail, ++tail);
+            if (UAT_SHARED_LOAD(&uat.workWaiting)) {
+                xSemaphoreGive(uat.workFreed);
             }
-            
-            // Clear the last entry and decrement count
-            uat.cmdHandlers[uat.cmdCount - 1].command = NULL;
-            uat.cmdHandlers[uat.cmdCount - 1].handler = NULL;
-            uat.cmdCount--;
-            
-            return UAT_OK;
         }
+
+        uint32_t queued;
+        xTaskNotifyWait(0, 0, &queued, portMAX_DELAY);
     }
-    
-    // Command not found
-    return UAT_ERR_NOT_FOUND;
 }
+#endif
 
+#ifdef UAT_WORKER_TASKS
 /**
- * @brief Helper function to safely append data to the SendReceive buffer
- * 
- * @param data Data to append to the buffer
- * @param len Length of the data
- * @return true if data was appended successfully, false otherwise
+ * @brief Pick the worker for a command
+ *
+ * Lines for one command always go to the same worker, whichever handler is
+ * registered for it at the time, so they are handled in the order they
+ * were received even across a re-registration.
+ *
+ * @param command Registered command or pattern
+ * @param length Length of command
+ * @return Index of the worker
+ */
+static uint32_t uAT_WorkerIndex(const char *command, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)command[i]) * 16777619u;
+    }
+    return hash % UAT_WORKER_TASKS;
+}
+#endif
+
+#ifdef UAT_WORK_QUEUES
+/**
+ * @brief Pick the task that runs a handler
+ *
+ * @param call Handler to run
+ * @return Queue of the handler task, or NULL to run it in uAT_Task
+ */
+static uAT_WorkQueue_t *uAT_CallQueue(const uAT_Call_t *call)
+{
+#ifdef UAT_URC_TASK
+    if (call->urc) {
+        return &uat.urcQueue;
+    }
+#endif
+#ifdef UAT_WORKER_TASKS
+    return &uat.workerQueues[call->worker];
+#else
+    (void)call;
+    return NULL;
+#endif
+}
+#endif
+
+/**
+ * @brief Copy the handler of an entry out of the snapshot
+ *
+ * @param call Call to fill
+ * @param entry Matched entry
+ * @param slot Statistics slot of the entry
+ */
+static inline void uAT_SetCall(uAT_Call_t *call, const uAT_CommandEntry *entry, size_t slot)
+{
+    call->handler = entry->handler;
+    call->handlerEx = entry->handlerEx;
+    call->ctx = entry->ctx;
+#ifdef UAT_URC_TASK
+    call->urc = entry->urc;
+#endif
+#ifdef UAT_WORKER_TASKS
+    call->worker = uAT_WorkerIndex(entry->command, entry->length);
+#endif
+#ifdef UAT_ENABLE_PROFILING
+    call->command = entry->command;
+    call->profSlot = (uint16_t)slot;
+#else
+    (void)slot;
+#endif
+}
+
+/**
+ * @brief Helper function that dispatches an incoming AT command
+ *  to the appropriate registered handlers.
+ *
+ * Looks the line up in the command prefix trie, so the cost does not grow with
+ * the number of registered handlers. When a match is found, every handler of
+ * the command is called with the command arguments.
+ *
+ * @param line Received command line to dispatch (need not be null-terminated)
+ * @param len Length of the received command line
+ * @return bool True if a matching handler was found and executed, false otherwise
  */
-static bool uAT_AppendToResponseBuffer(const char *data, size_t len)
+static bool uAT_DispatchCommand(const char *line, size_t len)
 {
-    // Validate parameters
-    if (data == NULL || len == 0) {
+    // Validate input parameters
+    if (!line || len == 0 || len >= UAT_RX_BUFFER_SIZE) {
         return false;
     }
     
-    // Check if we're in a SendReceive operation and have a valid buffer
-    if (!uat.inSendReceive || !uat.srBuffer || uat.srBufferPos >= uat.srBufferSize - 1) {
+    // No lock: writers never modify the snapshot held here
+    const uAT_HandlerTable_t *t = uAT_AcquireTable();
+
+    // One pass over the line finds every registered prefix and pattern of it
+    uint16_t found[UAT_MAX_NESTED_MATCHES];
+    size_t ends[UAT_MAX_NESTED_MATCHES];
+    size_t count = uAT_Match_FindEx(&t->cmdMatcher, line, len, found, ends, UAT_MAX_NESTED_MATCHES);
+
+    // Handlers to call after releasing the snapshot, so a handler itself
+    // may register or unregister commands
+    uAT_Call_t calls[UAT_MAX_SUBSCRIBERS];
+    size_t callCount = 0;
+    size_t matched = 0;
+    size_t longest = 0;
+
+    if (count > 0) {
+        // Overlapping prefixes: the earliest registered wins, URCs before commands
+        size_t best = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (t->cmdHandlers[found[i]].order < t->cmdHandlers[found[best]].order) {
+                best = i;
+            }
+            if (ends[i] > longest) {
+                longest = ends[i];
+            }
+        }
+        matched = ends[best];
+
+        // Every handler of the command, registered and subscribed, in order
+        for (uint16_t slot = found[best]; slot != UAT_MATCH_NONE && callCount < UAT_MAX_SUBSCRIBERS;
+             slot = t->cmdHandlers[slot].next) {
+            uAT_SetCall(&calls[callCount++], &t->cmdHandlers[slot], slot);
+        }
+    }
+#ifdef UAT_STATIC_HANDLERS
+    // The longest prefix wins across both tables, so a short runtime
+    // catch-all does not hide longer listed commands; runtime registrations
+    // as long override the listed one
+    const uAT_CommandEntry *entry = uAT_FindStatic(line, len);
+    if (entry != NULL && (count == 0 || entry->length > longest)) {
+        callCount = 0;
+        matched = entry->length;
+        uAT_SetCall(&calls[callCount++], entry, UAT_MAX_CMD_HANDLERS + (size_t)(entry - uAT_StaticHandlers));
+    }
+#endif
+    uAT_ReleaseTable();
+
+    if (callCount == 0) {
+#ifdef UAT_ENABLE_PROFILING
+        uAT_ProfileUnmatched(line, len);
+#endif
         return false;
     }
+
+    // Get arguments (safely); a pattern's match length depends on the line
+    const char *args = line + matched;
+    size_t argsLen = len - matched;
     
-    // Calculate how much space is left in the buffer
-    size_t spaceLeft = uat.srBufferSize - uat.srBufferPos - 1; // -1 for null terminator
-    
-    // Limit copy to available space
-    if (len > spaceLeft) {
-        len = spaceLeft;
+    // Skip leading spaces
+    while (argsLen > 0 && *args == ' ') {
+        args++;
+        argsLen--;
     }
-    
-    // Copy data to buffer
-    if (len > 0) {
-        memcpy(uat.srBuffer + uat.srBufferPos, data, len);
-        uat.srBufferPos += len;
-        uat.srBuffer[uat.srBufferPos] = '\0'; // Ensure null termination
-        return true;
+
+#ifdef UAT_WORK_QUEUES
+    // Handlers run by other tasks share one copy of the arguments
+    uAT_WorkQueue_t *queues[UAT_MAX_SUBSCRIBERS];
+    uint32_t refs = 0;
+    for (size_t i = 0; i < callCount; i++) {
+        queues[i] = uAT_CallQueue(&calls[i]);
+        refs += queues[i] != NULL ? 1u : 0u;
     }
-    
-    return false;
-}
+    uAT_SharedLine_t *shared = refs > 0 ? uAT_TakeLine(args, argsLen, refs) : NULL;
+#endif
 
-/**
- * @brief Command handler for SendReceive operations
- * 
- * This function is called when the expected response is received during
- * a SendReceive operation. It signals the waiting task that the response
- * has been received.
- * 
- * @param args Arguments passed to the handler (unused)
- */
-static void uAT_CommandHandler_SendReceive(const char *args)
-{
-    (void)args; // Unused parameter
-    
-    // Signal that we've received the expected response
-    xSemaphoreGive(uat.sendReceiveSem);
+    // Plain handlers expect a null-terminated string, so only the
+    // arguments of a matched line are copied, once
+    char safe_args[UAT_RX_BUFFER_SIZE];
+    const char *terminated = NULL;
+
+    for (size_t i = 0; i < callCount; i++) {
+#ifdef UAT_WORK_QUEUES
+        if (queues[i] != NULL) {
+            uAT_QueueWork(queues[i], &calls[i], shared);
+            continue;
+        }
+#endif
+        if (calls[i].handlerEx != NULL) {
+            uAT_Invoke(&calls[i], args, argsLen, uat.rxTick);
+            continue;
+        }
+        if (terminated == NULL) {
+            memcpy(safe_args, args, argsLen);
+            safe_args[argsLen] = '\0';
+            terminated = safe_args;
+        }
+        uAT_Invoke(&calls[i], terminated, argsLen, uat.rxTick);
+    }
+    return true;
 }
 
 /**
- * @brief Helper function to safely clean up SendReceive state
- * 
- * @param expected Expected response string that was registered
+ * @brief Check whether a line goes to a handler registered with uAT_RegisterURC()
+ *
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @return true if the handler chosen for the line is a URC
  */
-static void uAT_CleanupSendReceiveState(const char *expected)
+static bool uAT_IsURC(const char *line, size_t len)
 {
-    // This function should be called with handlerMutex already taken
-    if (expected != NULL) {
-        uAT_UnregisterCommand(expected);
+    const uAT_HandlerTable_t *t = uAT_AcquireTable();
+    uint16_t found[UAT_MAX_NESTED_MATCHES];
+    size_t ends[UAT_MAX_NESTED_MATCHES];
+    size_t count = uAT_Match_FindEx(&t->cmdMatcher, line, len, found, ends, UAT_MAX_NESTED_MATCHES);
+
+    // Same choice as uAT_DispatchCommand()
+    size_t best = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (t->cmdHandlers[found[i]].order < t->cmdHandlers[found[best]].order) {
+            best = i;
+        }
     }
-    
-    // Reset SendReceive state
-    uat.inSendReceive = false;
-    uat.srBuffer = NULL;
-    uat.srBufferSize = 0;
-    uat.srBufferPos = 0;
+    bool urc = count > 0 && t->cmdHandlers[found[best]].urc;
+    uAT_ReleaseTable();
+    return urc;
 }
 
 /**
- * @brief Helper function to take mutex and clean up SendReceive state
- * 
- * @param expected Expected response string that was registered
- * @param timeoutTicks Maximum time to wait for mutex acquisition
- * @return true if cleanup was successful, false otherwise
+ * @brief Check whether an intermediate line belongs to a transaction
+ *
+ * A line echoing the command's name, "+CREG:" for "AT+CREG?" or
+ * "AT+CREG=2", answers the command even when the same prefix is
+ * registered as a URC.
+ *
+ * @param slot Active transaction
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @return true if the line is part of the response
  */
-static bool uAT_SafeCleanupSendReceiveState(const char *expected, TickType_t timeoutTicks)
+static bool uAT_Solicited(const uAT_TxnSlot_t *slot, const char *line, size_t len)
 {
-    // Try to acquire mutex with timeout
-    if (xSemaphoreTake(uat.handlerMutex, timeoutTicks) == pdTRUE) {
-        uAT_CleanupSendReceiveState(expected);
-        xSemaphoreGive(uat.handlerMutex);
+    if (slot->echoPrefix != NULL) {
+        size_t prefixLen = strlen(slot->echoPrefix);
+        return len >= prefixLen && memcmp(line, slot->echoPrefix, prefixLen) == 0;
+    }
+    if (!uAT_IsURC(line, len)) {
         return true;
     }
-    return false;
+
+    // Extended command name, from the '+' up to its '=' or '?'
+    const char *name = slot->cmd;
+    if ((name[0] == 'A' || name[0] == 'a') && (name[1] == 'T' || name[1] == 't')) {
+        name += 2;
+    }
+    size_t nameLen = strcspn(name, "=?");
+    return name[0] == '+' && len > nameLen && memcmp(line, name, nameLen) == 0 && line[nameLen] == ':';
 }
 
 /**
- * @brief Helper function to set up SendReceive state
- * 
- * @param expected Expected response string to register
- * @param outBuf Buffer to store the response
- * @param bufLen Size of the buffer
- * @return UAT_OK if setup was successful, error code otherwise
+ * @brief Find the first of a list of prefixes a line starts with
+ *
+ * @param prefixes Prefixes, NULL-terminated, or NULL
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of the received line
+ * @return Index of the matching prefix, or -1 if none
  */
-static uAT_Result_t uAT_SetupSendReceiveState(const char *expected, char *outBuf, size_t bufLen)
+static int32_t uAT_MatchPrefix(const char *const *prefixes, const char *line, size_t len)
 {
-    // This function should be called with handlerMutex already taken
-    
-    // Validate parameters
-    if (expected == NULL || outBuf == NULL || bufLen == 0) {
-        return UAT_ERR_INVALID_ARG;
-    }
-    
-    // Set up the SendReceive state
-    uat.inSendReceive = true;
-    uat.srBuffer = outBuf;
-    uat.srBufferSize = bufLen;
-    uat.srBufferPos = 0;
-    
-    // Clear the output buffer
-    memset(outBuf, 0, bufLen);
-    
-    // Register the command handler for the expected response
-    if (uat.cmdCount < UAT_MAX_CMD_HANDLERS) {
-        uat.cmdHandlers[uat.cmdCount].command = expected;
-        uat.cmdHandlers[uat.cmdCount].handler = uAT_CommandHandler_SendReceive;
-        uat.cmdCount++;
-        return UAT_OK;
+    for (int32_t i = 0; prefixes != NULL && prefixes[i] != NULL; i++) {
+        size_t prefixLen = strlen(prefixes[i]);
+        if (len >= prefixLen && memcmp(line, prefixes[i], prefixLen) == 0) {
+            return i;
+        }
     }
-    
-    // If we couldn't register the handler, reset the state
-    uat.inSendReceive = false;
-    uat.srBuffer = NULL;
-    uat.srBufferSize = 0;
-    uat.srBufferPos = 0;
-    
-    return UAT_ERR_RESOURCE;
+    return -1;
 }
 
 /**
- * @brief Sends an AT command and waits for a specific response
- * 
- * Implementation details:
- * 1. Takes handlerMutex to ensure exclusive access to command handlers
- * 2. Registers a temporary handler for the expected response
- * 3. Sends the command using uAT_SendCommand()
- * 4. Waits for the response with timeout
- * 5. Cleans up by unregistering the temporary handler
- * 
- * @param cmd Command to send
- * @param expected Expected response prefix till end of line
- * @param outBuf Buffer to store the response
- * @param bufLen Size of outBuf
- * @param timeoutTicks Maximum time to wait for response
- * @return UAT_OK on success, error code otherwise
+ * @brief Capture a received line for the active transaction
+ *
+ * The final line, a final result code, a "> " prompt or a line matching one
+ * of the transaction's finals, finishes the transaction and sends the next
+ * queued command from here, before any later line is parsed. A prompt for
+ * a transaction with a payload is answered with the payload instead, and
+ * the transaction goes on to the final result code after it, so no other
+ * command reaches the modem while it reads the data. A line matching one
+ * of its terminators only marks it successful: the modem's final result
+ * code still follows, and it must not end the next transaction instead.
+ * Unsolicited lines are counted but not stored, see uAT_Solicited(). The
+ * slot is claimed for the write by moving it from active to capturing, so
+ * no other task finishes it meanwhile and no lock is taken; nothing is
+ * stored, and no payload sent, for a transaction uAT_TxnCancel() is
+ * dropping, though its final line still ends it.
+ *
+ * @param line Received line including terminator (need not be null-terminated)
+ * @param len Length of the received line
+ * @return true if the line is the final line of the transaction, or the
+ *         prompt its payload answered
  */
-uAT_Result_t uAT_SendReceive(const char *cmd, const char *expected, char *outBuf, size_t bufLen, TickType_t timeoutTicks)
+static bool uAT_CaptureResponse(const char *line, size_t len)
 {
-    // Validate input parameters
-    if (!cmd || !expected || !outBuf || bufLen == 0) {
-        return UAT_ERR_INVALID_ARG;
+    uAT_TxnSlot_t *slot = uAT_TxnFront();
+    uint8_t state = UAT_TXN_ACTIVE;
+
+    if (!UAT_SHARED_CAS(&slot->state, &state, UAT_TXN_CAPTURING)) {
+        // Idle, or being finished by another task
+        return false;
     }
 
-    // Validate expected response isn't too long
-    if (strlen(expected) >= UAT_RX_BUFFER_SIZE) {
-        return UAT_ERR_INVALID_ARG;
+    int32_t terminator = uAT_MatchPrefix(slot->terminators, line, len);
+    int32_t errorCode = -1;
+    uAT_FinalCode_t finalCode = uAT_FinalCode(line, len, &errorCode);
+    int32_t finalMatch = finalCode == UAT_FINAL_NONE ? uAT_MatchPrefix(slot->finals, line, len) : -1;
+
+    // The modem waits for data after a prompt, nothing else follows
+    bool prompt = len == sizeof(UAT_SCAN_PROMPT) - 1 && memcmp(line, UAT_SCAN_PROMPT, len) == 0;
+    bool final = finalCode != UAT_FINAL_NONE || finalMatch >= 0 || prompt;
+
+    if (UAT_SHARED_LOAD(&slot->cancel) == slot->handle) {
+        // Its sink is no longer the submitter's to lend
+    } else if (final || terminator >= 0 || uAT_Solicited(slot, line, len)) {
+        if (terminator >= 0 && slot->result.terminator < 0) {
+            slot->result.terminator = terminator;
+        }
+        slot->result.finalCode = finalCode;
+        slot->result.finalMatch = finalMatch;
+        slot->result.errorCode = errorCode;
+        slot->result.lineCount++;
+        if (slot->arenaLow != NULL) {
+            uAT_AppendToArena(slot, line, len);
+        } else if (slot->buf != NULL) {
+            uAT_AppendToResponseBuffer(slot, line, len);
+        }
+    } else {
+        slot->result.linesSkipped++;
     }
 
-    // Clear the output buffer
-    memset(outBuf, 0, bufLen);
-    
-    // 1) Serialize access to SendReceive operation
-    if (xSemaphoreTake(uat.handlerMutex, timeoutTicks) != pdTRUE) {
-        return UAT_ERR_BUSY;
+    // Still capturing, so a cancel waits until the payload is out
+    bool answered = prompt && slot->payload != NULL && !slot->payloadSent &&
+                    UAT_SHARED_LOAD(&slot->cancel) != slot->handle;
+    uAT_Result_t sent = UAT_OK;
+    if (answered) {
+        slot->payloadSent = true;
+        sent = uAT_SendData(slot->payload, slot->payloadLen);
     }
-    
-    // Check if we're already in a SendReceive operation
-    if (uat.inSendReceive) {
-        xSemaphoreGive(uat.handlerMutex);
-        return UAT_ERR_BUSY;
+
+    // Back to active before checking for waiters, see uAT_TxnWaitCapture()
+    UAT_SHARED_STORE(&slot->state, UAT_TXN_ACTIVE);
+    if (UAT_SHARED_LOAD(&uat.sinkWaiters) != 0) {
+        xSemaphoreGive(uat.sinkFreed);
     }
-    
-    // Set up the SendReceive state
-    uAT_Result_t result = uAT_SetupSendReceiveState(expected, outBuf, bufLen);
-    if (result != UAT_OK) {
-        xSemaphoreGive(uat.handlerMutex);
-        return UAT_ERR_INT;
+
+    if (answered && sent == UAT_OK) {
+        return true;
     }
-    
-    // Release the mutex before sending command
-    xSemaphoreGive(uat.handlerMutex);
-    
-    // 2) Send the AT command
-    result = uAT_SendCommand(cmd);
-    if (result != UAT_OK) {
-        uAT_SafeCleanupSendReceiveState(expected, timeoutTicks);
-        return UAT_ERR_SEND_FAIL;
+    if (!final) {
+        return false;
     }
-    
-    // 3) Wait for the callback to fire (or timeout)
-    if (xSemaphoreTake(uat.sendReceiveSem, timeoutTicks) != pdTRUE) {
-        uAT_SafeCleanupSendReceiveState(expected, portMAX_DELAY);
-        return UAT_ERR_TIMEOUT;
+    if (uAT_TxnFinish(slot, answered ? UAT_ERR_SEND_FAIL : UAT_OK, false)) {
+        uAT_TxnKick();
     }
-    
-    // 4) Success - unregister the command handler
-    uAT_SafeCleanupSendReceiveState(expected, portMAX_DELAY);
-    return UAT_OK;
+    return true;
 }
 
-uAT_Result_t uAT_SendCommand(const char *cmd)
+/**
+ * @brief Capture a received line for a transaction and dispatch it to its handler
+ *
+ * Takes no lock, so a line is never dropped because another task is
+ * registering a handler or submitting a transaction.
+ *
+ * @param line Received line including terminator (need not be null-terminated)
+ * @param len Length of the received line
+ */
+static void uAT_HandleLine(const char *line, size_t len)
 {
-    if (!cmd)
-        return UAT_ERR_INVALID_ARG; // invalid command argument
-
-    if (xSemaphoreTake(uat.txMutex, pdMS_TO_TICKS(500)) != pdTRUE)
-        return UAT_ERR_BUSY;      // failed to take mutex, check if uart is busy
+    // The final line completes the transaction instead of reaching a handler
+    if (uAT_CaptureResponse(line, len)) {
+        return;
+    }
 
-    int len = snprintf((char *)uat.txBuffer,
-                       UAT_TX_BUFFER_SIZE, "%s\r\n", cmd);
+    uAT_DispatchCommand(line, len);
+}
 
-    if (len <= 0 || len >= UAT_TX_BUFFER_SIZE) 
-    {
-        xSemaphoreGive(uat.txMutex);
-        return UAT_ERR_INVALID_ARG; // buffer isn't valid length
-    }
+#ifdef UAT_DMA_ZERO_COPY
+/**
+ * @brief Pick up the published DMA write index, resyncing after an overrun
+ *
+ * @return DMA write index to scan up to
+ */
+static size_t uAT_DmaSync(void)
+{
+    // Count first: the ISR publishes it after the write index
+    uint32_t overruns = uat.rxStats.dmaOverruns;
+    size_t write_pos = dma_write_pos;
 
-    // choose DMA or IT transmit automatically by HAL
-    if (HAL_UART_Transmit_DMA(uat.huart, uat.txBuffer, len) != HAL_OK)
-    {
-        xSemaphoreGive(uat.txMutex);
-        return UAT_ERR_SEND_FAIL;  // failed to transmit
+    if (overruns != dma_overruns_seen) {
+        // The DMA lapped unparsed data, drop everything up to the newest byte
+        // and the rest of the line it belongs to
+        dma_overruns_seen = overruns;
+        dma_scan_pos = write_pos;
+        dma_line_len = 0;
+        dma_discard = true;
+        uat.rxStats.resyncs++;
     }
-    
-    // wait for completion with timeout
-    BaseType_t result = xSemaphoreTake(uat.txComplete, pdMS_TO_TICKS(1000));
-    xSemaphoreGive(uat.txMutex);
-
-    return (result == pdTRUE) ? UAT_OK : UAT_ERR_TIMEOUT;
+    return write_pos;
 }
 
-//
 /**
- * @brief Helper function that dispatches an incoming AT command
- *  to the appropriate registered handler.
+ * @brief Extract complete lines in place from the circular DMA buffer
  *
- * Iterates through registered command handlers to find a matching command prefix.
- * When a match is found, the corresponding handler is called with the command arguments.
+ * Scans the bytes published by uAT_UART_IdleHandler() exactly once for the
+ * last character of UAT_LINE_TERMINATOR. A line lying contiguously in the
+ * ring is dispatched in place; only a line wrapping past the end of the ring
+ * is stitched into dma_wrap_buf. A partial line stays in the ring until the
+ * rest of it is published.
  *
- * @param line Received command line to dispatch
- * @param len Length of the received command line
- * @return bool True if a matching handler was found and executed, false otherwise
+ * A line still counts as unparsed while its handlers run, so a DMA lap over
+ * it or over the lines after it is counted as an overrun. The overrun count
+ * is checked again after every line, and the bytes the DMA overwrote are
+ * dropped instead of dispatched.
  */
-static bool uAT_DispatchCommand(const char *line, size_t len)
+static void uAT_ProcessDmaRing(void)
 {
-    // Validate input parameters
-    if (!line || len == 0 || len >= UAT_RX_BUFFER_SIZE) {
-        return false;
-    }
-    
-    // Ensure line is null-terminated for safety
-    char safe_line[UAT_RX_BUFFER_SIZE];
-    if (len >= UAT_RX_BUFFER_SIZE - 1) {
-        len = UAT_RX_BUFFER_SIZE - 2; // Leave room for null terminator
-    }
-    memcpy(safe_line, line, len);
-    safe_line[len] = '\0';
-    
-    // Search for matching command handler
-    for (size_t i = 0; i < uat.cmdCount; i++) {
-        const char *cmd = uat.cmdHandlers[i].command;
-        if (!cmd) continue; // Skip invalid entries
-        
-        size_t cmdLen = strlen(cmd);
-        if (cmdLen == 0) continue; // Skip empty commands
-        
-        // Check if command matches
-        if (strncmp(safe_line, cmd, cmdLen) == 0) {
-            // Get arguments (safely)
-            const char *args = safe_line + cmdLen;
-            
-            // Skip leading spaces
-            while (*args == ' ') {
-                args++;
+    static const char term[] = UAT_LINE_TERMINATOR;
+    const size_t termLen = sizeof(term) - 1;
+
+    size_t write_pos = uAT_DmaSync();
+
+    while (dma_scan_pos != write_pos) {
+        // Scan up to the write index or the end of the ring, whichever comes first
+        size_t end = (write_pos > dma_scan_pos) ? write_pos : UAT_DMA_RX_SIZE;
+        size_t avail = end - dma_scan_pos;
+        size_t room = (UAT_RX_BUFFER_SIZE - 1) - dma_line_len;
+        if (avail > room) {
+            avail = room;
+        }
+
+        const char *seg = (const char *)&uart_dma_rx_buf[dma_scan_pos];
+        const char *hit = uAT_ScanByte(seg, avail, term[termLen - 1]);
+        size_t n = hit ? (size_t)(hit - seg) + 1 : avail;
+
+        dma_line_len += n;
+        dma_scan_pos = (dma_scan_pos + n) % UAT_DMA_RX_SIZE;
+
+        bool complete = false;
+        if (hit && dma_line_len >= termLen) {
+            // Verify the rest of the terminator, which may wrap the ring
+            complete = true;
+            for (size_t i = 1; i < termLen; i++) {
+                size_t idx = (dma_scan_pos + UAT_DMA_RX_SIZE - 1 - i) % UAT_DMA_RX_SIZE;
+                if (uart_dma_rx_buf[idx] != (uint8_t)term[termLen - 1 - i]) {
+                    complete = false;
+                    break;
+                }
             }
-            
-            // Store handler to call after releasing mutex
-            uAT_CommandHandler handler = uat.cmdHandlers[i].handler;
-            
-            // Validate handler before calling
-            if (!handler) {
-                xSemaphoreGive(uat.handlerMutex);
-                return false;
+        }
+        if (!complete) {
+            if (dma_line_len >= UAT_RX_BUFFER_SIZE - 1) {
+                // Over-length line, drop it up to its terminator; keep the bytes
+                // that may be the start of a split terminator
+                if (!dma_discard) {
+                    uat.rxStats.linesTruncated++;
+                }
+                dma_discard = true;
+                dma_line_len = termLen - 1;
             }
-            
-            xSemaphoreGive(uat.handlerMutex);
-            
-            // Call handler outside critical section
-            handler(args);
-            return true;
+            continue;
+        }
+        if (dma_discard) {
+            // End of a dropped line, parsing resumes after it
+            dma_discard = false;
+            dma_line_len = 0;
+            continue;
         }
+
+        size_t len = dma_line_len;
+        size_t start = (dma_scan_pos + UAT_DMA_RX_SIZE - len) % UAT_DMA_RX_SIZE;
+        const char *line = (const char *)&uart_dma_rx_buf[start];
+
+        if (start + len > UAT_DMA_RX_SIZE) {
+            // Line wraps the end of the ring, stitch both parts together
+            size_t head = UAT_DMA_RX_SIZE - start;
+            memcpy(dma_wrap_buf, &uart_dma_rx_buf[start], head);
+            memcpy(dma_wrap_buf + head, uart_dma_rx_buf, len - head);
+            line = dma_wrap_buf;
+        }
+
+        dma_line_len = 0;
+        uAT_HandleLine(line, len);
+        dma_read_pos = dma_scan_pos;
+
+        // The handlers may have run for a lap of the DMA
+        write_pos = uAT_DmaSync();
     }
-    
-    return false;
+
+    // A prompt never gets a terminator, hand it over once it is complete
+    if (!dma_discard && dma_line_len == sizeof(UAT_SCAN_PROMPT) - 1 &&
+        uAT_DmaEndsWithPrompt(dma_scan_pos)) {
+        size_t start = (dma_scan_pos + UAT_DMA_RX_SIZE - dma_line_len) % UAT_DMA_RX_SIZE;
+        dma_wrap_buf[0] = (char)uart_dma_rx_buf[start];
+        dma_wrap_buf[1] = (char)uart_dma_rx_buf[(start + 1) % UAT_DMA_RX_SIZE];
+        dma_line_len = 0;
+        uAT_HandleLine(dma_wrap_buf, sizeof(UAT_SCAN_PROMPT) - 1);
+    }
+
+    // Bytes of the partial line stay in the ring until it completes
+    dma_read_pos = (dma_scan_pos + UAT_DMA_RX_SIZE - dma_line_len) % UAT_DMA_RX_SIZE;
 }
+#endif
 
 /**
- * @brief Helper function to receive data from a stream buffer until a delimiter is found
+ * @brief Drain everything the receive ISR has handed over
  *
- * @param stream Stream buffer to read from
- * @param dest Destination buffer to store received characters
- * @param maxLen Maximum number of characters to read
- * @param delim Delimiter string to search for
- * @param ticksToWait Maximum time to wait for data (in RTOS ticks)
- * @return Number of characters received
+ * Called by uAT_Task after each wake-up. Dispatches every complete line and
+ * leaves a partial line buffered until the rest of it arrives.
  */
-size_t xStreamBufferReceiveUntilDelimiter(
-    StreamBufferHandle_t stream,
-    char *dest,
-    size_t maxLen,
-    const char *delim,
-    TickType_t ticksToWait)
+static void uAT_ProcessRx(void)
 {
-    // Validate parameters
-    if (stream == NULL || dest == NULL || maxLen < 2 || delim == NULL) {
-        return 0;
-    }
-    
-    size_t total = 0;
-    char ch;
-    TickType_t xTimeToWait = ticksToWait;
-    TimeOut_t xTimeOut;
-    
-    // Initialize timeout
-    vTaskSetTimeOutState(&xTimeOut);
-    
-    // Clear destination buffer
-    memset(dest, 0, maxLen);
-    
-    while (total < maxLen - 1) {
-        // Check for timeout
-        if (xTaskCheckForTimeOut(&xTimeOut, &xTimeToWait) == pdTRUE) {
-            break;
-        }
-        
-        // Try to receive a character
-        if (xStreamBufferReceive(stream, &ch, 1, xTimeToWait) != 1) {
-            break;
+    // Lines parsed in this pass are stamped with the time they were picked up
+    uat.rxTick = xTaskGetTickCount();
+
+#if defined(UAT_DMA_ZERO_COPY)
+    uAT_ProcessDmaRing();
+#elif defined(UAT_DMA_PINGPONG)
+    // Halves are handed over strictly alternately, parse them in that order
+    while (dma_pp_owner[dma_pp_next] == UAT_PP_TASK) {
+        const char *data = (const char *)&uart_dma_rx_buf[dma_pp_next * UAT_PP_HALF];
+        size_t remaining = dma_pp_len[dma_pp_next];
+
+        if (dma_pp_gap[dma_pp_next]) {
+            // Blocks were dropped before this one, drop the line they cut;
+            // its rest is at the start of this block unless they ended on a line end
+            if (dma_pp_midline[dma_pp_next]) {
+                uAT_Line_Resync(&uat.rxLine);
+            } else {
+                uAT_Line_Reset(&uat.rxLine);
+            }
+            uat.rxStats.resyncs++;
         }
-        
-        // Store the character
-        dest[total++] = ch;
-        dest[total] = '\0'; // Ensure null termination
-        
-        // Check if we've found the delimiter
-        if (total >= strlen(delim)) {
-            if (strstr(dest + total - strlen(delim), delim) != NULL) {
-                break;
+
+        while (remaining > 0) {
+            size_t n = uAT_Line_Write(&uat.rxLine, data, remaining);
+            data += n;
+            remaining -= n;
+
+            // Dispatch complete lines only, a partial line waits for more data
+            const char *line;
+            size_t len;
+            while (uAT_Line_Next(&uat.rxLine, &line, &len)) {
+                uAT_HandleLine(line, len);
             }
         }
+
+        // Give the half back to the ISR
+        dma_pp_owner[dma_pp_next] = UAT_PP_DMA;
+        dma_pp_next ^= 1;
     }
-    
-    // Ensure null termination
-    if (total < maxLen) {
-        dest[total] = '\0';
-    } else {
-        dest[maxLen - 1] = '\0';
-    }
-    
-    return total;
+#else
+    size_t received;
+    bool resynced;
+    do {
+        // Receive whatever is available straight into the line assembler
+        size_t space;
+        char *dst = uAT_Line_WritePtr(&uat.rxLine, &space);
+
+        // The ISR publishes the loss position before the count
+        uint32_t gaps, gapPos;
+        do {
+            gaps = uat.rxGapCount;
+            gapPos = uat.rxGapPos;
+        } while (gaps != uat.rxGapCount);
+
+        // Consumer's own index, no ordering needed to read it
+        bool gap = (gaps != uat.rxGapsSeen);
+        if (gap) {
+            uint32_t before = gapPos - uat.rxRing.tail;
+            if (gaps - uat.rxGapsSeen > 1) {
+                // Earlier losses are not located, drop everything up to the newest
+                uAT_Ring_Consume(&uat.rxRing, before);
+                before = 0;
+            }
+            if (space > before) {
+                space = before;
+            }
+        }
+
+        received = uAT_Ring_Read(&uat.rxRing, dst, space);
+        uAT_Line_Commit(&uat.rxLine, received);
+
+        // Dispatch complete lines only, a partial line waits for more data
+        const char *line;
+        size_t len;
+        while (uAT_Line_Next(&uat.rxLine, &line, &len)) {
+            uAT_HandleLine(line, len);
+        }
+
+        // Every line before the loss is out, drop the start of the one it cut;
+        // the ISR already dropped the rest of it
+        resynced = gap && uat.rxRing.tail == gapPos;
+        if (resynced) {
+            uAT_Line_Reset(&uat.rxLine);
+            uat.rxGapsSeen = gaps;
+            uat.rxStats.resyncs++;
+        }
+    } while (received > 0 || resynced);
+#endif
 }
 
+
 /**
  * @brief FreeRTOS task for handling UAT (UART AT) command processing
  *
- * This task continuously monitors the UAT receive stream for incoming commands.
- * When a complete command is received, it attempts to dispatch the command 
- * to a registered handler. In SendReceive mode, it also captures the response.
+ * This task sleeps until the receive ISR notifies it of new data, then
+ * dispatches every complete line to a registered handler. In SendReceive
+ * mode, it also captures the response.
  *
  * @param params Unused task parameters
  */
 void uAT_Task(void *params)
 {
     (void)params;
-    char lineBuf[UAT_RX_BUFFER_SIZE];
     
     // Task initialization
     printf("uAT_Task started\r\n");
 
+    // The receive ISR notifies this task, so it sleeps until there is work
+    uat.rxTask = xTaskGetCurrentTaskHandle();
+
     // Main task loop
     while (1) {
-        // Clear buffer for safety
-        memset(lineBuf, 0, sizeof(lineBuf));
-        
-        // Wait for data with timeout
-        size_t len = xStreamBufferReceiveUntilDelimiter(
-            uat.rxStream,
-            lineBuf,
-            sizeof(lineBuf),
-            UAT_LINE_TERMINATOR,
-            pdMS_TO_TICKS(1000));
-
-        if (len > 0) {
-            // Try to acquire mutex with timeout
-            if (xSemaphoreTake(uat.handlerMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                // Always capture response if in SendReceive mode
-                if (uat.inSendReceive && uat.srBuffer != NULL) {
-                    uAT_AppendToResponseBuffer(lineBuf, len);
-                }
-                
-                // Dispatch to appropriate handler
-                if (!uAT_DispatchCommand(lineBuf, len)) {
-                    // No handler found, release mutex
-                    xSemaphoreGive(uat.handlerMutex);
-                }
-                // Note: If handler found, the dispatch function releases the mutex
+        // Handle data that arrived before or while we were busy first
+        uAT_ProcessRx();
+
+        // A transaction without its final line in time gives way to the next
+        TickType_t waitTicks = uAT_TxnExpire();
+
+#ifdef UAT_DMA_PINGPONG
+        // Retry a restart the receive ISR failed, every tick until it works;
+        // no event can arrive while the DMA is stopped
+        if (UAT_SHARED_LOAD(&dma_pp_stopped)) {
+            UAT_SHARED_STORE(&dma_pp_stopped, false);
+            if (uAT_StartDmaRx() != HAL_OK) {
+                UAT_SHARED_STORE(&dma_pp_stopped, true);
+                waitTicks = 1;
             }
-            // If we couldn't get the mutex, we'll try again on the next iteration
         }
-        
-        // Short delay to prevent CPU hogging
-        vTaskDelay(pdMS_TO_TICKS(1));
+#endif
+
+        // Block until the ISR reports a complete line, a prompt or a filling
+        // buffer, a new transaction is submitted or the front one times out
+        uint32_t linesSeen;
+        xTaskNotifyWait(0, 0, &linesSeen, waitTicks);
+    }
+}
+
+#ifdef UAT_URC_TASK
+/**
+ * @brief FreeRTOS task running URC handlers
+ *
+ * uAT_Task recognizes URCs and queues them here, so a URC handler starts as
+ * soon as its line is parsed instead of after the response handlers before
+ * it, and a slow response handler cannot hold up URCs.
+ *
+ * @param params Unused task parameters
+ */
+void uAT_URCTask(void *params)
+{
+    (void)params;
+
+    uAT_RunWorkQueue(&uat.urcQueue);
+}
+#endif
+
+#ifdef UAT_WORKER_TASKS
+/**
+ * @brief FreeRTOS task running command handlers
+ *
+ * uAT_Task only matches lines and queues them to the workers, so a slow
+ * handler, e.g. one writing flash or calling uAT_SendReceive(), does not
+ * hold up reception. Each handler is always run by the same worker.
+ *
+ * @param params Worker index, 0 to UAT_WORKER_TASKS - 1, cast to a pointer
+ */
+void uAT_WorkerTask(void *params)
+{
+    uint32_t worker = (uint32_t)(uintptr_t)params;
+
+    if (worker >= UAT_WORKER_TASKS) {
+        // Every queue has its worker already, never take a second one
+        while (1) {
+            vTaskDelay(portMAX_DELAY);
+        }
     }
+
+    uAT_RunWorkQueue(&uat.workerQueues[worker]);
 }
+#endif
 
 /**
  * @brief  Reset the AT command interface
@@ -864,18 +3578,47 @@ uAT_Result_t uAT_Reset(void)
     HAL_UART_AbortReceive(uat.huart);
     HAL_UART_AbortTransmit(uat.huart);
 
-    // Clear stream buffer
-    if (uat.rxStream != NULL)
-    {
-        xStreamBufferReset(uat.rxStream);
-    }
+#ifdef UAT_RX_RING
+    // Clear the receive ring
+    uAT_Ring_Reset(&uat.rxRing);
+#endif
+#ifndef UAT_DMA_ZERO_COPY
+    // Forget the partial line
+    uAT_Line_Reset(&uat.rxLine);
+#endif
+#ifdef UAT_RX_RING
+    uat.rxGapsSeen = uat.rxGapCount;
+#endif
 
 #ifdef UAT_USE_DMA
     // Reset DMA
+#if defined(UAT_DMA_PINGPONG)
+    dma_pp_owner[0] = UAT_PP_DMA;
+    dma_pp_owner[1] = UAT_PP_DMA;
+    dma_pp_active = 0;
+    dma_pp_next = 0;
+    dma_pp_lost = false;
+    dma_pp_stopped = false;
+#elif defined(UAT_DMA_ZERO_COPY)
+    dma_write_pos = 0;
+    dma_read_pos = 0;
+    dma_scan_pos = 0;
+    dma_line_len = 0;
+    dma_overruns_seen = uat.rxStats.dmaOverruns; // Counters survive a reset
+    dma_discard = false;
+#else
     dma_last_pos = 0;
+#endif
 
     // Restart DMA reception
-    if (HAL_UART_Receive_DMA(uat.huart, uart_dma_rx_buf, UAT_DMA_RX_SIZE) != HAL_OK)
+    if (uAT_StartDmaRx() != HAL_OK)
+    {
+        return UAT_ERR_INIT_FAIL;
+    }
+#else
+    // Restart interrupt-driven reception
+    it_stage_len = 0;
+    if (HAL_UART_Receive_IT(uat.huart, &it_rx_byte, 1) != HAL_OK)
     {
         return UAT_ERR_INIT_FAIL;
     }
@@ -883,24 +3626,140 @@ uAT_Result_t uAT_Reset(void)
     // Re-enable IDLE interrupt
     __HAL_UART_CLEAR_IDLEFLAG(uat.huart);
     __HAL_UART_ENABLE_IT(uat.huart, UART_IT_IDLE);
+#endif
+
+    return UAT_OK;
+}
+
+/**
+ * @brief  Get the receive path statistics
+ * @param  stats Pointer to store the counters
+ * @return UAT_OK on success, or UAT_ERR_INVALID_ARG if stats is NULL
+ */
+uAT_Result_t uAT_GetRxStats(uAT_RxStats_t *stats)
+{
+    if (stats == NULL) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    // Word-sized loads, each counter is read whole without a lock
+    stats->bytesReceived = uat.rxStats.bytesReceived;
+    stats->bytesDropped = uat.rxStats.bytesDropped;
+    stats->dmaOverruns = uat.rxStats.dmaOverruns;
+    stats->rxHighWater = uat.rxStats.rxHighWater;
+#ifdef UAT_DMA_ZERO_COPY
+    stats->linesTruncated = uat.rxStats.linesTruncated;
 #else
-    // Restart interrupt-driven reception
-    static uint8_t rxByte;
-    if (HAL_UART_Receive_IT(uat.huart, &rxByte, 1) != HAL_OK)
-    {
-        return UAT_ERR_INIT_FAIL;
+    stats->linesTruncated = (uint32_t)uat.rxLine.overLength; // Counted by the line assembler
+#endif
+    stats->resyncs = uat.rxStats.resyncs;
+
+    return UAT_OK;
+}
+
+#ifdef UAT_WORKER_TASKS
+/**
+ * @brief Get the queue statistics of one worker
+ *
+ * @param worker Worker index, 0 to UAT_WORKER_TASKS - 1
+ * @param stats Pointer to store the counters
+ * @return UAT_OK on success, or UAT_ERR_INVALID_ARG if worker or stats is invalid
+ */
+uAT_Result_t uAT_GetWorkerStats(uint32_t worker, uAT_WorkerStats_t *stats)
+{
+    if (worker >= UAT_WORKER_TASKS || stats == NULL) {
+        return UAT_ERR_INVALID_ARG;
     }
+
+    const uAT_WorkQueue_t *q = &uat.workerQueues[worker];
+    uint32_t tail = UAT_SHARED_LOAD(&q->tail);
+    stats->queueLen = q->size;
+    stats->queued = UAT_SHARED_LOAD(&q->head) - tail;
+    stats->highWater = q->highWater;
+    stats->stalls = q->stalls;
+
+    return UAT_OK;
+}
 #endif
 
+#ifdef UAT_ENABLE_PROFILING
+/**
+ * @brief Get the execution statistics of every handler called so far
+ *
+ * @param stats Array to store the statistics
+ * @param maxStats Number of entries in stats
+ * @param count Pointer to store the number of entries written
+ * @return UAT_OK on success, UAT_ERR_INVALID_ARG if stats or count is NULL,
+ *         or UAT_ERR_RESOURCE if more handlers than maxStats were called
+ */
+uAT_Result_t uAT_GetHandlerStats(uAT_HandlerStats_t *stats, size_t maxStats, size_t *count)
+{
+    if (stats == NULL || count == NULL) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < UAT_PROFILE_SLOTS; i++) {
+        const uAT_ProfileEntry_t *p = &uat.profile[i];
+        const char *command = p->command;
+        if (command == NULL) {
+            continue;
+        }
+        if (n == maxStats) {
+            *count = n;
+            return UAT_ERR_RESOURCE;
+        }
+        stats[n].command = command;
+        stats[n].hits = p->hits;
+        stats[n].totalTime = p->totalTime;
+        stats[n].maxTime = p->maxTime;
+        stats[n].lastTime = p->lastTime;
+        n++;
+    }
+
+    *count = n;
     return UAT_OK;
 }
 
+/**
+ * @brief Get the count and the latest prefixes of lines no handler matched
+ *
+ * Never waits for uAT_Task: a copy that overlapped a prefix being written is
+ * reported as busy for the caller to retry.
+ *
+ * @param stats Pointer to store the statistics
+ * @return UAT_OK on success, UAT_ERR_INVALID_ARG if stats is NULL, or
+ *         UAT_ERR_BUSY if uAT_Task was writing a prefix
+ */
+uAT_Result_t uAT_GetUnmatchedStats(uAT_UnmatchedStats_t *stats)
+{
+    if (stats == NULL) {
+        return UAT_ERR_INVALID_ARG;
+    }
+
+    uint32_t seq = UAT_SHARED_LOAD(&uat.unmatchedSeq);
+    if (seq & 1u) {
+        return UAT_ERR_BUSY;
+    }
+    uint32_t lines = UAT_SHARED_LOAD(&uat.unmatchedLines);
+    stats->lines = lines;
+    stats->kept = lines < UAT_PROFILE_UNMATCHED ? lines : UAT_PROFILE_UNMATCHED;
+    for (uint32_t i = 0; i < stats->kept; i++) {
+        memcpy(stats->prefixes[i], uat.unmatched[(lines - 1 - i) % UAT_PROFILE_UNMATCHED],
+               UAT_PROFILE_PREFIX_LEN + 1);
+    }
+
+    // uAT_Task wrote a prefix meanwhile, the copy may be torn
+    return UAT_SHARED_LOAD(&uat.unmatchedSeq) == seq ? UAT_OK : UAT_ERR_BUSY;
+}
+#endif
+
 /**
  * @brief Register a URC handler with high priority
  * 
  * This function registers a command handler for Unsolicited Result Codes (URCs)
- * with higher priority than regular command handlers by inserting it at the
- * beginning of the handler array.
+ * with higher priority than regular command handlers by ordering it before
+ * every registered entry.
  * 
  * @param cmd Command string to match
  * @param handler Function to call when the command is received
@@ -908,49 +3767,26 @@ uAT_Result_t uAT_Reset(void)
  */
 uAT_Result_t uAT_RegisterURC(const char *cmd, uAT_CommandHandler handler)
 {
-    // Validate input parameters
-    if (!cmd || !handler) {
-        return UAT_ERR_INVALID_ARG;
-    }
-    
-    // Check command length
-    size_t cmdLen = strlen(cmd);
-    if (cmdLen == 0 || cmdLen >= UAT_RX_BUFFER_SIZE) {
+    if (!handler) {
         return UAT_ERR_INVALID_ARG;
     }
 
-    // Try to acquire mutex with timeout
-    if (xSemaphoreTake(uat.handlerMutex, portMAX_DELAY) != pdTRUE) {
-        return UAT_ERR_BUSY;
-    }
+    // Insert the URC handler ahead of all others
+    return uAT_Register(cmd, handler, NULL, NULL, true, false);
+}
 
-    // Check if command already exists
-    for (size_t i = 0; i < uat.cmdCount; i++) {
-        if (strcmp(uat.cmdHandlers[i].command, cmd) == 0) {
-            // Remove existing entry to reinsert at the beginning
-            for (size_t j = i; j < uat.cmdCount - 1; j++) {
-                uat.cmdHandlers[j] = uat.cmdHandlers[j + 1];
-            }
-            uat.cmdCount--;
-            break;
-        }
-    }
-    
-    // Check if we have space for a new handler
-    uAT_Result_t result = UAT_ERR_RESOURCE;
-    if (uat.cmdCount < UAT_MAX_CMD_HANDLERS) {
-        // Shift all handlers to make room at the beginning
-        for (size_t i = uat.cmdCount; i > 0; i--) {
-            uat.cmdHandlers[i] = uat.cmdHandlers[i-1];
-        }
-        
-        // Insert the URC handler at the beginning
-        uat.cmdHandlers[0].command = cmd;
-        uat.cmdHandlers[0].handler = handler;
-        uat.cmdCount++;
-        result = UAT_OK;
+/**
+ * @brief Register a URC with an extended handler
+ *
+ * @param cmd Command string to match
+ * @param handler Function called with a view of the arguments
+ * @param ctx Pointer passed to handler unchanged
+ * @return UAT_OK if successful, error code otherwise
+ */
+uAT_Result_t uAT_RegisterURCEx(const char *cmd, uAT_CommandHandlerEx handler, void *ctx)
+{
+    if (!handler) {
+        return UAT_ERR_INVALID_ARG;
     }
-    
-    xSemaphoreGive(uat.handlerMutex);
-    return result;
+    return uAT_Register(cmd, NULL, handler, ctx, true, false);
 }
@@ -0,0 +1,273 @@
+/**
+ * @file uat_line.c
+ * @brief Implementation of the block-oriented, resumable line assembler
+ *
+ * This file implements the functions declared in uat_line.h. Every received
+ * byte is scanned once, a word at a time, for the last character of the
+ * terminator; the rest of the terminator is only compared at candidates.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#include "uat_line.h"
+#include "uat_scan.h"
+#include <string.h>
+
+/**
+ * @brief Initialize a line assembler
+ *
+ * @param la Assembler to initialize
+ * @param buf Storage for received bytes
+ * @param size Size of buf
+ * @param terminator Null-terminated, non-empty line terminator
+ */
+void uAT_Line_Init(uAT_LineAssembler_t *la, char *buf, size_t size,
+                   const char *terminator)
+{
+    if (la == NULL)
+    {
+        return;
+    }
+
+    la->buf = buf;
+    la->size = (buf != NULL) ? size : 0;
+    la->term = terminator;
+    la->termLen = (terminator != NULL) ? strlen(terminator) : 0;
+    la->prompt = NULL;
+    la->promptLen = 0;
+    la->overLength = 0;
+    uAT_Line_Reset(la);
+}
+
+/**
+ * @brief Set a prompt that is returned as a line without a terminator
+ *
+ * @param la Assembler to configure
+ * @param prompt Null-terminated prompt, or NULL to disable
+ */
+void uAT_Line_SetPrompt(uAT_LineAssembler_t *la, const char *prompt)
+{
+    if (la == NULL)
+    {
+        return;
+    }
+
+    la->prompt = prompt;
+    la->promptLen = (prompt != NULL) ? strlen(prompt) : 0;
+}
+
+/**
+ * @brief Discard all buffered data, including a partial line
+ *
+ * @param la Assembler to reset
+ */
+void uAT_Line_Reset(uAT_LineAssembler_t *la)
+{
+    if (la == NULL)
+    {
+        return;
+    }
+
+    la->start = 0;
+    la->scan = 0;
+    la->end = 0;
+    la->discard = false;
+}
+
+/**
+ * @brief Drop the partial line and discard input up to the next terminator
+ *
+ * @param la Assembler to resync
+ */
+void uAT_Line_Resync(uAT_LineAssembler_t *la)
+{
+    if (la == NULL)
+    {
+        return;
+    }
+
+    la->start = la->end;
+    la->scan = la->end;
+    la->discard = true;
+}
+
+/**
+ * @brief Get the free space where new data can be written
+ *
+ * @param la Assembler to write into
+ * @param space Pointer to store the number of writable bytes
+ * @return Pointer to the first writable byte
+ */
+char *uAT_Line_WritePtr(uAT_LineAssembler_t *la, size_t *space)
+{
+    if (la == NULL || space == NULL)
+    {
+        return NULL;
+    }
+
+    if (la->start == la->end)
+    {
+        // Everything returned, start over at the front for free
+        la->start = 0;
+        la->scan = 0;
+        la->end = 0;
+    }
+    else if (la->end == la->size && la->start > 0)
+    {
+        // Tail is full, move the partial line to the front
+        size_t pending = la->end - la->start;
+        memmove(la->buf, la->buf + la->start, pending);
+        la->scan -= la->start;
+        la->end = pending;
+        la->start = 0;
+    }
+
+    *space = la->size - la->end;
+    return la->buf + la->end;
+}
+
+/**
+ * @brief Account for bytes written at uAT_Line_WritePtr()
+ *
+ * @param la Assembler written into
+ * @param len Number of bytes written, at most the space returned
+ */
+void uAT_Line_Commit(uAT_LineAssembler_t *la, size_t len)
+{
+    if (la == NULL)
+    {
+        return;
+    }
+
+    // Never account for more than the buffer holds
+    if (len > la->size - la->end)
+    {
+        len = la->size - la->end;
+    }
+    la->end += len;
+}
+
+/**
+ * @brief Copy a block of data into the assembler
+ *
+ * @param la Assembler to write into
+ * @param data Data to append
+ * @param len Length of data
+ * @return Number of bytes accepted (less than len if the buffer is full)
+ */
+size_t uAT_Line_Write(uAT_LineAssembler_t *la, const char *data, size_t len)
+{
+    if (la == NULL || data == NULL)
+    {
+        return 0;
+    }
+
+    size_t space;
+    char *dst = uAT_Line_WritePtr(la, &space);
+    if (len > space)
+    {
+        len = space;
+    }
+
+    memcpy(dst, data, len);
+    uAT_Line_Commit(la, len);
+    return len;
+}
+
+/**
+ * @brief Get the next complete line
+ *
+ * @param la Assembler to read from
+ * @param line Pointer to store the start of the line
+ * @param len Pointer to store the length of the line
+ * @return true if a line was returned, false if only a partial line is buffered
+ */
+bool uAT_Line_Next(uAT_LineAssembler_t *la, const char **line, size_t *len)
+{
+    if (la == NULL || line == NULL || len == NULL || la->termLen == 0)
+    {
+        return false;
+    }
+
+    const char last = la->term[la->termLen - 1];
+
+    // Only scan bytes that arrived since the previous call
+    while (la->scan < la->end)
+    {
+        const char *hit = uAT_ScanByte(la->buf + la->scan, la->end - la->scan, last);
+        if (hit == NULL)
+        {
+            la->scan = la->end;
+            break;
+        }
+
+        size_t stop = (size_t)(hit - la->buf) + 1;
+        la->scan = stop;
+
+        // Compare the rest of the terminator at the candidate only
+        if (stop - la->start >= la->termLen &&
+            memcmp(la->buf + stop - la->termLen, la->term, la->termLen - 1) == 0)
+        {
+            if (la->discard)
+            {
+                // End of a dropped line, parsing resumes after it
+                la->discard = false;
+                la->start = stop;
+                continue;
+            }
+
+            *line = la->buf + la->start;
+            *len = stop - la->start;
+            la->start = stop;
+            return true;
+        }
+    }
+
+    if (la->discard)
+    {
+        // Keep only what may be the start of a split terminator
+        size_t keep = la->termLen - 1;
+        if (la->end - la->start > keep)
+        {
+            la->start = la->end - keep;
+        }
+        return false;
+    }
+
+    // A prompt never gets a terminator, hand it over once it is complete
+    if (la->promptLen > 0 && la->end - la->start == la->promptLen &&
+        memcmp(la->buf + la->start, la->prompt, la->promptLen) == 0)
+    {
+        *line = la->buf + la->start;
+        *len = la->promptLen;
+        la->start = la->end;
+        return true;
+    }
+
+    // Buffer is full without a terminator, drop the line up to its end
+    if (la->start == 0 && la->end == la->size && la->size > 0)
+    {
+        la->overLength++;
+        la->discard = true;
+        la->start = la->end - ((la->termLen - 1 < la->size) ? la->termLen - 1 : 0);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Get the number of buffered bytes not yet returned as a line
+ *
+ * @param la Assembler to query
+ * @return Number of received bytes not yet returned by uAT_Line_Next()
+ */
+size_t uAT_Line_Pending(const uAT_LineAssembler_t *la)
+{
+    if (la == NULL)
+    {
+        return 0;
+    }
+
+    return la->end - la->start;
+}
@@ -0,0 +1,787 @@
+/**
+ * @file uat_match.c
+ * @brief Implementation of the prefix trie for command dispatch
+ *
+ * This file implements the functions declared in uat_match.h. A lookup
+ * costs one jump table access for the first byte and a short walk of a
+ * sorted sibling list for each following byte of the matched path. Where a
+ * wildcard edge leaves that path, a lookup keeps a small set of active nodes
+ * instead of one, as in a Thompson NFA: a '*' node stays active and so do
+ * its children.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#include "uat_match.h"
+#include <string.h>
+
+/**
+ * @brief Find the child of a node for a byte
+ *
+ * @param m Matcher to search
+ * @param node Parent node
+ * @param c Byte on the edge
+ * @return Child node, or 0 if none
+ */
+static uint16_t uAT_Match_Child(const uAT_Matcher_t *m, uint16_t node, char c)
+{
+    if (node == 0)
+    {
+        return m->first[(uint8_t)c];
+    }
+
+    // Siblings are sorted, stop at the first byte past c
+    uint16_t child = m->nodes[node].child;
+    while (child != 0 && (uint8_t)m->nodes[child].c < (uint8_t)c)
+    {
+        child = m->nodes[child].sibling;
+    }
+    return (child != 0 && m->nodes[child].c == c) ? child : 0;
+}
+
+/**
+ * @brief Find the node at the end of a path
+ *
+ * @param m Matcher to search
+ * @param prefix Path bytes
+ * @param len Length of prefix
+ * @return Node, or 0 if the path does not exist
+ */
+static uint16_t uAT_Match_Walk(const uAT_Matcher_t *m, const char *prefix, size_t len)
+{
+    uint16_t node = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        node = uAT_Match_Child(m, node, prefix[i]);
+        if (node == 0)
+        {
+            return 0;
+        }
+    }
+    return node;
+}
+
+/**
+ * @brief One edge of a pattern
+ */
+typedef struct
+{
+    uint8_t kind;      ///< Edge kind
+    char c;            ///< Byte of a literal edge
+    uint8_t set[32];   ///< Bytes of a class edge
+} uAT_MatchToken_t;
+
+/**
+ * @brief Read the bytes of a "[...]" class, after the '['
+ *
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @param pos Position after the '[', moved past the ']'
+ * @param set Bitmap to fill
+ * @return true on success, false if the class is not closed
+ */
+static bool uAT_Match_ParseClass(const char *pattern, size_t len, size_t *pos, uint8_t set[32])
+{
+    size_t i = *pos;
+    bool negate = false;
+
+    memset(set, 0, 32);
+    if (i < len && pattern[i] == '!')
+    {
+        negate = true;
+        i++;
+    }
+
+    // A ']' right after the opening is a member, not the end
+    size_t start = i;
+    while (i < len && (pattern[i] != ']' || i == start))
+    {
+        uint8_t lo = (uint8_t)pattern[i];
+        uint8_t hi = lo;
+        if (i + 2 < len && pattern[i + 1] == '-' && pattern[i + 2] != ']')
+        {
+            hi = (uint8_t)pattern[i + 2];
+            i += 2;
+        }
+        for (unsigned b = lo; b <= hi; b++)
+        {
+            set[b >> 3] |= (uint8_t)(1u << (b & 7));
+        }
+        i++;
+    }
+    if (i >= len)
+    {
+        return false;
+    }
+
+    if (negate)
+    {
+        for (size_t b = 0; b < 32; b++)
+        {
+            set[b] = (uint8_t)~set[b];
+        }
+    }
+    *pos = i + 1;
+    return true;
+}
+
+/**
+ * @brief Read the next edge of a pattern
+ *
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @param pos Position of the edge, moved past it
+ * @param tok Edge read
+ * @return true on success, false on a syntax error
+ */
+static bool uAT_Match_NextToken(const char *pattern, size_t len, size_t *pos, uAT_MatchToken_t *tok)
+{
+    char ch = pattern[(*pos)++];
+
+    tok->kind = UAT_MATCH_LITERAL;
+    tok->c = ch;
+    switch (ch)
+    {
+    case '?':
+        tok->kind = UAT_MATCH_ANY;
+        break;
+    case '*':
+        // "**" is the same as "*"
+        tok->kind = UAT_MATCH_STAR;
+        while (*pos < len && pattern[*pos] == '*')
+        {
+            (*pos)++;
+        }
+        break;
+    case '[':
+        tok->kind = UAT_MATCH_CLASS;
+        return uAT_Match_ParseClass(pattern, len, pos, tok->set);
+    case '\\':
+        if (*pos >= len)
+        {
+            return false;
+        }
+        tok->c = pattern[(*pos)++];
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+/**
+ * @brief Find a class in the class table
+ *
+ * @param m Matcher to search
+ * @param set Bytes of the class
+ * @return Class index, or -1 if the class is not stored
+ */
+static int uAT_Match_FindClass(const uAT_Matcher_t *m, const uint8_t set[32])
+{
+    for (size_t i = 0; i < m->classCount; i++)
+    {
+        if (memcmp(m->classes[i], set, 32) == 0)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the wildcard child of a node for an edge
+ *
+ * @param m Matcher to search
+ * @param node Parent node
+ * @param kind Edge kind, not UAT_MATCH_LITERAL
+ * @param c Class index of a class edge
+ * @return Child node, or 0 if none
+ */
+static uint16_t uAT_Match_WildChild(const uAT_Matcher_t *m, uint16_t node, uint8_t kind, char c)
+{
+    for (uint16_t w = m->nodes[node].wild; w != 0; w = m->nodes[w].sibling)
+    {
+        if (m->nodes[w].kind == kind && (kind != UAT_MATCH_CLASS || m->nodes[w].c == c))
+        {
+            return w;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Find the child of a node for a pattern edge
+ *
+ * @param m Matcher to search
+ * @param node Parent node
+ * @param tok Edge
+ * @return Child node, or 0 if none
+ */
+static uint16_t uAT_Match_TokenChild(const uAT_Matcher_t *m, uint16_t node, const uAT_MatchToken_t *tok)
+{
+    if (tok->kind == UAT_MATCH_LITERAL)
+    {
+        return uAT_Match_Child(m, node, tok->c);
+    }
+    if (tok->kind == UAT_MATCH_CLASS)
+    {
+        int cls = uAT_Match_FindClass(m, tok->set);
+        return cls < 0 ? 0 : uAT_Match_WildChild(m, node, UAT_MATCH_CLASS, (char)cls);
+    }
+    return uAT_Match_WildChild(m, node, tok->kind, 0);
+}
+
+/**
+ * @brief Find the node at the end of a pattern path
+ *
+ * @param m Matcher to search
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @return Node, or 0 if the path does not exist or the pattern is invalid
+ */
+static uint16_t uAT_Match_WalkPattern(const uAT_Matcher_t *m, const char *pattern, size_t len)
+{
+    uAT_MatchToken_t tok;
+    uint16_t node = 0;
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        if (!uAT_Match_NextToken(pattern, len, &pos, &tok))
+        {
+            return 0;
+        }
+        node = uAT_Match_TokenChild(m, node, &tok);
+        if (node == 0)
+        {
+            return 0;
+        }
+    }
+    return node;
+}
+
+/**
+ * @brief Take a node from the pool
+ *
+ * @param m Matcher to allocate from
+ * @param c Byte on the edge into the node
+ * @return New node, or 0 if the pool is exhausted
+ */
+static uint16_t uAT_Match_NewNode(uAT_Matcher_t *m, char c)
+{
+    if (m->used >= m->maxNodes)
+    {
+        return 0;
+    }
+
+    uint16_t node = (uint16_t)m->used++;
+    m->nodes[node].child = 0;
+    m->nodes[node].sibling = 0;
+    m->nodes[node].value = UAT_MATCH_NONE;
+    m->nodes[node].wild = 0;
+    m->nodes[node].c = c;
+    m->nodes[node].kind = UAT_MATCH_LITERAL;
+    return node;
+}
+
+/**
+ * @brief Link a new literal child below a node
+ *
+ * @param m Matcher to insert into
+ * @param node Parent node
+ * @param c Byte on the edge
+ * @return New node, or 0 if the pool is exhausted
+ */
+static uint16_t uAT_Match_AddChild(uAT_Matcher_t *m, uint16_t node, char c)
+{
+    uint16_t child = uAT_Match_NewNode(m, c);
+    if (child == 0)
+    {
+        return 0;
+    }
+
+    if (node == 0)
+    {
+        m->first[(uint8_t)c] = child;
+    }
+    else
+    {
+        // Keep the sibling list sorted by byte
+        uint16_t *link = &m->nodes[node].child;
+        while (*link != 0 && (uint8_t)m->nodes[*link].c < (uint8_t)c)
+        {
+            link = &m->nodes[*link].sibling;
+        }
+        m->nodes[child].sibling = *link;
+        *link = child;
+    }
+    return child;
+}
+
+/**
+ * @brief Initialize a matcher
+ *
+ * @param m Matcher to initialize
+ * @param nodes Node pool
+ * @param maxNodes Number of nodes in the pool, 2 to 65535
+ * @return true on success, false on invalid arguments
+ */
+bool uAT_Match_Init(uAT_Matcher_t *m, uAT_MatchNode_t *nodes, size_t maxNodes)
+{
+    if (m == NULL || nodes == NULL || maxNodes < 2 || maxNodes > UAT_MATCH_NONE)
+    {
+        return false;
+    }
+
+    m->nodes = nodes;
+    m->maxNodes = maxNodes;
+    uAT_Match_Clear(m);
+    return true;
+}
+
+/**
+ * @brief Remove all prefixes and release all nodes
+ *
+ * @param m Matcher to clear
+ */
+void uAT_Match_Clear(uAT_Matcher_t *m)
+{
+    if (m == NULL || m->nodes == NULL)
+    {
+        return;
+    }
+
+    // Node 0 is the root, its children are in the jump table
+    memset(m->first, 0, sizeof(m->first));
+    m->used = 0;
+    m->classCount = 0;
+    uAT_Match_NewNode(m, '\0');
+}
+
+/**
+ * @brief Store a value for a prefix, replacing any value it had
+ *
+ * @param m Matcher to insert into
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix, at least 1
+ * @param value Value to store, not UAT_MATCH_NONE
+ * @return true on success, false if the node pool is exhausted
+ */
+bool uAT_Match_Insert(uAT_Matcher_t *m, const char *prefix, size_t len, uint16_t value)
+{
+    if (m == NULL || prefix == NULL || len == 0 || value == UAT_MATCH_NONE)
+    {
+        return false;
+    }
+
+    // Nodes are only linked in once the whole path is allocated, so a
+    // failed insert leaves no half-built path behind
+    uint16_t node = 0;
+    size_t i = 0;
+    for (; i < len; i++)
+    {
+        uint16_t next = uAT_Match_Child(m, node, prefix[i]);
+        if (next == 0)
+        {
+            break;
+        }
+        node = next;
+    }
+
+    if (len - i > m->maxNodes - m->used)
+    {
+        return false;
+    }
+
+    for (; i < len; i++)
+    {
+        node = uAT_Match_AddChild(m, node, prefix[i]);
+    }
+
+    m->nodes[node].value = value;
+    return true;
+}
+
+/**
+ * @brief Get the value stored for exactly this prefix
+ *
+ * @param m Matcher to search
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix
+ * @return Stored value, or UAT_MATCH_NONE
+ */
+uint16_t uAT_Match_Get(const uAT_Matcher_t *m, const char *prefix, size_t len)
+{
+    if (m == NULL || prefix == NULL || len == 0)
+    {
+        return UAT_MATCH_NONE;
+    }
+
+    uint16_t node = uAT_Match_Walk(m, prefix, len);
+    return (node != 0) ? m->nodes[node].value : UAT_MATCH_NONE;
+}
+
+/**
+ * @brief Remove the value stored for a prefix
+ *
+ * @param m Matcher to remove from
+ * @param prefix Prefix bytes (need not be null-terminated)
+ * @param len Length of prefix
+ * @return true if a value was removed, false if the prefix had none
+ */
+bool uAT_Match_Remove(uAT_Matcher_t *m, const char *prefix, size_t len)
+{
+    if (m == NULL || prefix == NULL || len == 0)
+    {
+        return false;
+    }
+
+    uint16_t node = uAT_Match_Walk(m, prefix, len);
+    if (node == 0 || m->nodes[node].value == UAT_MATCH_NONE)
+    {
+        return false;
+    }
+
+    m->nodes[node].value = UAT_MATCH_NONE;
+    return true;
+}
+
+/**
+ * @brief Check the syntax of a glob pattern
+ *
+ * @param pattern Pattern bytes (need not be null-terminated)
+ * @param len Length of pattern
+ * @return true if the pattern is valid and not empty
+ */
+bool uAT_Match_PatternValid(const char *pattern, size_t len)
+{
+    if (pattern == NULL || len == 0)
+    {
+        return false;
+    }
+
+    uAT_MatchToken_t tok;
+    size_t pos = 0;
+    while (pos < len)
+    {
+        if (!uAT_Match_NextToken(pattern, len, &pos, &tok))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Store a value for a glob pattern, replacing any value it had
+ *
+ * @param m Matcher to insert into
+ * @param pattern Pattern bytes, see uAT_Match_PatternValid()
+ * @param len Length of pattern
+ * @param value Value to store, not UAT_MATCH_NONE
+ * @return true on success, false if the pattern is invalid or the node pool
+ *         or the class table is exhausted
+ */
+bool uAT_Match_InsertPattern(uAT_Matcher_t *m, const char *pattern, size_t len, uint16_t value)
+{
+    if (m == NULL || value == UAT_MATCH_NONE || !uAT_Match_PatternValid(pattern, len))
+    {
+        return false;
+    }
+
+    // Count what the path still needs first, so a failed insert leaves no
+    // half-built path behind
+    uAT_MatchToken_t tok;
+    uint16_t node = 0;
+    size_t pos = 0;
+    size_t newNodes = 0;
+    size_t newClasses = 0;
+    while (pos < len)
+    {
+        uAT_Match_NextToken(pattern, len, &pos, &tok);
+        if (newNodes == 0)
+        {
+            node = uAT_Match_TokenChild(m, node, &tok);
+        }
+        if (newNodes > 0 || node == 0)
+        {
+            newNodes++;
+            if (tok.kind == UAT_MATCH_CLASS && uAT_Match_FindClass(m, tok.set) < 0)
+            {
+                newClasses++;
+            }
+        }
+    }
+    if (newNodes > m->maxNodes - m->used || newClasses > UAT_MATCH_MAX_CLASSES - m->classCount)
+    {
+        return false;
+    }
+
+    node = 0;
+    pos = 0;
+    while (pos < len)
+    {
+        uAT_Match_NextToken(pattern, len, &pos, &tok);
+        uint16_t next = uAT_Match_TokenChild(m, node, &tok);
+        if (next == 0 && tok.kind == UAT_MATCH_LITERAL)
+        {
+            next = uAT_Match_AddChild(m, node, tok.c);
+        }
+        else if (next == 0)
+        {
+            char c = 0;
+            if (tok.kind == UAT_MATCH_CLASS)
+            {
+                int cls = uAT_Match_FindClass(m, tok.set);
+                if (cls < 0)
+                {
+                    cls = (int)m->classCount++;
+                    memcpy(m->classes[cls], tok.set, 32);
+                }
+                c = (char)cls;
+            }
+
+            // Wildcards are tried in any order, link at the head
+            next = uAT_Match_NewNode(m, c);
+            m->nodes[next].kind = tok.kind;
+            m->nodes[next].sibling = m->nodes[node].wild;
+            m->nodes[node].wild = next;
+        }
+        node = next;
+    }
+
+    m->nodes[node].value = value;
+    return true;
+}
+
+/**
+ * @brief Get the value stored for exactly this glob pattern
+ *
+ * @param m Matcher to search
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @return Stored value, or UAT_MATCH_NONE
+ */
+uint16_t uAT_Match_GetPattern(const uAT_Matcher_t *m, const char *pattern, size_t len)
+{
+    if (m == NULL || pattern == NULL || len == 0)
+    {
+        return UAT_MATCH_NONE;
+    }
+
+    uint16_t node = uAT_Match_WalkPattern(m, pattern, len);
+    return (node != 0) ? m->nodes[node].value : UAT_MATCH_NONE;
+}
+
+/**
+ * @brief Remove the value stored for a glob pattern
+ *
+ * @param m Matcher to remove from
+ * @param pattern Pattern bytes
+ * @param len Length of pattern
+ * @return true if a value was removed, false if the pattern had none
+ */
+bool uAT_Match_RemovePattern(uAT_Matcher_t *m, const char *pattern, size_t len)
+{
+    if (m == NULL || pattern == NULL || len == 0)
+    {
+        return false;
+    }
+
+    uint16_t node = uAT_Match_WalkPattern(m, pattern, len);
+    if (node == 0 || m->nodes[node].value == UAT_MATCH_NONE)
+    {
+        return false;
+    }
+
+    m->nodes[node].value = UAT_MATCH_NONE;
+    return true;
+}
+
+/**
+ * @brief Find the values of all stored prefixes of a line
+ *
+ * @param m Matcher to search
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @param values Array to store the values, shortest prefix first
+ * @param maxValues Size of values; longer prefixes beyond it are ignored
+ * @return Number of values stored
+ */
+size_t uAT_Match_Find(const uAT_Matcher_t *m, const char *line, size_t len,
+                      uint16_t *values, size_t maxValues)
+{
+    return uAT_Match_FindEx(m, line, len, values, NULL, maxValues);
+}
+
+/**
+ * @brief Add a node and the '*' nodes below it to an active set
+ *
+ * A '*' matches no bytes too, so it is active as soon as its parent is.
+ *
+ * @param m Matcher being searched
+ * @param set Active nodes
+ * @param count Number of nodes in set
+ * @param node Node to add
+ */
+static void uAT_Match_Activate(const uAT_Matcher_t *m, uint16_t *set, size_t *count, uint16_t node)
+{
+    for (size_t i = 0; i < *count; i++)
+    {
+        if (set[i] == node)
+        {
+            return;
+        }
+    }
+    if (*count >= UAT_MATCH_MAX_ACTIVE)
+    {
+        return;
+    }
+    set[(*count)++] = node;
+
+    for (uint16_t w = m->nodes[node].wild; w != 0; w = m->nodes[w].sibling)
+    {
+        if (m->nodes[w].kind == UAT_MATCH_STAR)
+        {
+            uAT_Match_Activate(m, set, count, w);
+        }
+    }
+}
+
+/**
+ * @brief Record the values of newly active nodes
+ *
+ * @param m Matcher being searched
+ * @param set Active nodes
+ * @param count Number of nodes in set
+ * @param end Length of the line matched so far
+ * @param values Array to store the values
+ * @param ends Array to store the match lengths, or NULL
+ * @param found Number of values stored, updated
+ * @param maxValues Size of values and ends
+ */
+static void uAT_Match_Report(const uAT_Matcher_t *m, const uint16_t *set, size_t count, size_t end,
+                             uint16_t *values, size_t *ends, size_t *found, size_t maxValues)
+{
+    for (size_t i = 0; i < count && *found < maxValues; i++)
+    {
+        uint16_t value = m->nodes[set[i]].value;
+        if (value == UAT_MATCH_NONE)
+        {
+            continue;
+        }
+
+        // A '*' can match the same pattern at several ends, keep the shortest
+        bool seen = false;
+        for (size_t j = 0; j < *found && !seen; j++)
+        {
+            seen = (values[j] == value);
+        }
+        if (!seen)
+        {
+            if (ends != NULL)
+            {
+                ends[*found] = end;
+            }
+            values[(*found)++] = value;
+        }
+    }
+}
+
+/**
+ * @brief Find the values of all stored prefixes and patterns matching a line
+ *
+ * @param m Matcher to search
+ * @param line Received line (need not be null-terminated)
+ * @param len Length of line
+ * @param values Array to store the values, shortest match first
+ * @param ends Array to store the length of each match, or NULL
+ * @param maxValues Size of values and ends; longer matches beyond it are ignored
+ * @return Number of values stored
+ */
+size_t uAT_Match_FindEx(const uAT_Matcher_t *m, const char *line, size_t len,
+                        uint16_t *values, size_t *ends, size_t maxValues)
+{
+    if (m == NULL || line == NULL || values == NULL)
+    {
+        return 0;
+    }
+
+    size_t found = 0;
+    uint16_t node = 0;
+    size_t i = 0;
+
+    // Plain trie walk until a wildcard edge leaves the path
+    while (m->nodes[node].wild == 0)
+    {
+        if (i == len || found == maxValues)
+        {
+            return found;
+        }
+        node = uAT_Match_Child(m, node, line[i++]);
+        if (node == 0)
+        {
+            return found;
+        }
+        if (m->nodes[node].value != UAT_MATCH_NONE)
+        {
+            if (ends != NULL)
+            {
+                ends[found] = i;
+            }
+            values[found++] = m->nodes[node].value;
+        }
+    }
+
+    // From here follow every path the wildcards open up
+    uint16_t sets[2][UAT_MATCH_MAX_ACTIVE];
+    uint16_t *active = sets[0];
+    uint16_t *next = sets[1];
+    size_t count = 0;
+
+    uAT_Match_Activate(m, active, &count, node);
+    uAT_Match_Report(m, active, count, i, values, ends, &found, maxValues);
+
+    for (; i < len && count > 0 && found < maxValues; i++)
+    {
+        uint8_t b = (uint8_t)line[i];
+        size_t nextCount = 0;
+
+        for (size_t a = 0; a < count; a++)
+        {
+            uint16_t n = active[a];
+            if (m->nodes[n].kind == UAT_MATCH_STAR)
+            {
+                uAT_Match_Activate(m, next, &nextCount, n);
+            }
+
+            uint16_t child = uAT_Match_Child(m, n, (char)b);
+            if (child != 0)
+            {
+                uAT_Match_Activate(m, next, &nextCount, child);
+            }
+
+            for (uint16_t w = m->nodes[n].wild; w != 0; w = m->nodes[w].sibling)
+            {
+                const uAT_MatchNode_t *wn = &m->nodes[w];
+                if (wn->kind == UAT_MATCH_ANY ||
+                    (wn->kind == UAT_MATCH_CLASS &&
+                     (m->classes[(uint8_t)wn->c][b >> 3] & (1u << (b & 7))) != 0))
+                {
+                    uAT_Match_Activate(m, next, &nextCount, w);
+                }
+            }
+        }
+
+        uAT_Match_Report(m, next, nextCount, i + 1, values, ends, &found, maxValues);
+
+        uint16_t *swap = active;
+        active = next;
+        next = swap;
+        count = nextCount;
+    }
+
+    return found;
+}
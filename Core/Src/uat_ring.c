@@ -0,0 +1,249 @@
+/**
+ * @file uat_ring.c
+ * @brief Implementation of the lock-free single-producer/single-consumer ring
+ *
+ * This file implements the functions declared in uat_ring.h. Each index is
+ * loaded with acquire and stored with release semantics, which keeps the
+ * data accesses of one side ordered against the index of the other side.
+ * On a single Cortex-M core this compiles to plain loads and stores plus
+ * compiler barriers (and a DMB where the architecture needs one).
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#include "uat_ring.h"
+#include <string.h>
+
+#define UAT_RING_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define UAT_RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/**
+ * @brief Initialize a ring
+ *
+ * @param ring Ring to initialize
+ * @param buf Storage for the ring
+ * @param size Size of buf, a power of two
+ * @return true on success, false if size is not a power of two
+ */
+bool uAT_Ring_Init(uAT_Ring_t *ring, uint8_t *buf, size_t size)
+{
+    if (ring == NULL || buf == NULL || size == 0 || (size & (size - 1)) != 0 ||
+        size > UINT32_MAX / 2)
+    {
+        return false;
+    }
+
+    ring->buf = buf;
+    ring->mask = (uint32_t)size - 1;
+    uAT_Ring_Reset(ring);
+    return true;
+}
+
+/**
+ * @brief Discard all data
+ *
+ * @param ring Ring to reset
+ */
+void uAT_Ring_Reset(uAT_Ring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    UAT_RING_STORE_RELEASE(&ring->head, 0);
+    UAT_RING_STORE_RELEASE(&ring->tail, 0);
+}
+
+/**
+ * @brief Get the number of bytes waiting to be read
+ *
+ * @param ring Ring to query
+ * @return Number of readable bytes
+ */
+size_t uAT_Ring_Used(const uAT_Ring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return 0;
+    }
+
+    // Free-running indices, the difference is correct across wrap-around
+    return UAT_RING_LOAD_ACQUIRE(&ring->head) - UAT_RING_LOAD_ACQUIRE(&ring->tail);
+}
+
+/**
+ * @brief Get the number of bytes that can be written
+ *
+ * @param ring Ring to query
+ * @return Number of writable bytes
+ */
+size_t uAT_Ring_Free(const uAT_Ring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return 0;
+    }
+
+    return (size_t)ring->mask + 1 - uAT_Ring_Used(ring);
+}
+
+/**
+ * @brief Get the contiguous free span at the write position (producer)
+ *
+ * @param ring Ring to write into
+ * @param span Pointer to store the start of the span
+ * @return Length of the span, 0 if the ring is full
+ */
+size_t uAT_Ring_WriteSpan(uAT_Ring_t *ring, uint8_t **span)
+{
+    if (ring == NULL || span == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t head = ring->head; // Own index, no ordering needed
+    uint32_t tail = UAT_RING_LOAD_ACQUIRE(&ring->tail);
+    uint32_t size = ring->mask + 1;
+    uint32_t free = size - (head - tail);
+    uint32_t toEnd = size - (head & ring->mask);
+
+    *span = ring->buf + (head & ring->mask);
+    return (free < toEnd) ? free : toEnd;
+}
+
+/**
+ * @brief Publish bytes written into the span (producer)
+ *
+ * @param ring Ring written into
+ * @param len Number of bytes written, at most the span length
+ */
+void uAT_Ring_Produce(uAT_Ring_t *ring, size_t len)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    // Release: the data must be visible before the new head
+    UAT_RING_STORE_RELEASE(&ring->head, ring->head + (uint32_t)len);
+}
+
+/**
+ * @brief Copy a block of data into the ring (producer)
+ *
+ * @param ring Ring to write into
+ * @param data Data to append
+ * @param len Length of data
+ * @return Number of bytes written (less than len if the ring is full)
+ */
+size_t uAT_Ring_Write(uAT_Ring_t *ring, const void *data, size_t len)
+{
+    if (ring == NULL || data == NULL)
+    {
+        return 0;
+    }
+
+    const uint8_t *src = (const uint8_t *)data;
+    size_t written = 0;
+
+    // At most two spans: up to the end of the buffer, then from the start
+    for (int i = 0; i < 2 && written < len; i++)
+    {
+        uint8_t *span;
+        size_t n = uAT_Ring_WriteSpan(ring, &span);
+        if (n == 0)
+        {
+            break;
+        }
+        if (n > len - written)
+        {
+            n = len - written;
+        }
+        memcpy(span, src + written, n);
+        written += n;
+        uAT_Ring_Produce(ring, n);
+    }
+
+    return written;
+}
+
+/**
+ * @brief Get the contiguous readable span at the read position (consumer)
+ *
+ * @param ring Ring to read from
+ * @param span Pointer to store the start of the span
+ * @return Length of the span, 0 if the ring is empty
+ */
+size_t uAT_Ring_ReadSpan(uAT_Ring_t *ring, const uint8_t **span)
+{
+    if (ring == NULL || span == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t tail = ring->tail; // Own index, no ordering needed
+    uint32_t head = UAT_RING_LOAD_ACQUIRE(&ring->head);
+    uint32_t used = head - tail;
+    uint32_t toEnd = ring->mask + 1 - (tail & ring->mask);
+
+    *span = ring->buf + (tail & ring->mask);
+    return (used < toEnd) ? used : toEnd;
+}
+
+/**
+ * @brief Release bytes read from the span (consumer)
+ *
+ * @param ring Ring read from
+ * @param len Number of bytes consumed, at most the span length
+ */
+void uAT_Ring_Consume(uAT_Ring_t *ring, size_t len)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    // Release: the data must be read before the producer may reuse it
+    UAT_RING_STORE_RELEASE(&ring->tail, ring->tail + (uint32_t)len);
+}
+
+/**
+ * @brief Copy data out of the ring (consumer)
+ *
+ * @param ring Ring to read from
+ * @param data Destination buffer
+ * @param len Size of data
+ * @return Number of bytes read
+ */
+size_t uAT_Ring_Read(uAT_Ring_t *ring, void *data, size_t len)
+{
+    if (ring == NULL || data == NULL)
+    {
+        return 0;
+    }
+
+    uint8_t *dst = (uint8_t *)data;
+    size_t read = 0;
+
+    // At most two spans: up to the end of the buffer, then from the start
+    for (int i = 0; i < 2 && read < len; i++)
+    {
+        const uint8_t *span;
+        size_t n = uAT_Ring_ReadSpan(ring, &span);
+        if (n == 0)
+        {
+            break;
+        }
+        if (n > len - read)
+        {
+            n = len - read;
+        }
+        memcpy(dst + read, span, n);
+        read += n;
+        uAT_Ring_Consume(ring, n);
+    }
+
+    return read;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file uat_scan.c
+ * @brief Implementation of the word-at-a-time scanning kernels
+ *
+ * This file implements the functions declared in uat_scan.h. The data is
+ * scanned bytewise up to the first aligned word, then one word per step until
+ * a word holds a match, and the match is located bytewise inside that word.
+ *
+ * @author Elkana Molson
+ * @date 2025
+ */
+
+#include "uat_scan.h"
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32 && defined(__GNUC__) && \
+    !defined(UAT_SCAN_NO_SIMD)
+#define UAT_SCAN_USE_SIMD32
+#endif
+
+#ifdef UAT_SCAN_USE_SIMD32
+typedef uint32_t uAT_ScanWord_t;
+#else
+typedef uintptr_t uAT_ScanWord_t;
+#endif
+
+#define UAT_SCAN_ONES  ((uAT_ScanWord_t)-1 / 0xFFu) ///< 0x01 in every byte
+#define UAT_SCAN_HIGHS (UAT_SCAN_ONES * 0x80u)      ///< 0x80 in every byte
+
+/**
+ * @brief Test a word for zero bytes
+ *
+ * @param x Word to test (data XOR the broadcast byte to find)
+ * @return Non-zero if at least one byte of x is zero
+ */
+static inline uAT_ScanWord_t uAT_ScanZeroBytes(uAT_ScanWord_t x)
+{
+#ifdef UAT_SCAN_USE_SIMD32
+    // UADD8 sets GE for every non-zero byte (carry out of x + 0xFF),
+    // SEL then yields 0xFF exactly in the lanes holding a zero byte
+    uint32_t syndrome;
+    __asm volatile("uadd8 %0, %1, %2\n\t"
+                   "sel   %0, %3, %2"
+                   : "=&r"(syndrome)
+                   : "r"(x), "r"(0xFFFFFFFFu), "r"(0u));
+    return syndrome;
+#else
+    // Classic haszero(): only exact for the lowest zero byte, which is all we need
+    return (x - UAT_SCAN_ONES) & ~x & UAT_SCAN_HIGHS;
+#endif
+}
+
+/**
+ * @brief Load a word from aligned memory without breaking strict aliasing
+ *
+ * @param p Word-aligned pointer
+ * @return Loaded word
+ */
+static inline uAT_ScanWord_t uAT_ScanLoad(const unsigned char *p)
+{
+    uAT_ScanWord_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/**
+ * @brief Find the first occurrence of a byte
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param c Byte to find
+ * @return Pointer to the first match, or NULL if not found
+ */
+const char *uAT_ScanByte(const char *data, size_t len, char c)
+{
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    const unsigned char *s = (const unsigned char *)data;
+    const unsigned char *end = s + len;
+    const unsigned char target = (unsigned char)c;
+
+    // Bytewise up to the first aligned word
+    while (s < end && ((uintptr_t)s % sizeof(uAT_ScanWord_t)) != 0)
+    {
+        if (*s == target)
+        {
+            return (const char *)s;
+        }
+        s++;
+    }
+
+    // One word per step until a word holds a match
+    const uAT_ScanWord_t pattern = UAT_SCAN_ONES * target;
+    while ((size_t)(end - s) >= sizeof(uAT_ScanWord_t))
+    {
+        if (uAT_ScanZeroBytes(uAT_ScanLoad(s) ^ pattern) != 0)
+        {
+            break;
+        }
+        s += sizeof(uAT_ScanWord_t);
+    }
+
+    // Locate the match inside the word, or scan the tail
+    while (s < end)
+    {
+        if (*s == target)
+        {
+            return (const char *)s;
+        }
+        s++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the first occurrence of either of two bytes
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param a First byte to find
+ * @param b Second byte to find
+ * @return Pointer to the first match, or NULL if not found
+ */
+const char *uAT_ScanByte2(const char *data, size_t len, char a, char b)
+{
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    const unsigned char *s = (const unsigned char *)data;
+    const unsigned char *end = s + len;
+    const unsigned char ta = (unsigned char)a;
+    const unsigned char tb = (unsigned char)b;
+
+    // Bytewise up to the first aligned word
+    while (s < end && ((uintptr_t)s % sizeof(uAT_ScanWord_t)) != 0)
+    {
+        if (*s == ta || *s == tb)
+        {
+            return (const char *)s;
+        }
+        s++;
+    }
+
+    // One word per step, testing both bytes
+    const uAT_ScanWord_t patternA = UAT_SCAN_ONES * ta;
+    const uAT_ScanWord_t patternB = UAT_SCAN_ONES * tb;
+    while ((size_t)(end - s) >= sizeof(uAT_ScanWord_t))
+    {
+        uAT_ScanWord_t w = uAT_ScanLoad(s);
+        if ((uAT_ScanZeroBytes(w ^ patternA) | uAT_ScanZeroBytes(w ^ patternB)) != 0)
+        {
+            break;
+        }
+        s += sizeof(uAT_ScanWord_t);
+    }
+
+    // Locate the match inside the word, or scan the tail
+    while (s < end)
+    {
+        if (*s == ta || *s == tb)
+        {
+            return (const char *)s;
+        }
+        s++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the first complete occurrence of a short marker
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @param marker Marker to find
+ * @param markerLen Length of marker
+ * @return Pointer to the start of the first match, or NULL if not found
+ */
+const char *uAT_ScanMarker(const char *data, size_t len,
+                           const char *marker, size_t markerLen)
+{
+    if (data == NULL || marker == NULL || markerLen == 0 || len < markerLen)
+    {
+        return NULL;
+    }
+
+    const char *s = data;
+    const char *last = data + len - markerLen; // Last possible start of a match
+
+    while (s <= last)
+    {
+        s = uAT_ScanByte(s, (size_t)(last - s) + 1, marker[0]);
+        if (s == NULL)
+        {
+            return NULL;
+        }
+
+        // Compare the rest of the marker at the candidate only
+        if (memcmp(s + 1, marker + 1, markerLen - 1) == 0)
+        {
+            return s;
+        }
+        s++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the first CR that is not followed by LF
+ *
+ * @param data Data to scan
+ * @param len Length of data
+ * @return Pointer to the bare CR, or NULL if not found
+ */
+const char *uAT_ScanBareCR(const char *data, size_t len)
+{
+    if (data == NULL || len < 2)
+    {
+        return NULL;
+    }
+
+    const char *s = data;
+    const char *last = data + len - 1; // A CR here cannot be decided yet
+
+    while (s < last)
+    {
+        s = uAT_ScanByte(s, (size_t)(last - s), '\r');
+        if (s == NULL)
+        {
+            return NULL;
+        }
+
+        if (s[1] != '\n')
+        {
+            return s;
+        }
+        s += 2;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file bench_dispatch.c
+ * @brief Host benchmark of command dispatch
+ *
+ * Matches received lines against a growing set of registered prefixes, once
+ * with the linear strlen()/memcmp() scan of the handler table that dispatch
+ * used before and once with the uAT prefix trie. Lines are matched against
+ * the first and the last registered prefix and against a line no prefix
+ * matches, which is the common case for responses such as "OK". A second
+ * table repeats the trie lookups with a glob pattern registered as well, and
+ * matches a line against the pattern itself.
+ */
+
+#include "uat_match.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_PREFIXES 256
+#define BENCH_LOOKUPS      200000
+
+static char prefixes[BENCH_MAX_PREFIXES][12];
+static uAT_MatchNode_t nodes[BENCH_MAX_PREFIXES * 16];
+static volatile size_t sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// The handler table scan dispatch used before the trie
+__attribute__((noinline)) static size_t linear_find(const char *line, size_t len, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *cmd = prefixes[i];
+        size_t cmdLen = strlen(cmd);
+        if (cmdLen <= len && memcmp(line, cmd, cmdLen) == 0)
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+static double run_linear(const char *line, size_t count)
+{
+    size_t len = strlen(line);
+    double start = now_sec();
+    for (int i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        sink += linear_find(line, len, count);
+    }
+    return (now_sec() - start) * 1e9 / BENCH_LOOKUPS;
+}
+
+static double run_trie(const uAT_Matcher_t *m, const char *line)
+{
+    size_t len = strlen(line);
+    uint16_t values[8];
+    double start = now_sec();
+    for (int i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        sink += uAT_Match_Find(m, line, len, values, 8);
+    }
+    return (now_sec() - start) * 1e9 / BENCH_LOOKUPS;
+}
+
+int main(void)
+{
+    static const size_t counts[] = {10, 32, 64, 128, 256};
+    uAT_Matcher_t m;
+    char first[32];
+    char last[32];
+
+    // Prefixes in the shape of vendor URCs, sharing their first bytes
+    for (size_t i = 0; i < BENCH_MAX_PREFIXES; i++)
+    {
+        snprintf(prefixes[i], sizeof(prefixes[i]), "+Q%03zu:", i);
+    }
+
+    printf("=== uAT Command Dispatch Benchmark (%d lookups, ns/line) ===\n", BENCH_LOOKUPS);
+    printf("%-9s %10s %10s %10s %10s %10s %10s\n",
+           "handlers", "first lin", "first trie", "last lin", "last trie", "none lin", "none trie");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        size_t count = counts[c];
+        uAT_Match_Init(&m, nodes, sizeof(nodes) / sizeof(nodes[0]));
+        for (size_t i = 0; i < count; i++)
+        {
+            uAT_Match_Insert(&m, prefixes[i], strlen(prefixes[i]), (uint16_t)i);
+        }
+
+        snprintf(first, sizeof(first), "%s 1,\"data\"", prefixes[0]);
+        snprintf(last, sizeof(last), "%s 1,\"data\"", prefixes[count - 1]);
+
+        printf("%-9zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", count,
+               run_linear(first, count), run_trie(&m, first),
+               run_linear(last, count), run_trie(&m, last),
+               run_linear("OK", count), run_trie(&m, "OK"));
+    }
+
+    printf("\n=== With the pattern \"+C?REG:\" registered (ns/line) ===\n");
+    printf("%-9s %10s %10s %10s %10s\n", "handlers", "first trie", "last trie", "none trie", "pattern");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        size_t count = counts[c];
+        uAT_Match_Init(&m, nodes, sizeof(nodes) / sizeof(nodes[0]));
+        for (size_t i = 0; i < count; i++)
+        {
+            uAT_Match_Insert(&m, prefixes[i], strlen(prefixes[i]), (uint16_t)i);
+        }
+        uAT_Match_InsertPattern(&m, "+C?REG:", 7, (uint16_t)count);
+
+        snprintf(first, sizeof(first), "%s 1,\"data\"", prefixes[0]);
+        snprintf(last, sizeof(last), "%s 1,\"data\"", prefixes[count - 1]);
+
+        printf("%-9zu %10.1f %10.1f %10.1f %10.1f\n", count,
+               run_trie(&m, first), run_trie(&m, last), run_trie(&m, "OK"),
+               run_trie(&m, "+CEREG: 0,1"));
+    }
+
+    return 0;
+}
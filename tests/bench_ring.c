@@ -0,0 +1,183 @@
+/**
+ * @file bench_ring.c
+ * @brief Host benchmark of the ISR-to-task receive channel
+ *
+ * Moves a buffer of modem traffic through the uAT SPSC ring and through a
+ * model of the FreeRTOS stream buffer, in the chunk sizes the receive paths
+ * use: single bytes (old interrupt mode), IT batches and DMA IDLE bursts.
+ *
+ * FreeRTOS is not available on the host, so the stream buffer is modelled
+ * after stream_buffer.c: a length check and two memcpy() per call, modulo
+ * indexing, and a critical section around each send and receive. The
+ * critical section is an out-of-line call here, where on the target it
+ * masks interrupts; numbers show the relative cost, not the cost on target.
+ */
+
+#include "uat_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DATA_SIZE  (256 * 1024)
+#define BENCH_RING_SIZE  512
+#define BENCH_ROUNDS     20
+
+static uint8_t data[BENCH_DATA_SIZE];
+static uint8_t sink_buf[BENCH_RING_SIZE];
+static volatile size_t sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Stand-in for taskENTER_CRITICAL_FROM_ISR()/taskEXIT_CRITICAL_FROM_ISR()
+static volatile unsigned critical_nesting;
+__attribute__((noinline)) static unsigned enter_critical(void)
+{
+    return critical_nesting++;
+}
+__attribute__((noinline)) static void exit_critical(unsigned saved)
+{
+    critical_nesting = saved;
+}
+
+// Stream buffer model: head/tail indices wrapped with modulo, as in stream_buffer.c
+typedef struct
+{
+    uint8_t buf[BENCH_RING_SIZE + 1]; // One byte is always kept free
+    size_t length;
+    volatile size_t head;
+    volatile size_t tail;
+} model_stream_t;
+
+static size_t model_bytes_in_buffer(const model_stream_t *sb)
+{
+    size_t count = sb->length + sb->head;
+    count -= sb->tail;
+    if (count >= sb->length)
+    {
+        count -= sb->length;
+    }
+    return count;
+}
+
+static size_t model_send(model_stream_t *sb, const uint8_t *src, size_t len)
+{
+    unsigned saved = enter_critical();
+    size_t space = sb->length - model_bytes_in_buffer(sb) - 1;
+    if (len > space)
+    {
+        len = space;
+    }
+    size_t first = sb->length - sb->head;
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(&sb->buf[sb->head], src, first);
+    if (len > first)
+    {
+        memcpy(sb->buf, src + first, len - first);
+    }
+    size_t head = sb->head + len;
+    if (head >= sb->length)
+    {
+        head -= sb->length;
+    }
+    sb->head = head;
+    exit_critical(saved);
+    return len;
+}
+
+static size_t model_receive(model_stream_t *sb, uint8_t *dst, size_t len)
+{
+    unsigned saved = enter_critical();
+    size_t avail = model_bytes_in_buffer(sb);
+    if (len > avail)
+    {
+        len = avail;
+    }
+    size_t first = sb->length - sb->tail;
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(dst, &sb->buf[sb->tail], first);
+    if (len > first)
+    {
+        memcpy(dst + first, sb->buf, len - first);
+    }
+    size_t tail = sb->tail + len;
+    if (tail >= sb->length)
+    {
+        tail -= sb->length;
+    }
+    sb->tail = tail;
+    exit_critical(saved);
+    return len;
+}
+
+static double run_stream(size_t chunk)
+{
+    static model_stream_t sb;
+    sb.length = sizeof(sb.buf);
+    sb.head = 0;
+    sb.tail = 0;
+
+    double start = now_sec();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for (size_t pos = 0; pos < BENCH_DATA_SIZE; pos += chunk)
+        {
+            model_send(&sb, &data[pos], chunk);
+            sink += model_receive(&sb, sink_buf, sizeof(sink_buf));
+        }
+    }
+    return now_sec() - start;
+}
+
+static double run_ring(size_t chunk)
+{
+    static uint8_t buf[BENCH_RING_SIZE];
+    uAT_Ring_t ring;
+    uAT_Ring_Init(&ring, buf, sizeof(buf));
+
+    double start = now_sec();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for (size_t pos = 0; pos < BENCH_DATA_SIZE; pos += chunk)
+        {
+            uAT_Ring_Write(&ring, &data[pos], chunk);
+            sink += uAT_Ring_Read(&ring, sink_buf, sizeof(sink_buf));
+        }
+    }
+    return now_sec() - start;
+}
+
+int main(void)
+{
+    static const size_t chunks[] = {1, 32, 128};
+    double bytes = (double)BENCH_DATA_SIZE * BENCH_ROUNDS;
+
+    srand(42);
+    for (size_t i = 0; i < BENCH_DATA_SIZE; i++)
+    {
+        data[i] = (uint8_t)(' ' + rand() % 95);
+    }
+
+    printf("=== uAT Receive Channel Benchmark (%d bytes x %d rounds) ===\n", BENCH_DATA_SIZE, BENCH_ROUNDS);
+    printf("%-8s %22s %22s\n", "chunk", "stream buffer model", "uAT_Ring");
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        double stream = run_stream(chunks[i]);
+        double ring = run_ring(chunks[i]);
+        printf("%-8zu %15.3f ns/byte %15.3f ns/byte\n",
+               chunks[i], stream * 1e9 / bytes, ring * 1e9 / bytes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file bench_scan.c
+ * @brief Host benchmark of line terminator scanning
+ *
+ * Splits a buffer of typical modem traffic into lines with the old per-byte
+ * strstr path (as used by the removed xStreamBufferReceiveUntilDelimiter),
+ * with strstr over the whole buffer, with a bytewise loop and with the uAT
+ * scanning kernels. Numbers are host numbers; they show the relative cost
+ * of each approach, not the cost on the target.
+ */
+
+#include "uat_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DATA_SIZE  (64 * 1024)
+#define BENCH_ROUNDS     50
+
+static char data[BENCH_DATA_SIZE + 1];
+static volatile size_t sink;
+
+static const char *sample_lines[] = {
+    "OK\r\n",
+    "+CREG: 1,5\r\n",
+    "+CSQ: 21,99\r\n",
+    "+QIURC: \"recv\",0,128\r\n",
+    "+COPS: 0,0,\"Operator Name\",7\r\n",
+    "+CMGL: 1,\"REC UNREAD\",\"+15551234567\",,\"25/05/06,10:12:13+08\"\r\n",
+    "+QENG: \"servingcell\",\"NOCONN\",\"LTE\",\"FDD\",425,01,1A2B3C4,123,1850,3,5,5,7D,-95,-11,-64,16,37\r\n",
+};
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t fill_data(void)
+{
+    size_t pos = 0;
+    size_t n = sizeof(sample_lines) / sizeof(sample_lines[0]);
+    srand(42);
+    for (;;)
+    {
+        const char *line = sample_lines[rand() % n];
+        size_t len = strlen(line);
+        if (pos + len > BENCH_DATA_SIZE)
+        {
+            break;
+        }
+        memcpy(data + pos, line, len);
+        pos += len;
+    }
+    data[pos] = '\0';
+    return pos;
+}
+
+// Old path: append each byte, then strlen(delim) twice and strstr at the tail
+static size_t split_per_byte_strstr(const char *p, size_t len)
+{
+    static char dest[512];
+    const char *delim = "\r\n";
+    size_t lines = 0;
+    size_t total = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        dest[total++] = p[i];
+        dest[total] = '\0';
+        if (total >= strlen(delim) && strstr(dest + total - strlen(delim), delim) != NULL)
+        {
+            lines++;
+            total = 0;
+        }
+        else if (total >= sizeof(dest) - 1)
+        {
+            total = 0;
+        }
+    }
+    return lines;
+}
+
+// strstr over the whole (null-terminated) buffer
+static size_t split_strstr(const char *p, size_t len)
+{
+    (void)len;
+    size_t lines = 0;
+    const char *s = p;
+    while ((s = strstr(s, "\r\n")) != NULL)
+    {
+        lines++;
+        s += 2;
+    }
+    return lines;
+}
+
+// Plain bytewise loop
+static size_t split_bytewise(const char *p, size_t len)
+{
+    size_t lines = 0;
+    for (size_t i = 1; i < len; i++)
+    {
+        if (p[i] == '\n' && p[i - 1] == '\r')
+        {
+            lines++;
+        }
+    }
+    return lines;
+}
+
+// uAT kernel searching the whole terminator
+static size_t split_scan_marker(const char *p, size_t len)
+{
+    size_t lines = 0;
+    const char *end = p + len;
+    const char *s = p;
+    while ((s = uAT_ScanMarker(s, (size_t)(end - s), "\r\n", 2)) != NULL)
+    {
+        lines++;
+        s += 2;
+    }
+    return lines;
+}
+
+// uAT kernel as used by the line assembler: LF, then check the CR
+static size_t split_scan_byte(const char *p, size_t len)
+{
+    size_t lines = 0;
+    const char *end = p + len;
+    const char *s = p;
+    while ((s = uAT_ScanByte(s, (size_t)(end - s), '\n')) != NULL)
+    {
+        if (s > p && s[-1] == '\r')
+        {
+            lines++;
+        }
+        s++;
+    }
+    return lines;
+}
+
+static void run(const char *name, size_t (*fn)(const char *, size_t), size_t len)
+{
+    size_t lines = 0;
+    double start = now_sec();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        lines = fn(data, len);
+        sink += lines;
+    }
+    double elapsed = now_sec() - start;
+    double bytes = (double)len * BENCH_ROUNDS;
+    printf("%-24s %8zu lines  %8.3f ns/byte  %9.1f MB/s\n",
+           name, lines, elapsed * 1e9 / bytes, bytes / elapsed / 1e6);
+}
+
+int main(void)
+{
+    size_t len = fill_data();
+    printf("=== uAT Terminator Scan Benchmark (%zu bytes x %d rounds) ===\n", len, BENCH_ROUNDS);
+
+    run("per-byte strstr (old)", split_per_byte_strstr, len);
+    run("strstr", split_strstr, len);
+    run("bytewise", split_bytewise, len);
+    run("uAT_ScanMarker", split_scan_marker, len);
+    run("uAT_ScanByte", split_scan_byte, len);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file task_harness.c
+ * @brief Implementation of the uAT task harness
+ */
+
+#include "task_harness.h"
+#include <setjmp.h>
+#include <string.h>
+
+UART_HandleTypeDef test_huart;
+#ifdef UAT_USE_DMA
+static uint8_t test_dma;
+#endif
+static jmp_buf task_exit;
+static jmp_buf handler_exit;
+#ifdef UAT_DMA_RX_EVENT
+static size_t dma_pos; // Where the next receive() writes
+#endif
+
+static void leave_task(void)
+{
+    longjmp(task_exit, 1);
+}
+
+static void leave_handler_task(void)
+{
+    longjmp(handler_exit, 1);
+}
+
+void task_harness_init(void)
+{
+    mock_freertos_reset();
+    mock_hal_status = HAL_OK;
+    mock_uart_rx_to_idle = 0;
+    mock_uart_tx_hook = NULL;
+    memset(&test_huart, 0, sizeof(test_huart));
+#ifdef UAT_USE_DMA
+    test_huart.hdmarx = &test_dma;
+#endif
+#ifdef UAT_DMA_RX_EVENT
+    dma_pos = 0;
+#endif
+    uAT_Init(&test_huart);
+    run_task_once(); // Task is up and waiting before data arrives
+}
+
+void run_task_once(void)
+{
+    mock_task_notify_wait_hook = leave_task;
+    if (setjmp(task_exit) == 0)
+    {
+        uAT_Task(NULL);
+    }
+    mock_task_notify_wait_hook = NULL;
+}
+
+void run_handler_task_once(void (*task)(void *), void *params)
+{
+    void (*saved)(void) = mock_task_notify_wait_hook;
+    mock_task_notify_wait_hook = leave_handler_task;
+    if (setjmp(handler_exit) == 0)
+    {
+        task(params);
+    }
+    mock_task_notify_wait_hook = saved;
+}
+
+#ifdef UAT_DMA_RX_EVENT
+void receive(const char *data)
+{
+    size_t len = strlen(data);
+    if (dma_pos + len > mock_uart_rx_size)
+    {
+        dma_pos = 0;
+    }
+    memcpy(&mock_uart_rx_buf[dma_pos], data, len);
+    dma_pos += len;
+    HAL_UARTEx_RxEventCallback(&test_huart, (uint16_t)dma_pos);
+    run_task_once();
+}
+#endif
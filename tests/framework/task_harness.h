@@ -0,0 +1,36 @@
+/**
+ * @file task_harness.h
+ * @brief Runs the uAT tasks one pass at a time inside a test
+ *
+ * The mocked xTaskNotifyWait() calls mock_task_notify_wait_hook where a task
+ * would block. The harness leaves the task there with longjmp(), so each run
+ * returns once the task has handled everything handed to it. The harness is
+ * compiled into each test with that test's uat_freertos.c configuration.
+ */
+
+#ifndef TASK_HARNESS_H
+#define TASK_HARNESS_H
+
+#include "uat_freertos.h"
+
+// UART handed to uAT_Init(), with a DMA handle in DMA mode
+extern UART_HandleTypeDef test_huart;
+
+// Reset the mocks, initialize uAT and run uAT_Task up to its first wait
+void task_harness_init(void);
+
+// Let uAT_Task parse whatever has been handed over, then return
+void run_task_once(void);
+
+// Run one pass of uAT_URCTask or a uAT_WorkerTask, also from a wait inside
+// uAT_Task, e.g. from mock_semaphore_take_hook
+void run_handler_task_once(void (*task)(void *), void *params);
+
+#ifdef UAT_DMA_RX_EVENT
+// Write data into the DMA buffer after the previous receive, starting over
+// at the beginning when it does not fit, raise the IDLE event and run
+// uAT_Task once
+void receive(const char *data);
+#endif
+
+#endif // TASK_HARNESS_H
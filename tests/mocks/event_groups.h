@@ -0,0 +1,11 @@
+/**
+ * @file event_groups.h
+ * @brief Mock FreeRTOS event group header
+ */
+
+#ifndef EVENT_GROUPS_H
+#define EVENT_GROUPS_H
+
+#include "freertos_mock.h"
+
+#endif // EVENT_GROUPS_H
@@ -12,6 +12,14 @@ bool mock_freertos_init_success = true;
 BaseType_t mock_semaphore_take_result = pdTRUE;
 BaseType_t mock_semaphore_give_result = pdTRUE;
 size_t mock_stream_buffer_receive_bytes = 0;
+uint32_t mock_task_notify_value = 0;
+uint32_t mock_task_notify_count = 0;
+TickType_t mock_tick_count = 0;
+EventBits_t mock_event_group_bits = 0;
+void (*mock_task_notify_wait_hook)(void) = NULL;
+void (*mock_task_delay_hook)(void) = NULL;
+void (*mock_semaphore_take_hook)(void) = NULL;
+TaskHandle_t mock_current_task = NULL;
 
 // Internal mock state
 static bool failure_mode = false;
@@ -22,6 +30,14 @@ void mock_freertos_reset(void)
     mock_semaphore_take_result = pdTRUE;
     mock_semaphore_give_result = pdTRUE;
     mock_stream_buffer_receive_bytes = 0;
+    mock_task_notify_value = 0;
+    mock_task_notify_count = 0;
+    mock_tick_count = 0;
+    mock_event_group_bits = 0;
+    mock_task_notify_wait_hook = NULL;
+    mock_task_delay_hook = NULL;
+    mock_semaphore_take_hook = NULL;
+    mock_current_task = NULL;
     failure_mode = false;
 }
 
@@ -119,6 +135,10 @@ BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait)
 {
     (void)xSemaphore;
     (void)xTicksToWait;
+    // Lets a test run another task while this one blocks
+    if (mock_semaphore_take_hook != NULL) {
+        mock_semaphore_take_hook();
+    }
     return mock_semaphore_take_result;
 }
 
@@ -154,7 +174,10 @@ BaseType_t xTaskCreate(void (*pxTaskCode)(void *), const char *pcName, uint16_t
 void vTaskDelay(TickType_t xTicksToDelay)
 {
     (void)xTicksToDelay;
-    // No-op in test environment
+    // Lets a test run another task while this one waits
+    if (mock_task_delay_hook != NULL) {
+        mock_task_delay_hook();
+    }
 }
 
 void vTaskSetTimeOutState(TimeOut_t *pxTimeOut)
@@ -170,8 +193,70 @@ BaseType_t xTaskCheckForTimeOut(TimeOut_t *pxTimeOut, TickType_t *pxTicksToWait)
     return pdFALSE; // Never timeout in tests
 }
 
+// All event groups share one set of bits
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet)
+{
+    (void)xEventGroup;
+    mock_event_group_bits |= uxBitsToSet;
+    return mock_event_group_bits;
+}
+
 void xStreamBufferReset(StreamBufferHandle_t xStreamBuffer)
 {
     (void)xStreamBuffer;
     // No-op in test environment
-}
\ No newline at end of file
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    (void)xStreamBuffer;
+    return mock_stream_buffer_receive_bytes;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    static int current_task;
+    return mock_current_task != NULL ? mock_current_task : &current_task;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return mock_tick_count;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    (void)xTaskToNotify;
+    (void)pxHigherPriorityTaskWoken;
+
+    if (eAction == eIncrement) {
+        mock_task_notify_value++;
+    } else if (eAction == eSetBits) {
+        mock_task_notify_value |= ulValue;
+    } else if (eAction != eNoAction) {
+        mock_task_notify_value = ulValue;
+    }
+    mock_task_notify_count++;
+    return pdTRUE;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction)
+{
+    return xTaskNotifyFromISR(xTaskToNotify, ulValue, eAction, NULL);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait)
+{
+    (void)ulBitsToClearOnEntry;
+    (void)ulBitsToClearOnExit;
+    (void)xTicksToWait;
+
+    if (mock_task_notify_wait_hook) {
+        mock_task_notify_wait_hook();
+    }
+
+    if (pulNotificationValue) {
+        *pulNotificationValue = mock_task_notify_value;
+    }
+    return pdTRUE;
+}
@@ -17,10 +17,20 @@ typedef uint32_t UBaseType_t;
 typedef void* TaskHandle_t;
 typedef void* SemaphoreHandle_t;
 typedef void* StreamBufferHandle_t;
+typedef void* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
 typedef struct {
     uint32_t dummy;
 } TimeOut_t;
 
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
 // Mock constants
 #define pdTRUE                    (1)
 #define pdFALSE                   (0)
@@ -52,15 +62,41 @@ BaseType_t xTaskCreate(void (*pxTaskCode)(void *), const char *pcName, uint16_t
 void vTaskDelay(TickType_t xTicksToDelay);
 void vTaskSetTimeOutState(TimeOut_t *pxTimeOut);
 BaseType_t xTaskCheckForTimeOut(TimeOut_t *pxTimeOut, TickType_t *pxTicksToWait);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction);
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait);
+
+// Mock event group functions
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet);
 
 // Mock stream buffer functions (additional)
 void xStreamBufferReset(StreamBufferHandle_t xStreamBuffer);
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer);
 
 // Mock control variables for testing
 extern bool mock_freertos_init_success;
 extern BaseType_t mock_semaphore_take_result;
 extern BaseType_t mock_semaphore_give_result;
 extern size_t mock_stream_buffer_receive_bytes;
+extern uint32_t mock_task_notify_value;
+extern uint32_t mock_task_notify_count;
+extern TickType_t mock_tick_count;
+extern EventBits_t mock_event_group_bits;
+
+// Called at the start of xTaskNotifyWait(), e.g. to leave uAT_Task with longjmp()
+extern void (*mock_task_notify_wait_hook)(void);
+
+// Called from vTaskDelay(), e.g. to run another task while one waits
+extern void (*mock_task_delay_hook)(void);
+
+// Called at the start of xSemaphoreTake(), e.g. to run another task while one blocks
+extern void (*mock_semaphore_take_hook)(void);
+
+// Returned by xTaskGetCurrentTaskHandle() if set, e.g. to call in as a task
+// other than uAT_Task
+extern TaskHandle_t mock_current_task;
 
 // Test helper functions
 void mock_freertos_reset(void);
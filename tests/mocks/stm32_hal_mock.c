@@ -9,29 +9,43 @@
 uint32_t mock_uart_flag_state = 0;
 uint32_t mock_dma_counter = 0;
 HAL_StatusTypeDef mock_hal_status = HAL_OK;
+uint8_t *mock_uart_rx_buf = NULL;
+uint16_t mock_uart_rx_size = 0;
+uint32_t mock_uart_rx_to_idle = 0;
+void (*mock_uart_tx_hook)(const uint8_t *data, uint16_t size) = NULL;
 static uint32_t mock_tick = 0;
 
 HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
 {
     (void)huart;
-    (void)pData;
-    (void)Size;
+    if (mock_uart_tx_hook != NULL && mock_hal_status == HAL_OK) {
+        mock_uart_tx_hook(pData, Size);
+    }
     return mock_hal_status;
 }
 
 HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
 {
     (void)huart;
-    (void)pData;
-    (void)Size;
+    mock_uart_rx_buf = pData;
+    mock_uart_rx_size = Size;
     return mock_hal_status;
 }
 
 HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
 {
     (void)huart;
-    (void)pData;
-    (void)Size;
+    mock_uart_rx_buf = pData;
+    mock_uart_rx_size = Size;
+    return mock_hal_status;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    (void)huart;
+    mock_uart_rx_buf = pData;
+    mock_uart_rx_size = Size;
+    mock_uart_rx_to_idle++;
     return mock_hal_status;
 }
 
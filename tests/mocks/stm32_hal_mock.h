@@ -30,6 +30,10 @@ typedef struct {
 HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
 void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
 HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
 HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart);
@@ -38,16 +42,24 @@ uint32_t HAL_GetTick(void);
 // Mock interrupt flags and DMA macros
 #define UART_FLAG_IDLE    0x10U
 #define UART_IT_IDLE      0x10U
+#define DMA_IT_HT         0x08U
 
 #define __HAL_UART_GET_FLAG(huart, flag) (mock_uart_flag_state)
 #define __HAL_UART_CLEAR_IDLEFLAG(huart) do { mock_uart_flag_state = 0; } while(0)
 #define __HAL_UART_ENABLE_IT(huart, it) do { /* mock */ } while(0)
 #define __HAL_DMA_GET_COUNTER(dma) (mock_dma_counter)
+#define __HAL_DMA_DISABLE_IT(dma, it) do { /* mock */ } while(0)
 #define __HAL_RCC_DMA1_CLK_ENABLE() do { /* mock */ } while(0)
 
 // Mock variables for testing
 extern uint32_t mock_uart_flag_state;
 extern uint32_t mock_dma_counter;
 extern HAL_StatusTypeDef mock_hal_status;
+extern uint8_t *mock_uart_rx_buf;       // Buffer passed to the last receive call
+extern uint16_t mock_uart_rx_size;      // Size passed to the last receive call
+extern uint32_t mock_uart_rx_to_idle;   // Number of ReceiveToIdle DMA starts
+
+// Called from HAL_UART_Transmit_DMA(), e.g. to play the modem's reply
+extern void (*mock_uart_tx_hook)(const uint8_t *data, uint16_t size);
 
 #endif // STM32_HAL_MOCK_H
\ No newline at end of file
@@ -0,0 +1,194 @@
+/**
+ * @file test_it_batch.c
+ * @brief Tests for micro-batched interrupt-mode reception
+ *
+ * uat_freertos.c is built with UAT_USE_IT for this test. The test plays the
+ * UART by storing each byte where HAL_UART_Receive_IT() was pointed and
+ * raising HAL_UART_RxCpltCallback(), then checks how often the ISR wakes
+ * uAT_Task and what the task dispatches. uAT_Task is run for a single pass
+ * by leaving it with longjmp() when it blocks in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+static char last_args[128];
+static int handler_calls;
+
+static void csq_handler(const char *args)
+{
+    snprintf(last_args, sizeof(last_args), "%s", args);
+    handler_calls++;
+}
+
+// Receive data byte by byte, as the UART interrupt would
+static void uart_receive(const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        *mock_uart_rx_buf = (uint8_t)data[i];
+        HAL_UART_RxCpltCallback(&test_huart);
+    }
+}
+
+static void setup(void)
+{
+    task_harness_init();
+    uAT_RegisterCommand("+CSQ:", csq_handler);
+    handler_calls = 0;
+    last_args[0] = '\0';
+}
+
+void test_it_batch_lines(void)
+{
+    TEST_SUITE_START("ItBatch_Lines");
+
+    setup();
+    TEST_ASSERT_NOT_NULL(mock_uart_rx_buf, "Init should start IT reception");
+    TEST_ASSERT_EQUAL_INT(1, mock_uart_rx_size, "IT reception should be byte by byte");
+
+    const char *line = "+CSQ: 21,99\r";
+    uart_receive(line, strlen(line));
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(0, (int)mock_task_notify_count, "Partial line should not wake the task");
+    TEST_ASSERT_EQUAL_INT(0, handler_calls, "Partial line should stay staged");
+
+    uart_receive("\n", 1);
+    TEST_ASSERT_EQUAL_INT(1, (int)mock_task_notify_count, "Line end should wake the task once");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Line should be dispatched");
+    TEST_ASSERT_EQUAL_STRING("21,99\r\n", last_args, "First byte should not be lost");
+
+    const char *more = "+CSQ: 1,1\r\n+CSQ: 2,2\r\n";
+    uart_receive(more, strlen(more));
+    TEST_ASSERT_EQUAL_INT(3, (int)mock_task_notify_count, "One wake-up per line");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(3, handler_calls, "Both lines should be dispatched");
+
+    TEST_SUITE_END("ItBatch_Lines");
+}
+
+void test_it_batch_threshold(void)
+{
+    TEST_SUITE_START("ItBatch_Threshold");
+
+    setup();
+    char data[UAT_IT_BATCH_SIZE * 2 + 5];
+    memset(data, 'x', sizeof(data));
+    memcpy(data, "+CSQ: ", 6);
+    uart_receive(data, sizeof(data));
+    TEST_ASSERT_EQUAL_INT(0, (int)mock_task_notify_count, "Full stages should not wake the task");
+
+    // Line goes idle, the remainder must not wait for more bytes
+    TEST_ASSERT_TRUE(uAT_UART_IdleHandler(), "Idle handler should succeed");
+    TEST_ASSERT_EQUAL_INT(1, (int)mock_task_notify_count, "IDLE should wake the task");
+    TEST_ASSERT_TRUE(uAT_UART_IdleHandler(), "Idle with nothing staged should succeed");
+    TEST_ASSERT_EQUAL_INT(1, (int)mock_task_notify_count, "Empty stage should not wake the task");
+
+    uart_receive("\r\n", 2);
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Batched line should be dispatched once");
+    TEST_ASSERT_EQUAL_INT((int)sizeof(data) - 6 + 2, (int)strlen(last_args), "No staged byte should be lost");
+
+    TEST_SUITE_END("ItBatch_Threshold");
+}
+
+void test_it_batch_prompt(void)
+{
+    TEST_SUITE_START("ItBatch_Prompt");
+
+    setup();
+    uart_receive("\r\n> ", 4);
+    TEST_ASSERT_EQUAL_INT(2, (int)mock_task_notify_count, "Prompt should wake the task without a terminator");
+
+    TEST_SUITE_END("ItBatch_Prompt");
+}
+
+void test_it_batch_resync(void)
+{
+    TEST_SUITE_START("ItBatch_Resync");
+
+    setup();
+    uAT_RxStats_t stats;
+    char line[16];
+
+    // 11-byte lines, the ring fills up in the middle of line 46
+    for (int i = 0; i < 50; i++)
+    {
+        snprintf(line, sizeof(line), "+CSQ: %03d\r\n", i);
+        uart_receive(line, strlen(line));
+    }
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(UAT_RX_RING_SIZE / 11, handler_calls, "Lines before the loss should be dispatched");
+
+    // Parsing resumes with the next line, not with a joined fragment
+    uart_receive("+CSQ: 999\r\n", 11);
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(UAT_RX_RING_SIZE / 11 + 1, handler_calls, "Next line should not be lost");
+    TEST_ASSERT_EQUAL_STRING("999\r\n", last_args, "Cut line should not reach a handler");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.resyncs, "Resync should be counted once");
+
+    // Loss in the middle of a line that goes on in the next receive
+    static char data[UAT_RX_RING_SIZE + 8];
+    memset(data, 'x', sizeof(data));
+    memcpy(data, "+CSQ: ", 6);
+    uart_receive(data, sizeof(data));
+    uAT_UART_IdleHandler();
+    run_task_once();
+    handler_calls = 0;
+    const char *rest = "+CSQ: 7\r\n+CSQ: 1000\r\n";
+    uart_receive(rest, strlen(rest));
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Rest of the cut line should be dropped");
+    TEST_ASSERT_EQUAL_STRING("1000\r\n", last_args, "Next whole line should be dispatched");
+
+    TEST_SUITE_END("ItBatch_Resync");
+}
+
+void test_it_batch_stats(void)
+{
+    TEST_SUITE_START("ItBatch_Stats");
+
+    setup();
+    uAT_RxStats_t stats;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetRxStats(NULL), "Should reject NULL");
+
+    // Task does not run while more than the ring holds arrives
+    static char data[UAT_RX_RING_SIZE + 88];
+    memset(data, 'x', sizeof(data));
+    memcpy(data, "+CSQ: ", 6);
+    uart_receive(data, sizeof(data));
+    uAT_UART_IdleHandler();
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT((int)sizeof(data), (int)stats.bytesReceived, "All received bytes should be counted");
+    TEST_ASSERT_EQUAL_INT(88, (int)stats.bytesDropped, "Bytes beyond a full ring should be counted");
+    TEST_ASSERT_EQUAL_INT(UAT_RX_RING_SIZE, (int)stats.rxHighWater, "High-water mark should reach the ring size");
+
+    // Line is longer than the line buffer and is handed over in pieces
+    run_task_once();
+    uart_receive("\r\n", 2);
+    run_task_once();
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.linesTruncated, "Over-length line should be counted once");
+    TEST_ASSERT_EQUAL_INT((int)sizeof(data) + 2, (int)stats.bytesReceived, "Counters should keep running");
+
+    TEST_SUITE_END("ItBatch_Stats");
+}
+
+int main(void)
+{
+    printf("=== uAT Interrupt Mode Batching Tests ===\n");
+    test_framework_init();
+
+    test_it_batch_lines();
+    test_it_batch_threshold();
+    test_it_batch_prompt();
+    test_it_batch_resync();
+    test_it_batch_stats();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,256 @@
+/**
+ * @file test_line.c
+ * @brief Tests for the uAT line assembler
+ *
+ * This file contains unit tests for the block-oriented line assembler.
+ * Tests cover block and partial delivery, resuming across calls, buffer
+ * compaction, over-length lines, resync after lost data and unterminated
+ * prompts.
+ */
+
+#include "test_framework.h"
+#include "uat_line.h"
+#include <stdio.h>
+#include <string.h>
+
+// Copy the next line into out as a null-terminated string
+static bool next_line(uAT_LineAssembler_t *la, char *out, size_t outSize)
+{
+    const char *line;
+    size_t len;
+
+    if (!uAT_Line_Next(la, &line, &len) || len >= outSize)
+    {
+        return false;
+    }
+    memcpy(out, line, len);
+    out[len] = '\0';
+    return true;
+}
+
+void test_uAT_Line_Block(void)
+{
+    TEST_SUITE_START("uAT_Line_Block");
+
+    char buf[64];
+    char out[64];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+
+    // Several lines in one block
+    const char *block = "+CREG: 1,5\r\nOK\r\n";
+    TEST_ASSERT_TRUE(uAT_Line_Write(&la, block, strlen(block)) == strlen(block), "Should accept the whole block");
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the first line");
+    TEST_ASSERT_EQUAL_STRING("+CREG: 1,5\r\n", out, "First line should include terminator");
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the second line");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Second line should be OK");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should have no more lines");
+    TEST_ASSERT_TRUE(uAT_Line_Pending(&la) == 0, "Nothing should be pending");
+
+    // Empty line is still a complete line
+    uAT_Line_Write(&la, "\r\n", 2);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return an empty line");
+    TEST_ASSERT_EQUAL_STRING("\r\n", out, "Empty line should be the terminator only");
+
+    // Argument validation
+    TEST_ASSERT_FALSE(uAT_Line_Next(NULL, NULL, NULL), "Should handle null arguments");
+    TEST_ASSERT_TRUE(uAT_Line_Write(NULL, "x", 1) == 0, "Should reject null assembler");
+
+    TEST_SUITE_END("uAT_Line_Block");
+}
+
+void test_uAT_Line_Partial(void)
+{
+    TEST_SUITE_START("uAT_Line_Partial");
+
+    char buf[64];
+    char out[64];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+
+    // A partial line is never returned, even across several calls
+    uAT_Line_Write(&la, "+CSQ: 2", 7);
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should not return a partial line");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should still not return it when called again");
+    TEST_ASSERT_TRUE(uAT_Line_Pending(&la) == 7, "Partial line should stay buffered");
+
+    // Terminator split across writes
+    uAT_Line_Write(&la, "1,99\r", 5);
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should wait for the complete terminator");
+    uAT_Line_Write(&la, "\nOK", 3);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the line once terminated");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\n", out, "Fragments should be joined");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Trailing fragment should wait");
+
+    // A lone LF or CR is not a terminator
+    uAT_Line_Reset(&la);
+    uAT_Line_Write(&la, "A\nB\rC\r\n", 7);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should find the CRLF");
+    TEST_ASSERT_EQUAL_STRING("A\nB\rC\r\n", out, "Bare CR and LF should stay in the line");
+
+    // Reset drops the partial line
+    uAT_Line_Write(&la, "garbage", 7);
+    uAT_Line_Reset(&la);
+    uAT_Line_Write(&la, "OK\r\n", 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return a line after reset");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Partial line should be discarded by reset");
+
+    TEST_SUITE_END("uAT_Line_Partial");
+}
+
+void test_uAT_Line_Compaction(void)
+{
+    TEST_SUITE_START("uAT_Line_Compaction");
+
+    char buf[16];
+    char out[32];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+
+    // Fill the tail so the partial line has to move to the front
+    uAT_Line_Write(&la, "0123456789\r\nABCD", 16);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the first line");
+    TEST_ASSERT_EQUAL_STRING("0123456789\r\n", out, "First line should be complete");
+
+    size_t space;
+    uAT_Line_WritePtr(&la, &space);
+    TEST_ASSERT_TRUE(space == 12, "Compaction should free the consumed bytes");
+    TEST_ASSERT_TRUE(uAT_Line_Write(&la, "EF\r\n", 4) == 4, "Should accept more data after compaction");
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the moved line");
+    TEST_ASSERT_EQUAL_STRING("ABCDEF\r\n", out, "Moved line should be intact");
+
+    // Direct writes through WritePtr/Commit
+    char *dst = uAT_Line_WritePtr(&la, &space);
+    TEST_ASSERT_TRUE(space == sizeof(buf), "Empty assembler should offer the whole buffer");
+    memcpy(dst, "OK\r\n", 4);
+    uAT_Line_Commit(&la, 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return committed line");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Committed line should match");
+
+    TEST_SUITE_END("uAT_Line_Compaction");
+}
+
+void test_uAT_Line_Overlength(void)
+{
+    TEST_SUITE_START("uAT_Line_Overlength");
+
+    char buf[8];
+    char out[32];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+
+    // A line longer than the buffer is dropped up to its terminator
+    TEST_ASSERT_TRUE(uAT_Line_Write(&la, "0123456789\r\n", 12) == 8, "Should only accept buffer size");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should not return a piece of the line");
+    TEST_ASSERT_EQUAL_INT(1, (int)la.overLength, "Over-length line should be counted");
+    TEST_ASSERT_TRUE(uAT_Line_Write(&la, "89\r\n", 4) == 4, "Should accept the rest");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Rest of the long line should not be returned");
+    uAT_Line_Write(&la, "OK\r\n", 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the next line");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Rest of the long line should be dropped");
+
+    // Terminator split right at the end of the full buffer
+    uAT_Line_Write(&la, "0123456\r", 8);
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should drop the full buffer");
+    uAT_Line_Write(&la, "\nOK\r\n", 5);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Split terminator should end the dropped line");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Line after the split terminator");
+    TEST_ASSERT_EQUAL_INT(2, (int)la.overLength, "Both over-length lines should be counted");
+
+    // Single-character terminator
+    uAT_Line_Init(&la, buf, sizeof(buf), "\n");
+    uAT_Line_Write(&la, "a\nb\n", 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should split on LF");
+    TEST_ASSERT_EQUAL_STRING("a\n", out, "First LF line");
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should split on second LF");
+    TEST_ASSERT_EQUAL_STRING("b\n", out, "Second LF line");
+
+    TEST_SUITE_END("uAT_Line_Overlength");
+}
+
+void test_uAT_Line_Resync(void)
+{
+    TEST_SUITE_START("uAT_Line_Resync");
+
+    char buf[32];
+    char out[32];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+    uAT_Line_SetPrompt(&la, "> ");
+
+    // Data was lost after "+CR", the modem went on with "EG: 1,5"
+    uAT_Line_Write(&la, "OK\r\n+CR", 7);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Line before the loss should be returned");
+    uAT_Line_Resync(&la);
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Line_Pending(&la), "Partial line should be dropped");
+    uAT_Line_Write(&la, "EG: 1,5\r\n+CSQ: 9,9\r\n", 20);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Parsing should resume after the terminator");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 9,9\r\n", out, "Fragment should never be returned");
+
+    // A prompt is not mistaken for the end of a dropped line
+    uAT_Line_Resync(&la);
+    uAT_Line_Write(&la, "> ", 2);
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Prompt should be discarded while resyncing");
+    uAT_Line_Write(&la, "\r\nOK\r\n", 6);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should resync on the terminator");
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", out, "Line after resync");
+
+    // Reset leaves the resync state
+    uAT_Line_Resync(&la);
+    uAT_Line_Reset(&la);
+    uAT_Line_Write(&la, "OK\r\n", 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Reset should end the resync");
+
+    TEST_SUITE_END("uAT_Line_Resync");
+}
+
+void test_uAT_Line_Prompt(void)
+{
+    TEST_SUITE_START("uAT_Line_Prompt");
+
+    char buf[32];
+    char out[32];
+    uAT_LineAssembler_t la;
+    uAT_Line_Init(&la, buf, sizeof(buf), "\r\n");
+
+    // Without a prompt configured "> " is just a partial line
+    uAT_Line_Write(&la, "\r\n> ", 4);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the empty line");
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should hold back the prompt");
+
+    // Once configured the prompt is returned without a terminator
+    uAT_Line_SetPrompt(&la, "> ");
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the prompt");
+    TEST_ASSERT_EQUAL_STRING("> ", out, "Prompt should be returned as is");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Line_Pending(&la), "Nothing should be pending");
+
+    // A prompt split across writes is returned once complete
+    uAT_Line_Write(&la, ">", 1);
+    TEST_ASSERT_FALSE(next_line(&la, out, sizeof(out)), "Should wait for the rest of the prompt");
+    uAT_Line_Write(&la, " ", 1);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the completed prompt");
+    TEST_ASSERT_EQUAL_STRING("> ", out, "Completed prompt");
+
+    // A line that merely starts like a prompt is not cut short
+    uAT_Line_Write(&la, "> x\r\n", 5);
+    TEST_ASSERT_TRUE(next_line(&la, out, sizeof(out)), "Should return the line");
+    TEST_ASSERT_EQUAL_STRING("> x\r\n", out, "Line should be intact");
+
+    TEST_SUITE_END("uAT_Line_Prompt");
+}
+
+int main(void)
+{
+    printf("=== uAT Line Assembler Tests ===\n");
+    test_framework_init();
+
+    test_uAT_Line_Block();
+    test_uAT_Line_Partial();
+    test_uAT_Line_Compaction();
+    test_uAT_Line_Overlength();
+    test_uAT_Line_Resync();
+    test_uAT_Line_Prompt();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
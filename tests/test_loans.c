@@ -0,0 +1,163 @@
+/**
+ * @file test_loans.c
+ * @brief Tests for lending responses from the response pool
+ *
+ * uat_freertos.c is built with UAT_RESP_POOL=2 and UAT_RESP_BUF_SIZE=128 (and
+ * UAT_DMA_RX_EVENT to feed it data) for this test. uAT_Task is run for a
+ * single pass after each receive by leaving it with longjmp() when it blocks
+ * in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+// The modem's reply to the command just sent
+static const char *reply;
+
+static void modem_reply(const uint8_t *data, uint16_t size)
+{
+    (void)data;
+    (void)size;
+    receive(reply);
+}
+
+static void setup(void)
+{
+    task_harness_init();
+}
+
+typedef struct
+{
+    int calls;
+    uAT_ResponseLoan_t loan;
+} loan_record_t;
+
+static void loan_done(uAT_TxnHandle_t handle, const uAT_TxnResult_t *result, void *ctx)
+{
+    (void)handle;
+    loan_record_t *rec = ctx;
+    rec->calls++;
+    rec->loan = result->loan;
+}
+
+void test_loans_send_receive(void)
+{
+    TEST_SUITE_START("Loans_SendReceive");
+
+    setup();
+    uAT_ResponseLoan_t first;
+    uAT_ResponseLoan_t second;
+    uAT_ResponseLoan_t third;
+
+    mock_uart_tx_hook = modem_reply;
+    reply = "+CSQ: 21,99\r\nOK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceiveLoan("AT+CSQ", "OK", &first, 100), "Loan should succeed");
+    TEST_ASSERT_EQUAL_INT(2, (int)first.count, "Every line up to the expected one should be lent");
+    TEST_ASSERT_TRUE(first.count == 2 && first.lines[0].len == 11 && strcmp(first.lines[0].text, "+CSQ: 21,99") == 0,
+                     "Line views should hold the text without terminator");
+    TEST_ASSERT_TRUE(first.count == 2 && strcmp(first.lines[1].text, "OK") == 0, "Expected line should end the loan");
+
+    // Without an expected line any final result code ends the response
+    reply = "+CME ERROR: 10\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceiveLoan("AT+CPIN?", NULL, &second, 100), "Final result code should end the loan");
+    TEST_ASSERT_TRUE(second.lines != NULL && second.lines != first.lines, "Second loan should get the other buffer");
+    TEST_ASSERT_EQUAL_INT(1, (int)second.count, "Final line alone should be lent");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_SendReceiveLoan("AT", "OK", &third, 100), "Empty pool should be reported");
+    TEST_ASSERT_NULL(third.lines, "Nothing should be lent from an empty pool");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_ReleaseResponse(&first), "Loan should be released");
+    TEST_ASSERT_NULL(first.lines, "Released loan should be cleared");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_ReleaseResponse(&first), "Released loan should not be released again");
+
+    reply = "ERROR\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESPONSE, uAT_SendReceiveLoan("AT+X", "OK", &third, 100), "Other final result code should be reported");
+    TEST_ASSERT_TRUE(third.count == 1 && strcmp(third.lines[0].text, "ERROR") == 0, "Response should still be lent");
+    uAT_ReleaseResponse(&second);
+    uAT_ReleaseResponse(&third);
+
+    // Lines that do not fit are dropped whole
+    reply = "+QIRD: 0\r\n+QIRD: 1\r\n+QIRD: 2\r\n+QIRD: 3\r\n+QIRD: 4\r\n+QIRD: 5\r\n+QIRD: 6\r\nOK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_SendReceiveLoan("AT+QIRD", "OK", &first, 100), "Lines that do not fit should be reported");
+    TEST_ASSERT_TRUE(first.count > 0 && first.count < 8, "Lines should be lent until the buffer is full");
+    TEST_ASSERT_TRUE(first.count > 0 && strncmp(first.lines[first.count - 1].text, "+QIRD: ", 7) == 0, "Lines that fit should be kept");
+    uAT_ReleaseResponse(&first);
+
+    // Given up on, the buffer goes back to the pool
+    mock_uart_tx_hook = NULL;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_TIMEOUT, uAT_SendReceiveLoan("ATI", "OK", &first, 0), "Unanswered command should time out");
+    TEST_ASSERT_NULL(first.lines, "Nothing should be lent after a timeout");
+    mock_uart_tx_hook = modem_reply;
+    reply = "OK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceiveLoan("AT", "OK", &first, 100), "Pool should be whole again");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceiveLoan("AT", "OK", &second, 100), "Pool should be whole again");
+    uAT_ReleaseResponse(&first);
+    uAT_ReleaseResponse(&second);
+    mock_uart_tx_hook = NULL;
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_SendReceiveLoan("AT", "OK", NULL, 100), "NULL loan should be rejected");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_ReleaseResponse(NULL), "NULL loan should not be released");
+
+    TEST_SUITE_END("Loans_SendReceive");
+}
+
+void test_loans_txn(void)
+{
+    TEST_SUITE_START("Loans_Txn");
+
+    setup();
+    uAT_TxnRequest_t req = {.cmd = "AT+COPS?", .loan = true, .timeout = 100};
+    uAT_TxnHandle_t first;
+    uAT_TxnHandle_t second;
+    uAT_TxnResult_t res;
+
+    // Polled results carry the loan
+    uAT_TxnSubmit(&req, &first);
+    receive("+COPS: 0,0,\"Op\"\r\nOK\r\n");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(first, &res), "Finished transaction should be collected");
+    TEST_ASSERT_TRUE(res.loan.count == 2 && strcmp(res.loan.lines[0].text, "+COPS: 0,0,\"Op\"") == 0, "Result should carry the lent lines");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_ReleaseResponse(&res.loan), "Collected loan should be released");
+
+    // Callbacks own the loan they get
+    loan_record_t rec = {0};
+    req.onComplete = loan_done;
+    req.ctx = &rec;
+    uAT_TxnSubmit(&req, &first);
+    receive("ERROR\r\n");
+    TEST_ASSERT_TRUE(rec.calls == 1 && rec.loan.count == 1 && strcmp(rec.loan.lines[0].text, "ERROR") == 0, "Callback should get the lent lines");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_ReleaseResponse(&rec.loan), "Callback's loan should be released");
+
+    // Buffers of transactions nobody collects go back to the pool
+    req.onComplete = NULL;
+    uAT_TxnSubmit(&req, &first);
+    uAT_TxnSubmit(&req, &second);
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_TxnSubmit(&req, &first), "Empty pool should be reported");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnCancel(second), "Queued transaction should be cancelled");
+    receive("OK\r\n");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(first, NULL), "Result should be dropped when not collected");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&req, &first), "Dropped buffers should be lent again");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&req, &second), "Dropped buffers should be lent again");
+    uAT_TxnCancel(first);
+    uAT_TxnCancel(second);
+
+    char buf[16];
+    req.outBuf = buf;
+    req.bufLen = sizeof(buf);
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_TxnSubmit(&req, &first), "Loan with another sink should be rejected");
+
+    TEST_SUITE_END("Loans_Txn");
+}
+
+int main(void)
+{
+    printf("=== uAT Response Loan Tests ===\n");
+    test_framework_init();
+
+    test_loans_send_receive();
+    test_loans_txn();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,247 @@
+/**
+ * @file test_match.c
+ * @brief Tests for the uAT command dispatch trie
+ *
+ * This file contains unit tests for the prefix trie used to dispatch received
+ * lines. Tests cover insert, lookup and removal, finding nested prefixes of a
+ * line, sibling ordering, exhaustion of the node pool, and glob patterns.
+ */
+
+#include "test_framework.h"
+#include "uat_match.h"
+#include <stdio.h>
+#include <string.h>
+
+static uAT_MatchNode_t nodes[64];
+
+void test_uAT_Match_Init(void)
+{
+    TEST_SUITE_START("uAT_Match_Init");
+
+    uAT_Matcher_t m;
+
+    TEST_ASSERT_TRUE(uAT_Match_Init(&m, nodes, 64), "Should accept a valid pool");
+    TEST_ASSERT_EQUAL_INT(1, (int)m.used, "Only the root should be in use");
+    TEST_ASSERT_FALSE(uAT_Match_Init(&m, nodes, 1), "Should reject a pool without room for a prefix");
+    TEST_ASSERT_FALSE(uAT_Match_Init(&m, NULL, 64), "Should reject null pool");
+    TEST_ASSERT_FALSE(uAT_Match_Init(NULL, nodes, 64), "Should reject null matcher");
+
+    TEST_SUITE_END("uAT_Match_Init");
+}
+
+void test_uAT_Match_InsertRemove(void)
+{
+    TEST_SUITE_START("uAT_Match_InsertRemove");
+
+    uAT_Matcher_t m;
+    uAT_Match_Init(&m, nodes, 64);
+
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CSQ:", 5, 3), "Should insert a prefix");
+    TEST_ASSERT_EQUAL_INT(3, uAT_Match_Get(&m, "+CSQ:", 5), "Should get the stored value");
+    TEST_ASSERT_EQUAL_INT(UAT_MATCH_NONE, uAT_Match_Get(&m, "+CSQ", 4), "Inner node should have no value");
+    TEST_ASSERT_EQUAL_INT(UAT_MATCH_NONE, uAT_Match_Get(&m, "+CSQ: ", 6), "Longer key should have no value");
+    TEST_ASSERT_FALSE(uAT_Match_Insert(&m, "", 0, 1), "Should reject an empty prefix");
+    TEST_ASSERT_FALSE(uAT_Match_Insert(&m, "OK", 2, UAT_MATCH_NONE), "Should reject the reserved value");
+
+    size_t used = m.used;
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CSQ:", 5, 7), "Should replace a stored value");
+    TEST_ASSERT_EQUAL_INT(7, uAT_Match_Get(&m, "+CSQ:", 5), "Replaced value should be returned");
+    TEST_ASSERT_EQUAL_INT((int)used, (int)m.used, "Replacing should not take nodes");
+
+    TEST_ASSERT_TRUE(uAT_Match_Remove(&m, "+CSQ:", 5), "Should remove a stored prefix");
+    TEST_ASSERT_EQUAL_INT(UAT_MATCH_NONE, uAT_Match_Get(&m, "+CSQ:", 5), "Removed prefix should have no value");
+    TEST_ASSERT_FALSE(uAT_Match_Remove(&m, "+CSQ:", 5), "Second remove should fail");
+    TEST_ASSERT_FALSE(uAT_Match_Remove(&m, "+CS", 3), "Inner node should not be removable");
+
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CSQ:", 5, 1), "Should insert a removed prefix again");
+    TEST_ASSERT_EQUAL_INT((int)used, (int)m.used, "Reinserting should reuse the nodes");
+
+    TEST_SUITE_END("uAT_Match_InsertRemove");
+}
+
+void test_uAT_Match_Find(void)
+{
+    TEST_SUITE_START("uAT_Match_Find");
+
+    uAT_Matcher_t m;
+    uint16_t values[4];
+    uAT_Match_Init(&m, nodes, 64);
+
+    uAT_Match_Insert(&m, "+CREG:", 6, 2);
+    uAT_Match_Insert(&m, "+C", 2, 0);
+    uAT_Match_Insert(&m, "+CREG", 5, 1);
+    uAT_Match_Insert(&m, "OK", 2, 5);
+
+    const char *line = "+CREG: 0,1";
+    TEST_ASSERT_EQUAL_INT(3, (int)uAT_Match_Find(&m, line, strlen(line), values, 4), "Should find all nested prefixes");
+    TEST_ASSERT_EQUAL_INT(0, values[0], "Shortest prefix should come first");
+    TEST_ASSERT_EQUAL_INT(1, values[1], "Middle prefix should come second");
+    TEST_ASSERT_EQUAL_INT(2, values[2], "Longest prefix should come last");
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Match_Find(&m, line, strlen(line), values, 2), "Should stop at maxValues");
+
+    TEST_ASSERT_EQUAL_INT(1, (int)uAT_Match_Find(&m, "+CSQ: 21", 8, values, 4), "Should match only the common prefix");
+    TEST_ASSERT_EQUAL_INT(0, values[0], "Common prefix value should be returned");
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Match_Find(&m, "+CREG", 5, values, 4), "Line equal to a prefix should match it");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "+", 1, values, 4), "Shorter line should not match");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "ERROR", 5, values, 4), "Unknown line should not match");
+    TEST_ASSERT_EQUAL_INT(1, (int)uAT_Match_Find(&m, "OK", 2, values, 4), "Other first byte should match");
+    TEST_ASSERT_EQUAL_INT(5, values[0], "Other first byte should return its value");
+
+    uAT_Match_Remove(&m, "+CREG", 5);
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Match_Find(&m, line, strlen(line), values, 4), "Removed prefix should be skipped");
+    TEST_ASSERT_EQUAL_INT(2, values[1], "Longer prefix should still match below a removed one");
+
+    TEST_SUITE_END("uAT_Match_Find");
+}
+
+void test_uAT_Match_Siblings(void)
+{
+    TEST_SUITE_START("uAT_Match_Siblings");
+
+    uAT_Matcher_t m;
+    uint16_t values[2];
+    uAT_Match_Init(&m, nodes, 64);
+
+    // Insert out of order, including a byte above 0x7F
+    const char *keys[] = {"+Q", "+C", "+\xB0", "+A", "+Z"};
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        uAT_Match_Insert(&m, keys[i], 2, i);
+    }
+
+    // The sibling list under '+' is sorted by unsigned byte
+    uint16_t child = m.nodes[m.first['+']].child;
+    uint8_t prev = 0;
+    int sorted = 1;
+    int count = 0;
+    while (child != 0)
+    {
+        if ((uint8_t)m.nodes[child].c <= prev)
+        {
+            sorted = 0;
+        }
+        prev = (uint8_t)m.nodes[child].c;
+        child = m.nodes[child].sibling;
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(5, count, "All siblings should be linked");
+    TEST_ASSERT_TRUE(sorted, "Siblings should be sorted by byte");
+
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(1, (int)uAT_Match_Find(&m, keys[i], 2, values, 2), "Each sibling should be found");
+        TEST_ASSERT_EQUAL_INT(i, values[0], "Each sibling should return its value");
+    }
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "+B", 2, values, 2), "Missing sibling should not match");
+
+    TEST_SUITE_END("uAT_Match_Siblings");
+}
+
+void test_uAT_Match_Exhaustion(void)
+{
+    TEST_SUITE_START("uAT_Match_Exhaustion");
+
+    uAT_Matcher_t m;
+    uAT_MatchNode_t small[6];
+    uint16_t values[4];
+    uAT_Match_Init(&m, small, 6);
+
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CSQ", 4, 1), "Should fit in the pool");
+    TEST_ASSERT_FALSE(uAT_Match_Insert(&m, "+CREG", 5, 2), "Should fail when the pool is too small");
+    TEST_ASSERT_EQUAL_INT(5, (int)m.used, "Failed insert should take no nodes");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "+CREG", 5, values, 4), "Failed insert should leave no path");
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CSQ:", 5, 3), "Last node should still be usable");
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+C", 2, 4), "Existing path should take no nodes");
+
+    uAT_Match_Clear(&m);
+    TEST_ASSERT_EQUAL_INT(1, (int)m.used, "Clear should release all nodes");
+    TEST_ASSERT_EQUAL_INT(UAT_MATCH_NONE, uAT_Match_Get(&m, "+CSQ", 4), "Clear should remove all prefixes");
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+CREG", 5, 2), "Cleared pool should be reusable");
+
+    TEST_SUITE_END("uAT_Match_Exhaustion");
+}
+
+void test_uAT_Match_PatternSyntax(void)
+{
+    TEST_SUITE_START("uAT_Match_PatternSyntax");
+
+    TEST_ASSERT_TRUE(uAT_Match_PatternValid("+C?REG:", 7), "'?' should be valid");
+    TEST_ASSERT_TRUE(uAT_Match_PatternValid("+Q*URC", 6), "'*' should be valid");
+    TEST_ASSERT_TRUE(uAT_Match_PatternValid("+C[EG]REG", 9), "Class should be valid");
+    TEST_ASSERT_TRUE(uAT_Match_PatternValid("[]]", 3), "Leading ']' should be a class member");
+    TEST_ASSERT_TRUE(uAT_Match_PatternValid("AT\\?", 4), "Escaped '?' should be valid");
+    TEST_ASSERT_FALSE(uAT_Match_PatternValid("+C[EG", 5), "Unclosed class should be invalid");
+    TEST_ASSERT_FALSE(uAT_Match_PatternValid("AT\\", 3), "Trailing escape should be invalid");
+    TEST_ASSERT_FALSE(uAT_Match_PatternValid("", 0), "Empty pattern should be invalid");
+
+    TEST_SUITE_END("uAT_Match_PatternSyntax");
+}
+
+void test_uAT_Match_Patterns(void)
+{
+    TEST_SUITE_START("uAT_Match_Patterns");
+
+    uAT_Matcher_t m;
+    uint16_t values[8];
+    size_t ends[8];
+    size_t count;
+    uAT_Match_Init(&m, nodes, 64);
+
+    TEST_ASSERT_TRUE(uAT_Match_InsertPattern(&m, "+C?REG:", 7, 1), "Should insert a '?' pattern");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "+CREG: 1", 8, values, 8), "'?' should need one byte");
+    count = uAT_Match_FindEx(&m, "+CGREG: 1", 9, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 1 && ends[0] == 7, "'?' should match one byte");
+    count = uAT_Match_FindEx(&m, "+CEREG: 1", 9, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 1, "'?' should match any byte");
+
+    TEST_ASSERT_TRUE(uAT_Match_InsertPattern(&m, "+Q*URC", 6, 2), "Should insert a '*' pattern");
+    count = uAT_Match_FindEx(&m, "+QIURC: \"recv\"", 15, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 2 && ends[0] == 6, "'*' should match a run of bytes");
+    count = uAT_Match_FindEx(&m, "+QURC: x", 8, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 2 && ends[0] == 5, "'*' should match no bytes");
+    count = uAT_Match_FindEx(&m, "+QIURC: URC", 11, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 1 && ends[0] == 6, "Pattern should be reported once, at its shortest match");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "+QIND: 1", 8, values, 8), "'*' should still need the rest");
+
+    TEST_ASSERT_TRUE(uAT_Match_InsertPattern(&m, "+C[!G]REG", 9, 3), "Should insert a negated class");
+    TEST_ASSERT_TRUE(uAT_Match_InsertPattern(&m, "RIN[F-H]", 8, 4), "Should insert a range");
+    TEST_ASSERT_EQUAL_INT(1, (int)uAT_Match_Find(&m, "RING", 4, values, 8), "Range should match a member");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Match_Find(&m, "RINE", 4, values, 8), "Range should not match others");
+    count = uAT_Match_Find(&m, "+CEREG: 1", 9, values, 8);
+    TEST_ASSERT_EQUAL_INT(2, (int)count, "Line should match both patterns");
+    count = uAT_Match_Find(&m, "+CGREG: 1", 9, values, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 1, "Negated class should not match its member");
+
+    // Patterns share the trie with plain prefixes
+    TEST_ASSERT_TRUE(uAT_Match_Insert(&m, "+C", 2, 5), "Should insert a plain prefix");
+    count = uAT_Match_FindEx(&m, "+CGREG: 1", 9, values, ends, 8);
+    TEST_ASSERT_TRUE(count == 2 && values[0] == 5 && ends[0] == 2 && values[1] == 1, "Prefix and pattern should both match, shortest first");
+    TEST_ASSERT_TRUE(uAT_Match_InsertPattern(&m, "AT\\?", 4, 6), "Should insert an escaped pattern");
+    TEST_ASSERT_EQUAL_INT(6, uAT_Match_Get(&m, "AT?", 3), "Escaped byte should be a literal edge");
+
+    TEST_ASSERT_EQUAL_INT(1, uAT_Match_GetPattern(&m, "+C?REG:", 7), "Should get a pattern's value");
+    TEST_ASSERT_EQUAL_INT(UAT_MATCH_NONE, uAT_Match_Get(&m, "+C?REG:", 7), "Pattern should not be a literal");
+    TEST_ASSERT_TRUE(uAT_Match_RemovePattern(&m, "+C?REG:", 7), "Should remove a pattern");
+    count = uAT_Match_Find(&m, "+CGREG: 1", 9, values, 8);
+    TEST_ASSERT_TRUE(count == 1 && values[0] == 5, "Removed pattern should no longer match");
+    TEST_ASSERT_FALSE(uAT_Match_InsertPattern(&m, "+C[", 3, 7), "Should reject an invalid pattern");
+
+    TEST_SUITE_END("uAT_Match_Patterns");
+}
+
+int main(void)
+{
+    printf("=== uAT Dispatch Trie Tests ===\n");
+    test_framework_init();
+
+    test_uAT_Match_Init();
+    test_uAT_Match_InsertRemove();
+    test_uAT_Match_Find();
+    test_uAT_Match_Siblings();
+    test_uAT_Match_Exhaustion();
+    test_uAT_Match_PatternSyntax();
+    test_uAT_Match_Patterns();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
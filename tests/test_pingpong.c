@@ -0,0 +1,184 @@
+/**
+ * @file test_pingpong.c
+ * @brief Tests for ping-pong double-buffered DMA reception
+ *
+ * uat_freertos.c is built with UAT_DMA_PINGPONG for this test. The test plays
+ * the DMA controller by writing into the half HAL was last pointed at and
+ * raising HAL_UARTEx_RxEventCallback(). uAT_Task is run for a single pass by
+ * leaving it with longjmp() when it blocks in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+#define HALF (UAT_DMA_RX_SIZE / 2)
+
+static char last_args[64];
+static int handler_calls;
+
+static void csq_handler(const char *args)
+{
+    snprintf(last_args, sizeof(last_args), "%s", args);
+    handler_calls++;
+}
+
+// DMA receives data into the active half, then the line goes idle
+static void dma_receive(const char *data)
+{
+    size_t len = strlen(data);
+    memcpy(mock_uart_rx_buf, data, len);
+    HAL_UARTEx_RxEventCallback(&test_huart, (uint16_t)len);
+}
+
+static uint8_t *setup(void)
+{
+    task_harness_init();
+    uAT_RegisterCommand("+CSQ:", csq_handler);
+    handler_calls = 0;
+    last_args[0] = '\0';
+    return mock_uart_rx_buf;
+}
+
+void test_pingpong_handover(void)
+{
+    TEST_SUITE_START("PingPong_Handover");
+
+    uint8_t *first = setup();
+    TEST_ASSERT_NOT_NULL(first, "Init should start ReceiveToIdle DMA");
+    TEST_ASSERT_EQUAL_INT(HALF, mock_uart_rx_size, "Each transfer should fill one half");
+
+    dma_receive("+CSQ: 21,99\r\n");
+    TEST_ASSERT_TRUE(mock_uart_rx_buf == first + HALF, "DMA should continue on the other half");
+    TEST_ASSERT_EQUAL_INT(1, (int)mock_task_notify_count, "Handover should wake the task");
+
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Handler should be called once");
+    TEST_ASSERT_EQUAL_STRING("21,99\r\n", last_args, "Handler should get the arguments");
+
+    dma_receive("+CSQ: 15,99\r\n");
+    TEST_ASSERT_TRUE(mock_uart_rx_buf == first, "DMA should return to the first half");
+    run_task_once();
+    TEST_ASSERT_EQUAL_STRING("15,99\r\n", last_args, "Second half should be parsed");
+    uAT_RxStats_t stats;
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.dmaOverruns, "Nothing should be dropped");
+    TEST_ASSERT_EQUAL_INT(26, (int)stats.bytesReceived, "Both blocks should be counted");
+
+    TEST_SUITE_END("PingPong_Handover");
+}
+
+void test_pingpong_split_line(void)
+{
+    TEST_SUITE_START("PingPong_SplitLine");
+
+    setup();
+    dma_receive("+CSQ: 1");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(0, handler_calls, "Partial line should wait for the rest");
+    dma_receive("0,99\r\n");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Line across both halves should be dispatched once");
+    TEST_ASSERT_EQUAL_STRING("10,99\r\n", last_args, "Line should be joined in order");
+
+    TEST_SUITE_END("PingPong_SplitLine");
+}
+
+void test_pingpong_overflow(void)
+{
+    TEST_SUITE_START("PingPong_Overflow");
+
+    uAT_RxStats_t stats;
+    uint8_t *first = setup();
+    dma_receive("+CSQ: 1,1\r\n");
+    dma_receive("+CSQ: 2,2\r\n"); // Task has not run yet, first half is still owned by it
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaOverruns, "Drop should be counted");
+    TEST_ASSERT_EQUAL_INT(11, (int)stats.bytesDropped, "Dropped bytes should be counted");
+    TEST_ASSERT_TRUE(mock_uart_rx_buf == first + HALF, "DMA should refill the same half");
+    TEST_ASSERT_TRUE(memcmp(first, "+CSQ: 1,1\r\n", 11) == 0, "Unparsed half should not be overwritten");
+
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Only the kept half should be parsed");
+    TEST_ASSERT_EQUAL_STRING("1,1\r\n", last_args, "Kept half should be intact");
+
+    dma_receive("+CSQ: 3,3\r\n");
+    TEST_ASSERT_TRUE(mock_uart_rx_buf == first, "Handover should resume once the task caught up");
+    run_task_once();
+    TEST_ASSERT_EQUAL_STRING("3,3\r\n", last_args, "Reception should continue after an overflow");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaOverruns, "No further drops");
+
+    TEST_SUITE_END("PingPong_Overflow");
+}
+
+void test_pingpong_resync(void)
+{
+    TEST_SUITE_START("PingPong_Resync");
+
+    uAT_RxStats_t stats;
+    setup();
+    dma_receive("+CSQ: 1,1\r\n+CSQ: 2");
+    dma_receive(",2\r\n+CS"); // Dropped in the middle of a line
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Line before the loss should be parsed");
+
+    dma_receive("Q: 3,3\r\n+CSQ: 4,4\r\n");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(2, handler_calls, "Only the line after the cut one should be parsed");
+    TEST_ASSERT_EQUAL_STRING("4,4\r\n", last_args, "No fragment should reach a handler");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.resyncs, "Resync should be counted");
+
+    TEST_SUITE_END("PingPong_Resync");
+}
+
+void test_pingpong_restart(void)
+{
+    TEST_SUITE_START("PingPong_Restart");
+
+    uAT_RxStats_t stats;
+    uint8_t *first = setup();
+    mock_hal_status = HAL_ERROR;
+    dma_receive("+CSQ: 1,1\r\n+CSQ: 2");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaRestartFailures, "Failed restart should be counted");
+    TEST_ASSERT_EQUAL_INT(2, (int)mock_task_notify_count, "Failed restart should wake the task after the handover");
+
+    uint32_t starts = mock_uart_rx_to_idle;
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(1, handler_calls, "Data handed over before the failure should be parsed");
+    TEST_ASSERT_EQUAL_INT((int)starts + 1, (int)mock_uart_rx_to_idle, "Task should retry the restart");
+
+    mock_hal_status = HAL_OK;
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT((int)starts + 2, (int)mock_uart_rx_to_idle, "Task should retry until the restart works");
+    TEST_ASSERT_TRUE(mock_uart_rx_buf == first + HALF, "DMA should restart on the other half");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT((int)starts + 2, (int)mock_uart_rx_to_idle, "Task should stop retrying once restarted");
+
+    dma_receive(",2\r\n+CSQ: 3,3\r\n");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(2, handler_calls, "Line cut while stopped should be dropped");
+    TEST_ASSERT_EQUAL_STRING("3,3\r\n", last_args, "Reception should continue after the restart");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaRestartFailures, "Retries should not be counted as failures");
+
+    TEST_SUITE_END("PingPong_Restart");
+}
+
+int main(void)
+{
+    printf("=== uAT Ping-Pong DMA Tests ===\n");
+    test_framework_init();
+
+    test_pingpong_handover();
+    test_pingpong_split_line();
+    test_pingpong_overflow();
+    test_pingpong_resync();
+    test_pingpong_restart();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
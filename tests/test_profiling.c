@@ -0,0 +1,187 @@
+/**
+ * @file test_profiling.c
+ * @brief Tests for handler dispatch statistics
+ *
+ * uat_freertos.c is built with UAT_ENABLE_PROFILING and UAT_URC_TASK (and
+ * UAT_DMA_RX_EVENT to feed it data) for this test. Handler times come from
+ * CLOCK_MONOTONIC in nanoseconds. uAT_Task and uAT_URCTask are each run for
+ * a single pass by leaving them with longjmp() when they block in
+ * xTaskNotifyWait().
+ */
+
+// clock_gettime() under -std=c11
+#define _POSIX_C_SOURCE 199309L
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SLOW_NS 200000u
+
+static int fast_calls;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void fast_handler(const char *args)
+{
+    (void)args;
+    fast_calls++;
+}
+
+// Busy for at least SLOW_NS
+static void slow_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)args;
+    (void)len;
+    (void)ctx;
+    (void)tick;
+    uint64_t start = now_ns();
+    while (now_ns() - start < SLOW_NS)
+    {
+    }
+}
+
+static void run_urc_task_once(void)
+{
+    run_handler_task_once(uAT_URCTask, NULL);
+}
+
+static void setup(void)
+{
+    fast_calls = 0;
+    task_harness_init();
+}
+
+static const uAT_HandlerStats_t *find_stats(const uAT_HandlerStats_t *stats, size_t count, const char *command)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(stats[i].command, command) == 0)
+        {
+            return &stats[i];
+        }
+    }
+    return NULL;
+}
+
+void test_profiling_handlers(void)
+{
+    TEST_SUITE_START("Profiling_Handlers");
+
+    setup();
+    uAT_HandlerStats_t stats[UAT_MAX_CMD_HANDLERS];
+    size_t count = 99;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_GetHandlerStats(stats, UAT_MAX_CMD_HANDLERS, &count), "Should read empty statistics");
+    TEST_ASSERT_EQUAL_INT(0, (int)count, "No handler should be listed before a call");
+
+    uAT_RegisterCommand("+CSQ:", fast_handler);
+    uAT_RegisterCommandEx("+QIRD:", slow_handler, NULL);
+    uAT_RegisterCommand("+CREG:", fast_handler);
+
+    receive("+CSQ: 21,99\r\n+CSQ: 20,99\r\n+CSQ: 19,99\r\n+QIRD: 5\r\n");
+    TEST_ASSERT_EQUAL_INT(3, fast_calls, "Handlers should still run");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_GetHandlerStats(stats, UAT_MAX_CMD_HANDLERS, &count), "Should read statistics");
+    TEST_ASSERT_EQUAL_INT(2, (int)count, "Only called handlers should be listed");
+
+    const uAT_HandlerStats_t *csq = find_stats(stats, count, "+CSQ:");
+    TEST_ASSERT_NOT_NULL(csq, "+CSQ: should be listed");
+    TEST_ASSERT_EQUAL_INT(3, (int)csq->hits, "Every call should be counted");
+    TEST_ASSERT_TRUE(csq->totalTime >= csq->maxTime, "Total should include the longest call");
+
+    const uAT_HandlerStats_t *qird = find_stats(stats, count, "+QIRD:");
+    TEST_ASSERT_NOT_NULL(qird, "+QIRD: should be listed");
+    TEST_ASSERT_EQUAL_INT(1, (int)qird->hits, "Extended handler call should be counted");
+    TEST_ASSERT_TRUE(qird->lastTime >= SLOW_NS, "Call time should cover the handler");
+    TEST_ASSERT_TRUE(qird->maxTime == qird->lastTime, "Single call should be the longest");
+    TEST_ASSERT_TRUE(qird->totalTime == qird->lastTime, "Single call should be the total");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_GetHandlerStats(stats, 1, &count), "Short array should be reported");
+    TEST_ASSERT_EQUAL_INT(1, (int)count, "Short array should still be filled");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetHandlerStats(NULL, 1, &count), "NULL stats should be rejected");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetHandlerStats(stats, 1, NULL), "NULL count should be rejected");
+
+    TEST_SUITE_END("Profiling_Handlers");
+}
+
+void test_profiling_slots(void)
+{
+    TEST_SUITE_START("Profiling_Slots");
+
+    setup();
+    uAT_HandlerStats_t stats[UAT_MAX_CMD_HANDLERS];
+    size_t count = 0;
+
+    // URCs are timed in uAT_URCTask
+    uAT_RegisterURCEx("RING", slow_handler, NULL);
+    receive("RING\r\n");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_GetHandlerStats(stats, UAT_MAX_CMD_HANDLERS, &count), "Should read statistics");
+    TEST_ASSERT_EQUAL_INT(0, (int)count, "Queued URC should not be counted yet");
+    run_urc_task_once();
+    uAT_GetHandlerStats(stats, UAT_MAX_CMD_HANDLERS, &count);
+    TEST_ASSERT_EQUAL_INT(1, (int)count, "URC should be listed once run");
+    TEST_ASSERT_TRUE(count == 1 && stats[0].hits == 1 && stats[0].lastTime >= SLOW_NS, "URC call should be timed");
+
+    // A new command in the freed slot starts from zero
+    uAT_UnregisterCommand("RING");
+    uAT_RegisterCommand("+CSQ:", fast_handler);
+    receive("+CSQ: 21,99\r\n");
+    uAT_GetHandlerStats(stats, UAT_MAX_CMD_HANDLERS, &count);
+    TEST_ASSERT_EQUAL_INT(1, (int)count, "Reused slot should be listed once");
+    TEST_ASSERT_EQUAL_STRING("+CSQ:", stats[0].command, "Reused slot should show the new command");
+    TEST_ASSERT_EQUAL_INT(1, (int)stats[0].hits, "Reused slot should start over");
+    TEST_ASSERT_TRUE(stats[0].maxTime < SLOW_NS, "Reused slot should forget the old times");
+
+    TEST_SUITE_END("Profiling_Slots");
+}
+
+void test_profiling_unmatched(void)
+{
+    TEST_SUITE_START("Profiling_Unmatched");
+
+    setup();
+    uAT_UnmatchedStats_t stats;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_GetUnmatchedStats(&stats), "Should read empty statistics");
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.lines, "No line should be counted yet");
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.kept, "No prefix should be kept yet");
+
+    uAT_RegisterCommand("+CSQ:", fast_handler);
+    receive("OK\r\n+CSQ: 21,99\r\n+CGREG: 0,1,\"2E4F\",\"0B1C2D3E\"\r\n");
+    uAT_GetUnmatchedStats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, (int)stats.lines, "Only unmatched lines should be counted");
+    TEST_ASSERT_EQUAL_INT(2, (int)stats.kept, "Both prefixes should be kept");
+    TEST_ASSERT_EQUAL_STRING("+CGREG: 0,1,", stats.prefixes[0], "Newest prefix should come first, cut to length");
+    TEST_ASSERT_EQUAL_STRING("OK", stats.prefixes[1], "Prefix should stop at the terminator");
+
+    // Older prefixes make room for newer ones
+    receive("A\r\nB\r\nC\r\nD\r\n");
+    uAT_GetUnmatchedStats(&stats);
+    TEST_ASSERT_EQUAL_INT(6, (int)stats.lines, "Every unmatched line should be counted");
+    TEST_ASSERT_EQUAL_INT(UAT_PROFILE_UNMATCHED, (int)stats.kept, "Kept prefixes should be bounded");
+    TEST_ASSERT_EQUAL_STRING("D", stats.prefixes[0], "Newest prefix should come first");
+    TEST_ASSERT_EQUAL_STRING("A", stats.prefixes[UAT_PROFILE_UNMATCHED - 1], "Oldest kept prefix should come last");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetUnmatchedStats(NULL), "NULL stats should be rejected");
+
+    TEST_SUITE_END("Profiling_Unmatched");
+}
+
+int main(void)
+{
+    printf("=== uAT Profiling Tests ===\n");
+    test_framework_init();
+
+    test_profiling_handlers();
+    test_profiling_slots();
+    test_profiling_unmatched();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
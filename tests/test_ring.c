@@ -0,0 +1,200 @@
+/**
+ * @file test_ring.c
+ * @brief Tests for the uAT SPSC receive ring
+ *
+ * This file contains unit tests for the lock-free single-producer/single-consumer
+ * ring. Tests cover the copy and span APIs, wrap-around of the buffer and of
+ * the free-running indices, and a two-thread stress run checking that no byte
+ * is lost or reordered.
+ */
+
+#include "test_framework.h"
+#include "uat_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+void test_uAT_Ring_Init(void)
+{
+    TEST_SUITE_START("uAT_Ring_Init");
+
+    uAT_Ring_t ring;
+    uint8_t buf[16];
+
+    TEST_ASSERT_TRUE(uAT_Ring_Init(&ring, buf, sizeof(buf)), "Should accept a power of two");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Used(&ring), "New ring should be empty");
+    TEST_ASSERT_EQUAL_INT(16, (int)uAT_Ring_Free(&ring), "Whole buffer should be usable");
+    TEST_ASSERT_FALSE(uAT_Ring_Init(&ring, buf, 12), "Should reject a size that is not a power of two");
+    TEST_ASSERT_FALSE(uAT_Ring_Init(&ring, buf, 0), "Should reject zero size");
+    TEST_ASSERT_FALSE(uAT_Ring_Init(&ring, NULL, 16), "Should reject null storage");
+    TEST_ASSERT_FALSE(uAT_Ring_Init(NULL, buf, 16), "Should reject null ring");
+
+    TEST_SUITE_END("uAT_Ring_Init");
+}
+
+void test_uAT_Ring_Copy(void)
+{
+    TEST_SUITE_START("uAT_Ring_Copy");
+
+    uAT_Ring_t ring;
+    uint8_t buf[8];
+    char out[16];
+    uAT_Ring_Init(&ring, buf, sizeof(buf));
+
+    TEST_ASSERT_EQUAL_INT(5, (int)uAT_Ring_Write(&ring, "OK\r\nA", 5), "Should write all bytes");
+    TEST_ASSERT_EQUAL_INT(5, (int)uAT_Ring_Used(&ring), "Used should count written bytes");
+    TEST_ASSERT_EQUAL_INT(4, (int)uAT_Ring_Read(&ring, out, 4), "Should read requested bytes");
+    TEST_ASSERT_TRUE(memcmp(out, "OK\r\n", 4) == 0, "Should read in order");
+
+    // Write across the end of the buffer
+    TEST_ASSERT_EQUAL_INT(7, (int)uAT_Ring_Write(&ring, "BCDEFGHIJ", 9), "Should stop when full");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Free(&ring), "Ring should be full");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Write(&ring, "X", 1), "Full ring should reject data");
+    TEST_ASSERT_EQUAL_INT(8, (int)uAT_Ring_Read(&ring, out, sizeof(out)), "Should read across the end");
+    TEST_ASSERT_TRUE(memcmp(out, "ABCDEFGH", 8) == 0, "Wrapped data should be in order");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Read(&ring, out, sizeof(out)), "Empty ring should return nothing");
+
+    uAT_Ring_Write(&ring, "xyz", 3);
+    uAT_Ring_Reset(&ring);
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Used(&ring), "Reset should discard data");
+
+    TEST_SUITE_END("uAT_Ring_Copy");
+}
+
+void test_uAT_Ring_Spans(void)
+{
+    TEST_SUITE_START("uAT_Ring_Spans");
+
+    uAT_Ring_t ring;
+    uint8_t buf[8];
+    uint8_t *wspan;
+    const uint8_t *rspan;
+    uAT_Ring_Init(&ring, buf, sizeof(buf));
+
+    uAT_Ring_Write(&ring, "abcdef", 6);
+    uAT_Ring_Consume(&ring, uAT_Ring_ReadSpan(&ring, &rspan));
+
+    // Free space wraps: the first span runs to the end of the buffer only
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Ring_WriteSpan(&ring, &wspan), "Write span should stop at the end");
+    TEST_ASSERT_TRUE(wspan == buf + 6, "Write span should start at the write position");
+    memcpy(wspan, "gh", 2);
+    uAT_Ring_Produce(&ring, 2);
+    TEST_ASSERT_EQUAL_INT(6, (int)uAT_Ring_WriteSpan(&ring, &wspan), "Next span should start at the front");
+    TEST_ASSERT_TRUE(wspan == buf, "Write span should wrap to the front");
+    memcpy(wspan, "ij", 2);
+    uAT_Ring_Produce(&ring, 2);
+
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Ring_ReadSpan(&ring, &rspan), "Read span should stop at the end");
+    TEST_ASSERT_TRUE(memcmp(rspan, "gh", 2) == 0, "Read span should expose data in place");
+    uAT_Ring_Consume(&ring, 1);
+    TEST_ASSERT_EQUAL_INT(1, (int)uAT_Ring_ReadSpan(&ring, &rspan), "Partial consume should shrink the span");
+    uAT_Ring_Consume(&ring, 1);
+    TEST_ASSERT_EQUAL_INT(2, (int)uAT_Ring_ReadSpan(&ring, &rspan), "Read span should wrap to the front");
+    TEST_ASSERT_TRUE(memcmp(rspan, "ij", 2) == 0, "Wrapped span should hold the new data");
+
+    TEST_SUITE_END("uAT_Ring_Spans");
+}
+
+void test_uAT_Ring_IndexWrap(void)
+{
+    TEST_SUITE_START("uAT_Ring_IndexWrap");
+
+    uAT_Ring_t ring;
+    uint8_t buf[16];
+    char out[16];
+    uAT_Ring_Init(&ring, buf, sizeof(buf));
+
+    // Free-running indices just before they overflow
+    ring.head = 0xFFFFFFFAu;
+    ring.tail = 0xFFFFFFFAu;
+    TEST_ASSERT_EQUAL_INT(12, (int)uAT_Ring_Write(&ring, "+CSQ: 21,99\r", 12), "Should write across the index wrap");
+    TEST_ASSERT_EQUAL_INT(12, (int)uAT_Ring_Used(&ring), "Used should survive the index wrap");
+    TEST_ASSERT_EQUAL_INT(4, (int)uAT_Ring_Free(&ring), "Free should survive the index wrap");
+    TEST_ASSERT_EQUAL_INT(12, (int)uAT_Ring_Read(&ring, out, sizeof(out)), "Should read across the index wrap");
+    TEST_ASSERT_TRUE(memcmp(out, "+CSQ: 21,99\r", 12) == 0, "Data should survive the index wrap");
+
+    TEST_SUITE_END("uAT_Ring_IndexWrap");
+}
+
+#define STRESS_BYTES (1024u * 1024u)
+
+static uAT_Ring_t stress_ring;
+static uint8_t stress_buf[256];
+
+// Producer: writes a counting pattern in odd-sized chunks
+static void *stress_producer(void *arg)
+{
+    (void)arg;
+    uint8_t chunk[13];
+    uint32_t next = 0;
+
+    while (next < STRESS_BYTES)
+    {
+        size_t n = 1 + (next % sizeof(chunk));
+        for (size_t i = 0; i < n; i++)
+        {
+            chunk[i] = (uint8_t)(next + i);
+        }
+        size_t written = uAT_Ring_Write(&stress_ring, chunk, n);
+        if (written == 0)
+        {
+            sched_yield(); // Ring full, let the consumer run
+        }
+        next += (uint32_t)written;
+    }
+    return NULL;
+}
+
+void test_uAT_Ring_Stress(void)
+{
+    TEST_SUITE_START("uAT_Ring_Stress");
+
+    uAT_Ring_Init(&stress_ring, stress_buf, sizeof(stress_buf));
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, stress_producer, NULL);
+
+    // Consumer: parses in place through the span API
+    uint32_t expected = 0;
+    int errors = 0;
+    while (expected < STRESS_BYTES)
+    {
+        const uint8_t *span;
+        size_t n = uAT_Ring_ReadSpan(&stress_ring, &span);
+        if (n == 0)
+        {
+            sched_yield(); // Ring empty, let the producer run
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            if (span[i] != (uint8_t)(expected + i))
+            {
+                errors++;
+            }
+        }
+        expected += (uint32_t)n;
+        uAT_Ring_Consume(&stress_ring, n);
+    }
+
+    pthread_join(producer, NULL);
+    TEST_ASSERT_EQUAL_INT(0, errors, "No byte should be lost or reordered");
+    TEST_ASSERT_EQUAL_INT(0, (int)uAT_Ring_Used(&stress_ring), "Ring should be drained");
+
+    TEST_SUITE_END("uAT_Ring_Stress");
+}
+
+int main(void)
+{
+    printf("=== uAT Receive Ring Tests ===\n");
+    test_framework_init();
+
+    test_uAT_Ring_Init();
+    test_uAT_Ring_Copy();
+    test_uAT_Ring_Spans();
+    test_uAT_Ring_IndexWrap();
+    test_uAT_Ring_Stress();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,1107 @@
+/**
+ * @file test_rx_event.c
+ * @brief Tests for the ReceiveToIdle DMA reception backend
+ *
+ * uat_freertos.c is built with UAT_DMA_RX_EVENT for this test. The mocked
+ * ReceiveToIdle start hands out the DMA buffer, the test plays the DMA
+ * controller by writing into it and raises HAL_UARTEx_RxEventCallback() the
+ * way HAL does on half-transfer, transfer-complete and IDLE events. uAT_Task
+ * is run for a single pass after each event by leaving it with longjmp()
+ * when it blocks in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t dma_pos; // Simulated DMA write position
+static int lines_seen;
+static int lines_in_order;
+
+static void creg_handler(const char *args)
+{
+    (void)args;
+    lines_seen++;
+}
+
+// Each burst line carries its sequence number
+static void qird_handler(const char *args)
+{
+    if (atoi(args) == lines_seen)
+    {
+        lines_in_order++;
+    }
+    lines_seen++;
+}
+
+static int cmd_hits;
+static int urc_hits;
+
+static void cmd_handler(const char *args)
+{
+    (void)args;
+    cmd_hits++;
+}
+
+static void urc_handler(const char *args)
+{
+    (void)args;
+    urc_hits++;
+}
+
+// Extended handler: records the view it was given
+typedef struct
+{
+    int calls;
+    char args[64];
+    size_t len;
+    char after;
+    TickType_t tick;
+} ex_record_t;
+
+static void ex_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    ex_record_t *rec = ctx;
+    rec->calls++;
+    rec->len = len;
+    memcpy(rec->args, args, len < sizeof(rec->args) ? len : sizeof(rec->args));
+    rec->after = args[len];
+    rec->tick = tick;
+}
+
+// Subscriber: records its id and where its view of the line starts
+static int sub_order[8];
+static int sub_calls;
+static const char *sub_args[8];
+
+static void sub_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    (void)tick;
+    if (sub_calls < 8)
+    {
+        sub_order[sub_calls] = *(const int *)ctx;
+        sub_args[sub_calls] = args;
+    }
+    sub_calls++;
+}
+
+// Re-registers from inside a handler, which runs in uAT_Task
+static void self_replacing_handler(const char *args)
+{
+    (void)args;
+    cmd_hits++;
+    uAT_UnregisterCommand("+C");
+    uAT_RegisterURC("+CREG", urc_handler);
+}
+
+static void rx_event(void);
+
+// The modem's reply to the command sent by uAT_SendReceive()
+static const char *reply;
+
+static void modem_reply(const uint8_t *data, uint16_t size)
+{
+    (void)data;
+    (void)size;
+    memcpy(&mock_uart_rx_buf[dma_pos], reply, strlen(reply));
+    dma_pos += strlen(reply);
+    rx_event();
+}
+
+// Commands sent while the modem stays silent, without CRLF, and payloads
+static char sent[8][32];
+static int sent_count;
+
+static void record_sent(const uint8_t *data, uint16_t size)
+{
+    if (size >= 2 && data[size - 2] == '\r' && data[size - 1] == '\n')
+    {
+        size -= 2;
+    }
+    if (sent_count < 8)
+    {
+        snprintf(sent[sent_count], sizeof(sent[0]), "%.*s", (int)size, (const char *)data);
+    }
+    sent_count++;
+}
+
+static void rx_event(void)
+{
+    HAL_UARTEx_RxEventCallback(&test_huart, (uint16_t)dma_pos);
+    run_task_once();
+}
+
+// Write data into the DMA buffer, raising HT/TC events as the DMA would
+static void dma_write(const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        mock_uart_rx_buf[dma_pos++] = (uint8_t)data[i];
+
+        if (dma_pos == mock_uart_rx_size / 2)
+        {
+            rx_event(); // Half transfer
+        }
+        else if (dma_pos == mock_uart_rx_size)
+        {
+            rx_event(); // Transfer complete
+            dma_pos = 0;
+        }
+    }
+}
+
+static void setup(void)
+{
+    sent_count = 0;
+    reply = "+CSQ: 21,99\r\nOK\r\n";
+    dma_pos = 0;
+    lines_seen = 0;
+    lines_in_order = 0;
+    task_harness_init();
+}
+
+void test_rx_event_init(void)
+{
+    TEST_SUITE_START("RxEvent_Init");
+
+    setup();
+    TEST_ASSERT_EQUAL_INT(1, (int)mock_uart_rx_to_idle, "Init should start ReceiveToIdle DMA");
+    TEST_ASSERT_NOT_NULL(mock_uart_rx_buf, "DMA buffer should be handed to HAL");
+    TEST_ASSERT_EQUAL_INT(UAT_DMA_RX_SIZE, mock_uart_rx_size, "Whole DMA buffer should be used");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Reset(), "Reset should succeed");
+    TEST_ASSERT_EQUAL_INT(2, (int)mock_uart_rx_to_idle, "Reset should restart ReceiveToIdle DMA");
+
+    mock_hal_status = HAL_ERROR;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INIT_FAIL, uAT_Init(&test_huart), "Init should fail if HAL fails");
+    mock_hal_status = HAL_OK;
+
+    TEST_SUITE_END("RxEvent_Init");
+}
+
+void test_rx_event_idle(void)
+{
+    TEST_SUITE_START("RxEvent_Idle");
+
+    setup();
+    uAT_RegisterCommand("+CREG:", creg_handler);
+
+    const char *msg = "+CREG: 1,5\r\n+CREG: 0,1\r\n";
+    dma_write(msg, strlen(msg));
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(0, lines_seen, "Nothing should move before an event");
+    TEST_ASSERT_EQUAL_INT(0, (int)mock_task_notify_count, "Task should not be woken before an event");
+
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, lines_seen, "IDLE should hand over both lines");
+    TEST_ASSERT_EQUAL_INT(2, (int)mock_task_notify_value, "Notification should carry the line count");
+
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, lines_seen, "Repeated IDLE should not duplicate data");
+
+    // Events from another UART are ignored
+    UART_HandleTypeDef other;
+    memset(&other, 0, sizeof(other));
+    dma_write("+CREG: 2,2\r\n", 12);
+    HAL_UARTEx_RxEventCallback(&other, (uint16_t)dma_pos);
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(2, lines_seen, "Other UART should be ignored");
+
+    TEST_SUITE_END("RxEvent_Idle");
+}
+
+void test_rx_event_burst(void)
+{
+    TEST_SUITE_START("RxEvent_Burst");
+
+    setup();
+    uAT_RegisterCommand("+QIRD:", qird_handler);
+
+    // A burst of several laps without a single idle gap
+    static char burst[3 * UAT_DMA_RX_SIZE + 100];
+    size_t len = 0;
+    int count = 0;
+    while (len + 32 < sizeof(burst))
+    {
+        len += (size_t)snprintf(burst + len, sizeof(burst) - len, "+QIRD: %d,\"data\"\r\n", count++);
+    }
+
+    dma_write(burst, len);
+    TEST_ASSERT_TRUE(lines_seen > 0, "HT/TC should hand lines over without IDLE");
+
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(count, lines_seen, "No line should be lost across laps");
+    TEST_ASSERT_EQUAL_INT(count, lines_in_order, "Lines should arrive in order");
+
+    TEST_SUITE_END("RxEvent_Burst");
+}
+
+void test_rx_event_dispatch(void)
+{
+    TEST_SUITE_START("RxEvent_Dispatch");
+
+    setup();
+    cmd_hits = 0;
+    urc_hits = 0;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+C", cmd_handler), "Should register a short prefix");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+CREG:", creg_handler), "Should register a nested prefix");
+
+    dma_write("+CREG: 1\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, cmd_hits, "Earlier registered prefix should win");
+    TEST_ASSERT_EQUAL_INT(0, lines_seen, "Later nested prefix should not be called");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterURC("+CREG", urc_handler), "Should register a URC");
+    dma_write("+CREG: 2\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, urc_hits, "URC should win over commands");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_UnregisterCommand("+CREG"), "Should unregister the URC");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_UnregisterCommand("+C"), "Should unregister the short prefix");
+    dma_write("+CREG: 3\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, lines_seen, "Remaining nested prefix should match");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+CREG:", cmd_handler), "Should replace a handler");
+    dma_write("+CREG: 4\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, cmd_hits, "Replaced handler should be called");
+    TEST_ASSERT_EQUAL_INT(1, lines_seen, "Old handler should not be called");
+
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, cmd_hits, "Unmatched line should call nothing");
+    TEST_ASSERT_EQUAL_INT(1, urc_hits, "Unregistered URC should not be called");
+
+    TEST_SUITE_END("RxEvent_Dispatch");
+}
+
+void test_rx_event_handler_ex(void)
+{
+    TEST_SUITE_START("RxEvent_HandlerEx");
+
+    setup();
+    ex_record_t csq = {0};
+    ex_record_t ok = {0};
+    lines_seen = 0;
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_RegisterCommandEx("+CSQ:", NULL, &csq), "Should reject null handler");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq), "Should register an extended handler");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommandEx("OK", ex_handler, &ok), "Should register a second context");
+
+    mock_tick_count = 1234;
+    dma_write("+CSQ: 21,99\r\nOK\r\n", 17);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Handler should be called once");
+    TEST_ASSERT_EQUAL_INT(5, (int)csq.len, "Length should exclude prefix, spaces and terminator");
+    TEST_ASSERT_TRUE(memcmp(csq.args, "21,99", 5) == 0, "View should start after the prefix");
+    TEST_ASSERT_EQUAL_INT('\r', csq.after, "View should point into the line, not a copy");
+    TEST_ASSERT_EQUAL_INT(1234, (int)csq.tick, "Tick should be passed through");
+    TEST_ASSERT_EQUAL_INT(1, ok.calls, "Context should select the record");
+    TEST_ASSERT_EQUAL_INT(0, (int)ok.len, "Bare response should have an empty view");
+
+    // Plain and extended registrations replace each other
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+CSQ:", creg_handler), "Plain handler should replace it");
+    dma_write("+CSQ: 5,0\r\n", 11);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Replaced extended handler should not be called");
+    TEST_ASSERT_EQUAL_INT(1, lines_seen, "Plain handler should be called");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq), "Extended handler should replace it back");
+    dma_write("+CSQ: 7,0\r\n", 11);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, csq.calls, "Extended handler should be called again");
+    TEST_ASSERT_EQUAL_INT(1, lines_seen, "Replaced plain handler should not be called");
+
+    TEST_SUITE_END("RxEvent_HandlerEx");
+}
+
+void test_rx_event_patterns(void)
+{
+    TEST_SUITE_START("RxEvent_Patterns");
+
+    setup();
+    ex_record_t reg = {0};
+    ex_record_t creg = {0};
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_RegisterPatternEx("+C[EG", ex_handler, &reg), "Should reject a malformed pattern");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterPatternEx("+C?REG:", ex_handler, &reg), "Should register a pattern");
+
+    dma_write("+CGREG: 0,1\r\n+CEREG: 0,5\r\n", 26);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, reg.calls, "One pattern should cover the family");
+    TEST_ASSERT_EQUAL_INT(3, (int)reg.len, "Arguments should follow the matched text");
+    TEST_ASSERT_TRUE(memcmp(reg.args, "0,5", 3) == 0, "Arguments should start after the match");
+
+    // Overlapping pattern and command: the earliest registered wins
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommandEx("+CEREG:", ex_handler, &creg), "Should register an overlapping command");
+    dma_write("+CEREG: 0,1\r\n", 13);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(3, reg.calls, "Earlier pattern should win");
+    TEST_ASSERT_EQUAL_INT(0, creg.calls, "Later command should not be called");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_UnregisterCommand("+C?REG:"), "Should unregister the pattern");
+    dma_write("+CEREG: 0,1\r\n+CGREG: 0,1\r\n", 26);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(3, reg.calls, "Unregistered pattern should not be called");
+    TEST_ASSERT_EQUAL_INT(1, creg.calls, "Command should match once the pattern is gone");
+
+    TEST_SUITE_END("RxEvent_Patterns");
+}
+
+void test_rx_event_subscribers(void)
+{
+    TEST_SUITE_START("RxEvent_Subscribers");
+
+    setup();
+    static const int ids[] = {0, 1, 2, 3, 4};
+    sub_calls = 0;
+    cmd_hits = 0;
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Subscribe("+QIURC:", sub_handler, (void *)&ids[1]), "Should subscribe");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Subscribe("+QIURC:", sub_handler, (void *)&ids[2]), "Should subscribe another context");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Subscribe("+QIURC:", sub_handler, (void *)&ids[2]), "Subscribing twice should be harmless");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+QIURC:", cmd_handler), "Should register next to subscribers");
+
+    dma_write("+QIURC: \"recv\",0\r\n", 18);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, cmd_hits, "Registered handler should get the line");
+    TEST_ASSERT_EQUAL_INT(2, sub_calls, "Each subscriber should get the line once");
+    TEST_ASSERT_TRUE(sub_order[0] == 1 && sub_order[1] == 2, "Subscribers should run in the order they subscribed");
+    TEST_ASSERT_TRUE(sub_args[0] == sub_args[1], "Subscribers should share one view of the line");
+
+    // Registering again replaces only the registered handler
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+QIURC:", urc_handler), "Should replace the registered handler");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Subscribe("+QIURC:", sub_handler, (void *)&ids[3]), "Should subscribe up to the limit");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_Subscribe("+QIURC:", sub_handler, (void *)&ids[4]), "Handlers per command should be bounded");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Unsubscribe("+QIURC:", sub_handler, (void *)&ids[3]), "Should unsubscribe the last subscriber");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_UnregisterCommand("+QIURC:"), "Should unregister the registered handler");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_UnregisterCommand("+QIURC:"), "Subscribers should not be unregistered");
+
+    sub_calls = 0;
+    dma_write("+QIURC: \"closed\",0\r\n", 20);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, sub_calls, "Subscribers should stay after unregistering");
+    TEST_ASSERT_EQUAL_INT(1, cmd_hits, "Unregistered handler should not be called");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Unsubscribe("+QIURC:", sub_handler, (void *)&ids[1]), "Should unsubscribe");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_Unsubscribe("+QIURC:", sub_handler, (void *)&ids[1]), "Should not unsubscribe twice");
+    sub_calls = 0;
+    dma_write("+QIURC: \"closed\",1\r\n", 20);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, sub_calls, "Only the remaining subscriber should be called");
+    TEST_ASSERT_EQUAL_INT(2, sub_order[0], "Remaining subscriber should get the line");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_Unsubscribe("+QIURC:", sub_handler, (void *)&ids[2]), "Should unsubscribe the last one");
+    sub_calls = 0;
+    dma_write("+QIURC: \"closed\",2\r\n", 20);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(0, sub_calls, "No handler should be left");
+
+    TEST_SUITE_END("RxEvent_Subscribers");
+}
+
+void test_rx_event_snapshot(void)
+{
+    TEST_SUITE_START("RxEvent_Snapshot");
+
+    setup();
+    cmd_hits = 0;
+    urc_hits = 0;
+    lines_seen = 0;
+    uAT_RegisterCommand("+CSQ:", creg_handler);
+    uAT_RegisterCommand("+C", self_replacing_handler);
+
+    // Dispatch takes no lock, so a held handler mutex cannot drop lines
+    mock_semaphore_take_result = pdFALSE;
+    dma_write("+CSQ: 1\r\n", 9);
+    rx_event();
+    mock_semaphore_take_result = pdTRUE;
+    TEST_ASSERT_EQUAL_INT(1, lines_seen, "Line should be dispatched while the mutex is held");
+
+    // The handler swaps the table from inside uAT_Task
+    dma_write("+CREG: 1\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, cmd_hits, "Handler should be called");
+    dma_write("+CREG: 2\r\n", 10);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, cmd_hits, "Unregistered handler should not be called");
+    TEST_ASSERT_EQUAL_INT(1, urc_hits, "Handler registered from a handler should be called");
+
+    TEST_SUITE_END("RxEvent_Snapshot");
+}
+
+void test_rx_event_send_receive(void)
+{
+    TEST_SUITE_START("RxEvent_SendReceive");
+
+    setup();
+    ex_record_t csq = {0};
+    ex_record_t ok = {0};
+    char resp[64];
+    uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq);
+    uAT_RegisterCommandEx("OK", ex_handler, &ok);
+
+    mock_uart_tx_hook = modem_reply;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceive("AT+CSQ", "OK", resp, sizeof(resp), 100), "SendReceive should succeed");
+    mock_uart_tx_hook = NULL;
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\nOK\r\n", resp, "Response should be captured up to the expected line");
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Other lines should still reach their handlers");
+    TEST_ASSERT_EQUAL_INT(0, ok.calls, "Expected line should complete the call, not a handler");
+
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, ok.calls, "Handler should get the line again after the call");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\nOK\r\n", resp, "Buffer should not be written after the call");
+
+    TEST_SUITE_END("RxEvent_SendReceive");
+}
+
+typedef struct
+{
+    int calls;
+    size_t count;
+    char second[32];
+    char last[32];
+} lines_record_t;
+
+static void lines_handler(const uAT_LineView_t *lines, size_t count, void *ctx)
+{
+    lines_record_t *rec = ctx;
+    rec->calls++;
+    rec->count = count;
+    if (count >= 2)
+    {
+        snprintf(rec->second, sizeof(rec->second), "%.*s", (int)lines[1].len, lines[1].text);
+    }
+    if (count >= 1)
+    {
+        snprintf(rec->last, sizeof(rec->last), "%s", lines[count - 1].text);
+    }
+}
+
+void test_rx_event_send_receive_lines(void)
+{
+    TEST_SUITE_START("RxEvent_SendReceiveLines");
+
+    setup();
+    void *arena[32];
+    lines_record_t rec = {0};
+
+    mock_uart_tx_hook = modem_reply;
+    reply = "+COPS: (2,\"A\")\r\n+COPS: (1,\"B\")\r\n+COPS: (3,\"C\")\r\nOK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceiveLines("AT+COPS=?", "OK", arena, sizeof(arena), lines_handler, &rec, 100),
+                          "SendReceiveLines should succeed");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Handler should be called once");
+    TEST_ASSERT_EQUAL_INT(4, (int)rec.count, "Every line up to the expected one should be collected");
+    TEST_ASSERT_EQUAL_STRING("+COPS: (1,\"B\")", rec.second, "Line views should be indexed in order, without terminator");
+    TEST_ASSERT_EQUAL_STRING("OK", rec.last, "Expected line should end the list, null-terminated");
+
+    // Room for two lines only
+    memset(&rec, 0, sizeof(rec));
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESOURCE, uAT_SendReceiveLines("AT+COPS=?", "OK", arena, 2 * sizeof(uAT_LineView_t) + 32, lines_handler, &rec, 100),
+                          "Lines that do not fit should be reported");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Handler should still get the lines that fit");
+    TEST_ASSERT_EQUAL_INT(2, (int)rec.count, "Lines should be stored until the arena is full");
+    mock_uart_tx_hook = NULL;
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_SendReceiveLines("AT", "OK", (char *)arena + 1, 64, lines_handler, &rec, 100),
+                          "Misaligned arena should be rejected");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_SendReceiveLines("AT", "OK", arena, sizeof(arena), NULL, NULL, 100),
+                          "NULL handler should be rejected");
+
+    TEST_SUITE_END("RxEvent_SendReceiveLines");
+}
+
+static const char *const final_lines[] = {"OK", "ERROR", NULL};
+
+void test_rx_event_txn_queue(void)
+{
+    TEST_SUITE_START("RxEvent_TxnQueue");
+
+    setup();
+    ex_record_t csq = {0};
+    char buf_a[64];
+    uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq);
+    mock_uart_tx_hook = record_sent;
+
+    uAT_TxnRequest_t a = {.cmd = "AT+CSQ", .terminators = final_lines, .outBuf = buf_a, .bufLen = sizeof(buf_a), .timeout = 100};
+    uAT_TxnRequest_t b = {.cmd = "AT+CPIN?", .terminators = final_lines, .timeout = 100};
+    uAT_TxnRequest_t c = {.cmd = "AT+CREG?", .terminators = final_lines, .timeout = 100};
+    uAT_TxnHandle_t ha, hb, hc;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&a, &ha), "First transaction should be queued");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&b, &hb), "Second transaction should be queued");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&c, &hc), "Third transaction should be queued");
+    TEST_ASSERT_EQUAL_INT(1, sent_count, "Only the first command should be sent");
+    TEST_ASSERT_EQUAL_STRING("AT+CSQ", sent[0], "First command should be sent at once");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnPoll(hb, NULL), "Queued transaction should be pending");
+
+    dma_write("+CSQ: 21,99\r\nOK\r\n", 17);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Final line should send the next command in the same pass");
+    TEST_ASSERT_EQUAL_STRING("AT+CPIN?", sent[1], "Commands should be sent in order");
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Intermediate lines should still reach their handlers");
+
+    uAT_TxnResult_t res;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(ha, &res), "Finished transaction should be collected");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, res.result, "Transaction should succeed");
+    TEST_ASSERT_EQUAL_INT(0, (int)res.terminator, "First terminator should be reported");
+    TEST_ASSERT_EQUAL_INT(2, (int)res.lineCount, "Every line should be counted");
+    TEST_ASSERT_EQUAL_INT(17, (int)res.bytesCaptured, "Captured bytes should be reported");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\nOK\r\n", buf_a, "Response should be captured into the sink");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_TxnPoll(ha, &res), "Collected handle should not be found again");
+
+    // A cancelled command is skipped when its turn comes
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnCancel(hc), "Queued transaction should be cancelled");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_TxnPoll(hc, NULL), "Cancelled handle should not be found");
+    dma_write("ERROR\r\n", 7);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Cancelled command should never be sent");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnWait(hb, &res, 100), "Finished transaction should be waited for");
+    TEST_ASSERT_EQUAL_INT(1, (int)res.terminator, "Matching terminator should be reported");
+    TEST_ASSERT_EQUAL_INT(1, (int)res.lineCount, "Final line alone should be counted");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_TxnSubmit(&a, NULL), "NULL handle should be rejected");
+    a.cmd = NULL;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_TxnSubmit(&a, &ha), "Missing command should be rejected");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_TxnQueue");
+}
+
+void test_rx_event_txn_timeout(void)
+{
+    TEST_SUITE_START("RxEvent_TxnTimeout");
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+
+    uAT_TxnRequest_t slow = {.cmd = "AT+COPS=?", .terminators = final_lines, .timeout = 10};
+    uAT_TxnRequest_t next = {.cmd = "AT", .terminators = final_lines, .timeout = portMAX_DELAY};
+    uAT_TxnHandle_t hs, hn;
+    uAT_TxnResult_t res;
+    uAT_TxnSubmit(&slow, &hs);
+    uAT_TxnSubmit(&next, &hn);
+
+    mock_tick_count = 9;
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnPoll(hs, &res), "Transaction should run until its timeout");
+    mock_semaphore_take_result = pdFALSE;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_TIMEOUT, uAT_TxnWait(hs, &res, 5), "Wait should give up on a pending transaction");
+    mock_semaphore_take_result = pdTRUE;
+
+    mock_tick_count = 10;
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Timed out command should give way to the next");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(hs, &res), "Timed out transaction should be collected");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_TIMEOUT, res.result, "Timeout should be reported");
+    TEST_ASSERT_EQUAL_INT(-1, (int)res.terminator, "No terminator should be reported");
+
+    // The active transaction holds one slot
+    uAT_TxnHandle_t queued[UAT_TXN_QUEUE_LEN];
+    for (int i = 0; i < UAT_TXN_QUEUE_LEN - 1; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&next, &queued[i]), "Transaction should fit in the queue");
+    }
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnSubmit(&next, &queued[0]), "Full queue should be reported");
+
+    // Cancelling the active one sends the next; failed sends finish at once
+    mock_hal_status = HAL_ERROR;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnCancel(hn), "Active transaction should be cancelled");
+    mock_hal_status = HAL_OK;
+    for (int i = 0; i < UAT_TXN_QUEUE_LEN - 1; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(queued[i], &res), "Failed send should finish the transaction");
+        TEST_ASSERT_EQUAL_INT(UAT_ERR_SEND_FAIL, res.result, "Send failure should be reported");
+    }
+
+    // Given up on, SendReceive cancels its transaction
+    char resp[16];
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_TIMEOUT, uAT_SendReceive("ATI", "OK", resp, sizeof(resp), 0), "Unanswered command should time out");
+    TEST_ASSERT_EQUAL_INT(3, sent_count, "Freed slots should take new commands");
+    TEST_ASSERT_EQUAL_STRING("ATI", sent[2], "New command should be sent at once");
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_STRING("", resp, "Cancelled sink should not be written");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_TxnTimeout");
+}
+
+// Runs slot_freer once a full submit blocks: its first take is
+// handlerMutex, the second the wait for a slot
+static uAT_TxnHandle_t free_target;
+static bool target_freed;
+static int take_calls;
+static void (*slot_freer)(void);
+
+static void on_slot_wait(void)
+{
+    if (++take_calls == 2)
+    {
+        slot_freer();
+    }
+}
+
+static void collect_target(void)
+{
+    target_freed = uAT_TxnPoll(free_target, NULL) == UAT_OK;
+}
+
+static void let_time_pass(void)
+{
+    mock_tick_count += 5;
+}
+
+void test_rx_event_txn_submit_waits(void)
+{
+    TEST_SUITE_START("RxEvent_TxnSubmitWaits");
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+
+    static const char *cmds[] = {"AT+A0", "AT+A1", "AT+A2", "AT+A3"};
+    uAT_TxnHandle_t a[UAT_TXN_QUEUE_LEN];
+    for (int i = 0; i < UAT_TXN_QUEUE_LEN; i++)
+    {
+        uAT_TxnRequest_t req = {.cmd = cmds[i], .timeout = portMAX_DELAY};
+        TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&req, &a[i]), "Transaction should fit in the queue");
+    }
+    dma_write("OK\r\nOK\r\n", 8);
+    rx_event();
+
+    // The first slot is still waiting for collection, the second is free
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(a[1], NULL), "Finished transaction should be collected");
+    uAT_TxnRequest_t b = {.cmd = "AT+B", .timeout = 0};
+    uAT_TxnHandle_t hb;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&b, &hb), "Any free slot should take a command");
+
+    // Full now; another task waits until a slot is freed
+    static int app_task;
+    mock_current_task = &app_task;
+    uAT_TxnRequest_t c = {.cmd = "AT+C", .timeout = 5};
+    uAT_TxnHandle_t hc;
+    free_target = a[0];
+    take_calls = 0;
+    slot_freer = collect_target;
+    mock_semaphore_take_hook = on_slot_wait;
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnSubmit(&c, &hc), "Submitter should wait for a free slot");
+    TEST_ASSERT_TRUE(target_freed, "Submitter should have blocked until a slot was freed");
+
+    // Gives up after its timeout
+    uAT_TxnHandle_t hd;
+    take_calls = 0;
+    slot_freer = let_time_pass;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnSubmit(&c, &hd), "Submitter should give up after its timeout");
+    TEST_ASSERT_EQUAL_INT(3, take_calls, "Submitter should have blocked until its timeout");
+
+    // uAT_Task never waits for a slot
+    take_calls = 0;
+    mock_current_task = NULL;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnSubmit(&c, &hd), "uAT_Task should not wait for a slot");
+    TEST_ASSERT_EQUAL_INT(1, take_calls, "uAT_Task should not block");
+    mock_semaphore_take_hook = NULL;
+
+    // Sent in the order submitted, whatever the slots
+    dma_write("OK\r\nOK\r\n", 8);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(6, sent_count, "Every command should have been sent");
+    TEST_ASSERT_EQUAL_STRING("AT+A3", sent[3], "Queued command should go first");
+    TEST_ASSERT_EQUAL_STRING("AT+B", sent[4], "Command in a reused slot should follow");
+    TEST_ASSERT_EQUAL_STRING("AT+C", sent[5], "Command that waited should go last");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_TxnSubmitWaits");
+}
+
+// Cancels cancel_target when a RING arrives in the middle of its response
+static uAT_TxnHandle_t cancel_target;
+static uAT_Result_t cancel_status;
+
+static void cancel_on_ring(const char *args)
+{
+    (void)args;
+    cancel_status = uAT_TxnCancel(cancel_target);
+}
+
+static void cancel_done(uAT_TxnHandle_t handle, const uAT_TxnResult_t *result, void *ctx)
+{
+    (void)result;
+    *(uAT_Result_t *)ctx = uAT_TxnCancel(handle);
+}
+
+void test_rx_event_txn_cancel_in_flight(void)
+{
+    TEST_SUITE_START("RxEvent_TxnCancelInFlight");
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+    char buf[32];
+    uAT_TxnRequest_t req = {.cmd = "AT+CSQ", .outBuf = buf, .bufLen = sizeof(buf), .timeout = 100};
+    uAT_TxnHandle_t handle;
+
+    // Cancelled between two lines, the rest of the response is not captured
+    uAT_RegisterURC("RING", cancel_on_ring);
+    uAT_TxnSubmit(&req, &cancel_target);
+    const char *lines = "+CSQ: 21,99\r\nRING\r\n+CSQ: 1,1\r\nOK\r\n";
+    dma_write(lines, strlen(lines));
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, cancel_status, "Active transaction should be cancelled");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\n", buf, "Lines after the cancel should not reach the sink");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_TxnPoll(cancel_target, NULL), "Cancelled transaction should be freed");
+    uAT_UnregisterCommand("RING");
+
+    // A callback runs while its transaction is completing
+    cancel_status = UAT_ERR_BUSY;
+    uAT_SendAsync("AT", NULL, NULL, 0, 100, cancel_done, &cancel_status, &handle);
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, cancel_status, "Callback should cancel its own transaction without waiting");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_TxnPoll(handle, NULL), "Slot should be free after the callback");
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Every command should have been sent");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_TxnCancelInFlight");
+}
+
+// Queues a second command behind the first one sent, then answers it
+static uAT_TxnHandle_t behind;
+static char behind_buf[64];
+
+static void reply_and_queue(const uint8_t *data, uint16_t size)
+{
+    record_sent(data, size);
+    if (sent_count > 1)
+    {
+        return;
+    }
+    uAT_TxnRequest_t next = {.cmd = "AT+CPIN?", .outBuf = behind_buf, .bufLen = sizeof(behind_buf), .timeout = 100};
+    uAT_TxnSubmit(&next, &behind);
+    modem_reply(data, size);
+}
+
+void test_rx_event_terminators(void)
+{
+    TEST_SUITE_START("RxEvent_Terminators");
+
+    setup();
+    char resp[64];
+    mock_uart_tx_hook = reply_and_queue;
+    reply = "+CSQ: 21,99\r\nOK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceive("AT+CSQ", "+CSQ:", resp, sizeof(resp), 100), "Expected line should succeed");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\nOK\r\n", resp, "Response should run up to its final result code");
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Next command should follow the final result code");
+    TEST_ASSERT_EQUAL_STRING("AT+CPIN?", sent[1], "Queued command should be sent next");
+
+    uAT_TxnResult_t res;
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnPoll(behind, &res), "Previous OK should not end the next transaction");
+    dma_write("+CPIN: READY\r\nOK\r\n", 18);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(behind, &res), "Next transaction should end on its own OK");
+    TEST_ASSERT_EQUAL_STRING("+CPIN: READY\r\nOK\r\n", behind_buf, "Next transaction should get its own response");
+    TEST_ASSERT_EQUAL_INT(2, (int)res.lineCount, "Next transaction should count only its lines");
+
+    // A prompt ends the transaction, the modem waits for data after it
+    mock_uart_tx_hook = record_sent;
+    static const char *const prompt[] = {"> ", NULL};
+    uAT_TxnRequest_t cmgs = {.cmd = "AT+CMGS=\"123\"", .terminators = prompt, .timeout = 100};
+    uAT_TxnHandle_t handle;
+    uAT_TxnSubmit(&cmgs, &handle);
+    dma_write("> ", 2);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handle, &res), "Prompt should end the transaction");
+    TEST_ASSERT_EQUAL_INT(0, (int)res.terminator, "Prompt should match its terminator");
+
+    // With a payload, the prompt gets it and the final result code ends
+    // the transaction; the command queued behind waits for that
+    uAT_TxnRequest_t sms = {.cmd = "AT+CMGS=\"123\"", .payload = "Hello\x1A", .timeout = 100};
+    uAT_TxnRequest_t after = {.cmd = "AT+CSQ", .timeout = 100};
+    uAT_TxnHandle_t queued;
+    sent_count = 0;
+    uAT_TxnSubmit(&sms, &handle);
+    uAT_TxnSubmit(&after, &queued);
+    dma_write("> ", 2);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, sent_count, "Prompt should get the payload only");
+    TEST_ASSERT_EQUAL_STRING("Hello\x1A", sent[1], "Payload should follow the prompt");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_BUSY, uAT_TxnPoll(handle, &res), "Prompt should not end a transaction with a payload");
+    dma_write("+CMGS: 5\r\nOK\r\n", 14);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handle, &res), "Final result code should end the transaction");
+    TEST_ASSERT_EQUAL_INT(UAT_FINAL_OK, res.finalCode, "Final result code should be reported");
+    TEST_ASSERT_EQUAL_INT(3, sent_count, "Queued command should be sent after the final result code");
+    TEST_ASSERT_EQUAL_STRING("AT+CSQ", sent[2], "Queued command should follow the payload's transaction");
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(queued, &res), "Queued transaction should end on its own OK");
+
+    // A line in finals ends the transaction without a final result code
+    static const char *const send_finals[] = {"SEND OK", "SEND FAIL", NULL};
+    uAT_TxnRequest_t cipsend = {.cmd = "AT+CIPSEND", .finals = send_finals, .timeout = 100};
+    uAT_TxnRequest_t csq = {.cmd = "AT+CSQ", .timeout = 100};
+    uAT_TxnHandle_t next;
+    uAT_TxnSubmit(&cipsend, &handle);
+    uAT_TxnSubmit(&csq, &next);
+    dma_write("SEND FAIL\r\n", 11);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handle, &res), "Line in finals should end the transaction");
+    TEST_ASSERT_EQUAL_INT(1, (int)res.finalMatch, "Matching final should be reported");
+    TEST_ASSERT_EQUAL_INT(UAT_FINAL_NONE, res.finalCode, "No final result code should be reported");
+    TEST_ASSERT_EQUAL_STRING("AT+CSQ", sent[sent_count - 1], "Next command should follow the line in finals");
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(next, &res), "Next transaction should end on its own OK");
+    TEST_ASSERT_EQUAL_INT(-1, (int)res.finalMatch, "Final result code should not match finals");
+
+    // An expected line that is not an information response ends SendReceive
+    mock_uart_tx_hook = modem_reply;
+    reply = "SHUT OK\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendReceive("AT+CIPSHUT", "SHUT OK", resp, sizeof(resp), 100), "Expected line should end the response");
+    TEST_ASSERT_EQUAL_STRING("SHUT OK\r\n", resp, "Expected line should be the last one captured");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_Terminators");
+}
+
+typedef struct
+{
+    int calls;
+    uAT_Result_t result;
+    int32_t terminator;
+    size_t lineCount;
+} async_record_t;
+
+static void async_done(uAT_TxnHandle_t handle, const uAT_TxnResult_t *result, void *ctx)
+{
+    (void)handle;
+    async_record_t *rec = ctx;
+    rec->calls++;
+    rec->result = result->result;
+    rec->terminator = result->terminator;
+    rec->lineCount = result->lineCount;
+}
+
+void test_rx_event_send_async(void)
+{
+    TEST_SUITE_START("RxEvent_SendAsync");
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+    async_record_t rec = {0};
+    char buf[64];
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_SendAsync("AT+COPS?", final_lines, buf, sizeof(buf), 100, async_done, &rec, NULL),
+                          "Command should be queued without a handle");
+    TEST_ASSERT_EQUAL_INT(0, rec.calls, "Callback should wait for the response");
+    dma_write("+COPS: 0,0,\"Op\"\r\nOK\r\n", 21);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Final line should call the callback");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, rec.result, "Callback should get the result");
+    TEST_ASSERT_EQUAL_INT(2, (int)rec.lineCount, "Callback should get the line count");
+    TEST_ASSERT_EQUAL_STRING("+COPS: 0,0,\"Op\"\r\nOK\r\n", buf, "Response should be captured");
+
+    // Slots come back after their callbacks, so many commands go through
+    for (int i = 0; i < 2 * UAT_TXN_QUEUE_LEN; i++)
+    {
+        uAT_SendAsync("AT", final_lines, NULL, 0, 100, async_done, &rec, NULL);
+        dma_write("ERROR\r\n", 7);
+        rx_event();
+    }
+    TEST_ASSERT_EQUAL_INT(1 + 2 * UAT_TXN_QUEUE_LEN, rec.calls, "Every callback should run once");
+    TEST_ASSERT_EQUAL_INT(1, (int)rec.terminator, "Callback should get the terminator");
+
+    uAT_TxnHandle_t handle;
+    uAT_SendAsync("AT+CGATT=1", final_lines, NULL, 0, 10, async_done, &rec, &handle);
+    mock_tick_count = 10;
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_TIMEOUT, rec.result, "Timeout should reach the callback");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_TxnPoll(handle, NULL), "Result should not be left for polling");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_SendAsync("AT", final_lines, NULL, 0, 100, NULL, NULL, NULL),
+                          "No callback and no handle should be rejected");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_SendAsync");
+}
+
+void test_rx_event_txn_signals(void)
+{
+    TEST_SUITE_START("RxEvent_TxnSignals");
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+    int app_task;
+    int events;
+    uAT_TxnRequest_t req[2] = {
+        {.cmd = "AT+CSQ", .terminators = final_lines, .timeout = 100,
+         .notifyTask = &app_task, .notifyBits = 0x100},
+        {.cmd = "AT+CREG?", .terminators = final_lines, .timeout = 100,
+         .eventGroup = &events, .eventBits = 0x4},
+    };
+    uAT_TxnHandle_t handles[2];
+    uAT_TxnSubmit(&req[0], &handles[0]);
+    uAT_TxnSubmit(&req[1], &handles[1]);
+
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_TRUE((mock_task_notify_value & 0x100) != 0, "Task should be notified with its bits");
+    TEST_ASSERT_EQUAL_INT(0, (int)mock_event_group_bits, "Pending transaction should not set its event bits");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handles[0], NULL), "Notified transaction should be collected");
+
+    dma_write("OK\r\n", 4);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(0x4, (int)mock_event_group_bits, "Event group should get its bits");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handles[1], NULL), "Signalled transaction should be collected");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_TxnSignals");
+}
+
+void test_rx_event_final_codes(void)
+{
+    TEST_SUITE_START("RxEvent_FinalCodes");
+
+    static const struct
+    {
+        const char *line;
+        uAT_FinalCode_t code;
+        int32_t errorCode;
+    } cases[] = {
+        {"OK\r\n", UAT_FINAL_OK, -1},
+        {"ERROR\r\n", UAT_FINAL_ERROR, -1},
+        {"+CME ERROR: 10\r\n", UAT_FINAL_CME_ERROR, 10},
+        {"+CMS ERROR: 321\r\n", UAT_FINAL_CMS_ERROR, 321},
+        {"+CME ERROR: SIM not inserted\r\n", UAT_FINAL_CME_ERROR, -1},
+        {"CONNECT\r\n", UAT_FINAL_CONNECT, -1},
+        {"CONNECT 115200\r\n", UAT_FINAL_CONNECT, -1},
+        {"NO CARRIER\r\n", UAT_FINAL_NO_CARRIER, -1},
+        {"BUSY\r\n", UAT_FINAL_BUSY, -1},
+        {"NO ANSWER\r\n", UAT_FINAL_NO_ANSWER, -1},
+        {"NO DIALTONE\r\n", UAT_FINAL_NO_DIALTONE, -1},
+    };
+
+    setup();
+    mock_uart_tx_hook = record_sent;
+    uAT_TxnRequest_t req = {.cmd = "AT", .timeout = 100};
+    uAT_TxnHandle_t handle;
+    uAT_TxnResult_t res;
+    int recognized = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        uAT_TxnSubmit(&req, &handle);
+        dma_write(cases[i].line, strlen(cases[i].line));
+        rx_event();
+        if (uAT_TxnPoll(handle, &res) == UAT_OK && res.result == UAT_OK && res.finalCode == cases[i].code &&
+            res.errorCode == cases[i].errorCode && res.terminator == -1)
+        {
+            recognized++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT((int)(sizeof(cases) / sizeof(cases[0])), recognized, "Every final result code should end the transaction");
+
+    // Lines merely starting like a final result code do not end it
+    ex_record_t csq = {0};
+    char buf[64];
+    uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq);
+    req.outBuf = buf;
+    req.bufLen = sizeof(buf);
+    uAT_TxnSubmit(&req, &handle);
+    dma_write("OKAY\r\nCONNECTING\r\n+CSQ: 21,99\r\n+CME ERROR: 30\r\n", 47);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handle, &res), "Error should end the transaction");
+    TEST_ASSERT_EQUAL_INT(UAT_FINAL_CME_ERROR, res.finalCode, "Final code should be reported");
+    TEST_ASSERT_EQUAL_INT(30, (int)res.errorCode, "Error number should be reported");
+    TEST_ASSERT_EQUAL_INT(4, (int)res.lineCount, "Intermediate lines should be counted");
+    TEST_ASSERT_EQUAL_INT(47, (int)res.bytesCaptured, "Every line should be captured");
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Intermediate lines should reach their handlers");
+
+    // SendReceive does not wait out its timeout on an error
+    char resp[64];
+    mock_uart_tx_hook = modem_reply;
+    reply = "+CME ERROR: 10\r\n";
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_RESPONSE, uAT_SendReceive("AT+CSQ", "+CSQ:", resp, sizeof(resp), 100), "Error should end SendReceive");
+    TEST_ASSERT_EQUAL_STRING("+CME ERROR: 10\r\n", resp, "Error line should be in the response");
+    mock_uart_tx_hook = NULL;
+
+    TEST_SUITE_END("RxEvent_FinalCodes");
+}
+
+void test_rx_event_urc_capture(void)
+{
+    TEST_SUITE_START("RxEvent_URCCapture");
+
+    setup();
+    ex_record_t csq = {0};
+    char buf[64];
+    uAT_RegisterURC("RING", urc_handler);
+    uAT_RegisterURC("+CREG:", urc_handler);
+    uAT_RegisterCommandEx("+CSQ:", ex_handler, &csq);
+    urc_hits = 0;
+
+    uAT_TxnRequest_t req = {.cmd = "AT+CSQ", .outBuf = buf, .bufLen = sizeof(buf), .timeout = 100};
+    uAT_TxnHandle_t handle;
+    uAT_TxnResult_t res;
+    uAT_TxnSubmit(&req, &handle);
+    dma_write("RING\r\n+CSQ: 21,99\r\n+CREG: 1\r\nOK\r\n", 33);
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_TxnPoll(handle, &res), "Transaction should finish");
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99\r\nOK\r\n", buf, "URCs should be kept out of the sink");
+    TEST_ASSERT_EQUAL_INT(2, (int)res.lineCount, "URCs should not be counted as response lines");
+    TEST_ASSERT_EQUAL_INT(2, (int)res.linesSkipped, "URCs should be counted as skipped");
+    TEST_ASSERT_EQUAL_INT(2, urc_hits, "URCs should still reach their handlers");
+    TEST_ASSERT_EQUAL_INT(1, csq.calls, "Response lines should still reach their handlers");
+
+    // A URC prefix echoing the command's name answers it
+    req.cmd = "AT+CREG?";
+    uAT_TxnSubmit(&req, &handle);
+    dma_write("+CREG: 0,1\r\nOK\r\n", 16);
+    rx_event();
+    uAT_TxnPoll(handle, &res);
+    TEST_ASSERT_EQUAL_STRING("+CREG: 0,1\r\nOK\r\n", buf, "Echoed name should be captured");
+    TEST_ASSERT_EQUAL_INT(0, (int)res.linesSkipped, "Echoed name should not be skipped");
+
+    // With an echo prefix only its lines are captured
+    req.cmd = "AT+CSQ";
+    req.echoPrefix = "+CSQ:";
+    uAT_TxnSubmit(&req, &handle);
+    dma_write("+QIURC: \"recv\",0\r\n+CSQ: 20,99\r\nERROR\r\n", 38);
+    rx_event();
+    uAT_TxnPoll(handle, &res);
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 20,99\r\nERROR\r\n", buf, "Lines without the echo prefix should be skipped");
+    TEST_ASSERT_EQUAL_INT(1, (int)res.linesSkipped, "Unregistered line should be counted as skipped");
+    TEST_ASSERT_EQUAL_INT(UAT_FINAL_ERROR, res.finalCode, "Final line should be captured without the prefix");
+
+    TEST_SUITE_END("RxEvent_URCCapture");
+}
+
+int main(void)
+{
+    printf("=== uAT ReceiveToIdle DMA Tests ===\n");
+    test_framework_init();
+
+    test_rx_event_init();
+    test_rx_event_idle();
+    test_rx_event_burst();
+    test_rx_event_dispatch();
+    test_rx_event_handler_ex();
+    test_rx_event_patterns();
+    test_rx_event_subscribers();
+    test_rx_event_snapshot();
+    test_rx_event_send_receive();
+    test_rx_event_send_receive_lines();
+    test_rx_event_txn_queue();
+    test_rx_event_txn_timeout();
+    test_rx_event_txn_submit_waits();
+    test_rx_event_txn_cancel_in_flight();
+    test_rx_event_terminators();
+    test_rx_event_send_async();
+    test_rx_event_txn_signals();
+    test_rx_event_final_codes();
+    test_rx_event_urc_capture();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,176 @@
+/**
+ * @file test_scan.c
+ * @brief Tests for the uAT scanning kernels
+ *
+ * This file contains unit tests for the word-at-a-time scanning functions.
+ * Every kernel is checked against a plain bytewise reference at all
+ * alignments and lengths, since the word loop only runs on aligned data.
+ */
+
+#include "test_framework.h"
+#include "uat_scan.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Bytewise reference for uAT_ScanByte
+static const char *ref_byte(const char *p, size_t len, char c)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (p[i] == c)
+        {
+            return p + i;
+        }
+    }
+    return NULL;
+}
+
+// Bytewise reference for uAT_ScanMarker
+static const char *ref_marker(const char *p, size_t len, const char *m, size_t mlen)
+{
+    for (size_t i = 0; i + mlen <= len; i++)
+    {
+        if (memcmp(p + i, m, mlen) == 0)
+        {
+            return p + i;
+        }
+    }
+    return NULL;
+}
+
+void test_uAT_ScanByte(void)
+{
+    TEST_SUITE_START("uAT_ScanByte");
+
+    const char *s = "+CREG: 1,5\r\nOK\r\n";
+    TEST_ASSERT_TRUE(uAT_ScanByte(s, strlen(s), '\n') == s + 11, "Should find first LF");
+    TEST_ASSERT_TRUE(uAT_ScanByte(s, strlen(s), '+') == s, "Should find match at start");
+    TEST_ASSERT_NULL(uAT_ScanByte(s, strlen(s), '#'), "Should return NULL when absent");
+    TEST_ASSERT_NULL(uAT_ScanByte(s, 0, '+'), "Should handle empty data");
+    TEST_ASSERT_NULL(uAT_ScanByte(NULL, 4, '+'), "Should handle null data");
+
+    // High bytes must not confuse the bit tricks
+    const char high[] = "\x80\xff\x7f\x01\x00\xfe\x81\x0a";
+    TEST_ASSERT_TRUE(uAT_ScanByte(high, 8, '\x00') == high + 4, "Should find NUL among high bytes");
+    TEST_ASSERT_TRUE(uAT_ScanByte(high, 8, '\x81') == high + 6, "Should find 0x81");
+    TEST_ASSERT_TRUE(uAT_ScanByte(high, 8, '\x0a') == high + 7, "Should find LF after high bytes");
+
+    // Exhaustive alignment and length sweep against the reference
+    char buf[80];
+    int mismatches = 0;
+    srand(1);
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (char)(rand() % 256);
+    }
+    for (size_t off = 0; off < 16; off++)
+    {
+        for (size_t len = 0; off + len <= sizeof(buf); len++)
+        {
+            for (int c = 0; c < 256; c += 17)
+            {
+                if (uAT_ScanByte(buf + off, len, (char)c) != ref_byte(buf + off, len, (char)c))
+                {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches, "Should match reference at every alignment and length");
+
+    TEST_SUITE_END("uAT_ScanByte");
+}
+
+void test_uAT_ScanByte2(void)
+{
+    TEST_SUITE_START("uAT_ScanByte2");
+
+    const char *s = "ABCDEFGHIJ\nKLMN\r";
+    TEST_ASSERT_TRUE(uAT_ScanByte2(s, strlen(s), '\r', '\n') == s + 10, "Should find whichever comes first");
+    TEST_ASSERT_TRUE(uAT_ScanByte2(s, strlen(s), '\r', 'Z') == s + 15, "Should find the second byte");
+    TEST_ASSERT_NULL(uAT_ScanByte2(s, strlen(s), 'x', 'y'), "Should return NULL when both absent");
+    TEST_ASSERT_NULL(uAT_ScanByte2(NULL, 4, 'x', 'y'), "Should handle null data");
+
+    int mismatches = 0;
+    char buf[64];
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (char)('a' + (i * 7) % 26);
+    }
+    for (size_t off = 0; off < 16; off++)
+    {
+        for (size_t len = 0; off + len <= sizeof(buf); len++)
+        {
+            const char *ra = ref_byte(buf + off, len, 'q');
+            const char *rb = ref_byte(buf + off, len, 'z');
+            const char *ref = (ra == NULL) ? rb : (rb == NULL || ra < rb) ? ra : rb;
+            if (uAT_ScanByte2(buf + off, len, 'q', 'z') != ref)
+            {
+                mismatches++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches, "Should match reference at every alignment and length");
+
+    TEST_SUITE_END("uAT_ScanByte2");
+}
+
+void test_uAT_ScanMarker(void)
+{
+    TEST_SUITE_START("uAT_ScanMarker");
+
+    const char *s = "AT+CMGS=\"123\"\r\r\n> ";
+    TEST_ASSERT_TRUE(uAT_ScanMarker(s, strlen(s), "\r\n", 2) == s + 14, "Should skip a lone CR");
+    TEST_ASSERT_TRUE(uAT_ScanMarker(s, strlen(s), UAT_SCAN_PROMPT, 2) == s + 16, "Should find the prompt");
+    TEST_ASSERT_NULL(uAT_ScanMarker(s, strlen(s) - 1, UAT_SCAN_PROMPT, 2), "Should not report a cut-off prompt");
+    TEST_ASSERT_NULL(uAT_ScanMarker("OK\r", 3, "\r\n", 2), "Should not report a cut-off terminator");
+    TEST_ASSERT_NULL(uAT_ScanMarker(s, strlen(s), NULL, 2), "Should handle null marker");
+    TEST_ASSERT_NULL(uAT_ScanMarker(s, strlen(s), "\r\n", 0), "Should handle empty marker");
+
+    int mismatches = 0;
+    const char *text = "OK\r\n+CSQ: 21,99\r\r\nERROR\r\n> > \r\n\r\n+CME ERROR: 10\r\n";
+    size_t tlen = strlen(text);
+    for (size_t off = 0; off < tlen; off++)
+    {
+        for (size_t len = 0; off + len <= tlen; len++)
+        {
+            if (uAT_ScanMarker(text + off, len, "\r\n", 2) != ref_marker(text + off, len, "\r\n", 2) ||
+                uAT_ScanMarker(text + off, len, "> ", 2) != ref_marker(text + off, len, "> ", 2))
+            {
+                mismatches++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches, "Should match reference for every window");
+
+    TEST_SUITE_END("uAT_ScanMarker");
+}
+
+void test_uAT_ScanBareCR(void)
+{
+    TEST_SUITE_START("uAT_ScanBareCR");
+
+    const char *s = "OK\r\nRING\rNEXT";
+    TEST_ASSERT_TRUE(uAT_ScanBareCR(s, strlen(s)) == s + 8, "Should skip CRLF and find bare CR");
+    TEST_ASSERT_NULL(uAT_ScanBareCR("OK\r\n", 4), "Should ignore CRLF");
+    TEST_ASSERT_NULL(uAT_ScanBareCR("OK\r", 3), "Should not decide on a trailing CR");
+    TEST_ASSERT_TRUE(uAT_ScanBareCR("\r\r\n", 3) != NULL, "Should find CR before CRLF");
+    TEST_ASSERT_NULL(uAT_ScanBareCR(NULL, 3), "Should handle null data");
+
+    TEST_SUITE_END("uAT_ScanBareCR");
+}
+
+int main(void)
+{
+    printf("=== uAT Scan Kernel Tests ===\n");
+    test_framework_init();
+
+    test_uAT_ScanByte();
+    test_uAT_ScanByte2();
+    test_uAT_ScanMarker();
+    test_uAT_ScanBareCR();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_static_handlers.c
+ * @brief Tests for build-time handler tables
+ *
+ * uat_freertos.c is built with UAT_STATIC_HANDLERS naming static_handlers.def
+ * (and UAT_DMA_RX_EVENT to feed it data) for this test. Lines are written
+ * into the DMA buffer, handed over with HAL_UARTEx_RxEventCallback() and
+ * dispatched by a single pass of uAT_Task, left with longjmp() when it
+ * blocks in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *last_handler;
+static char last_args[64];
+
+static void record(const char *name, const char *args)
+{
+    last_handler = name;
+    snprintf(last_args, sizeof(last_args), "%s", args);
+}
+
+// Handlers listed in static_handlers.def
+void c_handler(const char *args) { record("+C", args); }
+void cmti_handler(const char *args) { record("+CMTI:", args); }
+void creg_handler(const char *args) { record("+CREG", args); }
+void creg_colon_handler(const char *args) { record("+CREG:", args); }
+void csq_handler(const char *args) { record("+CSQ:", args); }
+void ring_handler(const char *args) { record("RING", args); }
+
+static void runtime_handler(const char *args)
+{
+    record("runtime", args);
+}
+
+// Receive one line and return the name of the handler it reached
+static const char *receive_line(const char *line)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s\r\n", line);
+
+    last_handler = NULL;
+    last_args[0] = '\0';
+    receive(buf);
+    return last_handler;
+}
+
+static void setup(void)
+{
+    task_harness_init();
+}
+
+static void assert_handler(const char *expected, const char *actual, const char *description)
+{
+    TEST_ASSERT_EQUAL_STRING(expected ? expected : "(none)", actual ? actual : "(none)", description);
+}
+
+void test_static_lookup(void)
+{
+    TEST_SUITE_START("Static_Lookup");
+
+    setup();
+    assert_handler("+CSQ:", receive_line("+CSQ: 21,99"), "Exact listed prefix should match");
+    TEST_ASSERT_EQUAL_STRING("21,99\r\n", last_args, "Arguments should follow the prefix");
+    assert_handler("RING", receive_line("RING"), "Line equal to a command should match");
+    assert_handler("+CMTI:", receive_line("+CMTI: \"SM\",3"), "First byte shared with others should match");
+
+    // Nested commands: the longest wins
+    assert_handler("+CREG:", receive_line("+CREG: 0,1"), "Longest nested prefix should win");
+    assert_handler("+CREG", receive_line("+CREGX"), "Shorter nested prefix should match");
+    assert_handler("+C", receive_line("+CMGS: 4"), "Shortest nested prefix should match");
+
+    // The closest command sorts between the line and its prefix
+    assert_handler("+C", receive_line("+CSA"), "Search should back off to a shared prefix");
+    assert_handler("+C", receive_line("+CRE"), "Line shorter than a command should not match it");
+
+    assert_handler(NULL, receive_line("OK"), "Unlisted line should not match");
+    assert_handler(NULL, receive_line("+"), "Line shorter than all commands should not match");
+    assert_handler(NULL, receive_line("ZZZ"), "Line after all commands should not match");
+
+    TEST_SUITE_END("Static_Lookup");
+}
+
+void test_static_overlay(void)
+{
+    TEST_SUITE_START("Static_Overlay");
+
+    setup();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+CREG:", runtime_handler), "Should register over a listed command");
+    assert_handler("runtime", receive_line("+CREG: 1"), "Runtime registration should override the table");
+    assert_handler("+CREG", receive_line("+CREGX"), "Other listed commands should still match");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_UnregisterCommand("+CREG:"), "Should unregister the override");
+    assert_handler("+CREG:", receive_line("+CREG: 1"), "Listed command should match again");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_NOT_FOUND, uAT_UnregisterCommand("+CSQ:"), "Listed commands cannot be unregistered");
+
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+QIRD:", runtime_handler), "Should register an unlisted command");
+    assert_handler("runtime", receive_line("+QIRD: 5"), "Unlisted runtime command should match");
+    TEST_ASSERT_EQUAL_STRING("5\r\n", last_args, "Runtime arguments should follow the prefix");
+
+    // The longest prefix wins across both tables
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+", runtime_handler), "Should register a catch-all");
+    assert_handler("+CSQ:", receive_line("+CSQ: 21,99"), "Longer listed command should win over a catch-all");
+    assert_handler("+C", receive_line("+CMGS: 4"), "Longer listed catch-all should win too");
+    assert_handler("runtime", receive_line("+QX"), "Catch-all should get lines nothing listed matches");
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterCommand("+C", runtime_handler), "Should register a short listed command");
+    assert_handler("runtime", receive_line("+CMGS: 4"), "Runtime registration of the same length should win");
+    assert_handler("+CREG:", receive_line("+CREG: 0,1"), "Longer listed command should still win");
+
+    TEST_SUITE_END("Static_Overlay");
+}
+
+int main(void)
+{
+    printf("=== uAT Static Handler Table Tests ===\n");
+    test_framework_init();
+
+    test_static_lookup();
+    test_static_overlay();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
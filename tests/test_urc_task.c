@@ -0,0 +1,150 @@
+/**
+ * @file test_urc_task.c
+ * @brief Tests for running URC handlers in uAT_URCTask
+ *
+ * uat_freertos.c is built with UAT_URC_TASK (and UAT_DMA_RX_EVENT to feed it
+ * data) for this test. uAT_Task and uAT_URCTask are each run for a single
+ * pass by leaving them with longjmp() when they block in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+static int csq_calls;
+static int cmti_calls;
+static char cmti_args[64];
+static int ring_seq[16];
+static int ring_calls;
+static TickType_t ring_tick;
+
+static void csq_handler(const char *args)
+{
+    (void)args;
+    csq_calls++;
+}
+
+static void cmti_handler(const char *args)
+{
+    snprintf(cmti_args, sizeof(cmti_args), "%s", args);
+    cmti_calls++;
+}
+
+// Each RING carries its sequence number
+static void ring_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    int *seq = ctx;
+    if (ring_calls < 16)
+    {
+        seq[ring_calls] = args[0] - '0';
+    }
+    ring_calls++;
+    ring_tick = tick;
+}
+
+// Also called from xSemaphoreTake() while uAT_Task waits for a free slot
+static void run_urc_task_once(void)
+{
+    run_handler_task_once(uAT_URCTask, NULL);
+}
+
+static void setup(void)
+{
+    csq_calls = 0;
+    cmti_calls = 0;
+    cmti_args[0] = '\0';
+    ring_calls = 0;
+    memset(ring_seq, 0, sizeof(ring_seq));
+    task_harness_init();
+}
+
+void test_urc_task_handoff(void)
+{
+    TEST_SUITE_START("URCTask_Handoff");
+
+    setup();
+    uAT_RegisterCommand("+CSQ:", csq_handler);
+    uAT_RegisterURC("+CMTI:", cmti_handler);
+
+    // Queued before uAT_URCTask has started
+    receive("+CMTI: \"SM\",3\r\n+CSQ: 21,99\r\n");
+    TEST_ASSERT_EQUAL_INT(1, csq_calls, "Response handler should run in uAT_Task");
+    TEST_ASSERT_EQUAL_INT(0, cmti_calls, "URC handler should not run in uAT_Task");
+
+    run_urc_task_once();
+    TEST_ASSERT_EQUAL_INT(1, cmti_calls, "URC task should run pending URCs when it starts");
+    TEST_ASSERT_EQUAL_STRING("\"SM\",3\r\n", cmti_args, "URC handler should get the arguments");
+
+    uint32_t notified = mock_task_notify_count;
+    receive("+CMTI: \"SM\",4\r\n");
+    TEST_ASSERT_EQUAL_INT((int)notified + 2, (int)mock_task_notify_count, "Queued URC should wake the URC task");
+    run_urc_task_once();
+    TEST_ASSERT_EQUAL_INT(2, cmti_calls, "Woken URC task should run the URC");
+    TEST_ASSERT_EQUAL_STRING("\"SM\",4\r\n", cmti_args, "Slot should hold the new arguments");
+
+    run_urc_task_once();
+    TEST_ASSERT_EQUAL_INT(2, cmti_calls, "URC should run only once");
+
+    TEST_SUITE_END("URCTask_Handoff");
+}
+
+void test_urc_task_order(void)
+{
+    TEST_SUITE_START("URCTask_Order");
+
+    setup();
+    TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_RegisterURCEx("RING", ring_handler, ring_seq), "Should register an extended URC");
+
+    mock_tick_count = 77;
+    receive("RING0\r\nRING1\r\nRING2\r\n");
+    TEST_ASSERT_EQUAL_INT(0, ring_calls, "URCs should wait for the URC task");
+    run_urc_task_once();
+    TEST_ASSERT_EQUAL_INT(3, ring_calls, "All queued URCs should run");
+    TEST_ASSERT_TRUE(ring_seq[0] == 0 && ring_seq[1] == 1 && ring_seq[2] == 2, "URCs should run in order");
+    TEST_ASSERT_EQUAL_INT(77, (int)ring_tick, "Receive tick should travel with the URC");
+
+    TEST_SUITE_END("URCTask_Order");
+}
+
+void test_urc_task_full(void)
+{
+    TEST_SUITE_START("URCTask_Full");
+
+    setup();
+    uAT_RegisterURCEx("RING", ring_handler, ring_seq);
+    run_urc_task_once();
+
+    // More URCs than slots: uAT_Task waits for the URC task instead of dropping
+    mock_semaphore_take_hook = run_urc_task_once;
+    receive("RING0\r\nRING1\r\nRING2\r\nRING3\r\nRING4\r\nRING5\r\nRING6\r\n");
+    mock_semaphore_take_hook = NULL;
+    run_urc_task_once();
+
+    TEST_ASSERT_EQUAL_INT(7, ring_calls, "No URC should be lost when the queue is full");
+    int in_order = 1;
+    for (int i = 0; i < 7; i++)
+    {
+        if (ring_seq[i] != i)
+        {
+            in_order = 0;
+        }
+    }
+    TEST_ASSERT_TRUE(in_order, "URCs should run in order across a full queue");
+
+    TEST_SUITE_END("URCTask_Full");
+}
+
+int main(void)
+{
+    printf("=== uAT URC Task Tests ===\n");
+    test_framework_init();
+
+    test_urc_task_handoff();
+    test_urc_task_order();
+    test_urc_task_full();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
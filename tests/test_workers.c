@@ -0,0 +1,303 @@
+/**
+ * @file test_workers.c
+ * @brief Tests for running command handlers on worker tasks
+ *
+ * uat_freertos.c is built with UAT_WORKER_TASKS=2 and UAT_URC_TASK (and
+ * UAT_DMA_RX_EVENT to feed it data) for this test. uAT_Task and each worker
+ * are run for a single pass by leaving them with longjmp() when they block
+ * in xTaskNotifyWait().
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static int csq_calls;
+static char csq_args[64];
+static int ring_calls;
+static int seq[16];
+static int seq_calls;
+static TickType_t seq_tick;
+
+static void csq_handler(const char *args)
+{
+    snprintf(csq_args, sizeof(csq_args), "%s", args);
+    csq_calls++;
+}
+
+static void ring_handler(const char *args)
+{
+    (void)args;
+    ring_calls++;
+}
+
+// Each line carries its sequence number
+static void seq_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    int *out = ctx;
+    if (seq_calls < 16)
+    {
+        out[seq_calls] = args[0] - '0';
+    }
+    seq_calls++;
+    seq_tick = tick;
+}
+
+// Replacement for seq_handler, records into the same array
+static void seq_handler_b(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    seq_handler(args, len, ctx, tick);
+}
+
+// Subscribers: each records where its view of the line starts
+static int sub_calls[3];
+static const char *sub_args[3];
+
+static void sub_record(int id, const char *args)
+{
+    sub_calls[id]++;
+    sub_args[id] = args;
+}
+
+static void sub_a(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    (void)ctx;
+    (void)tick;
+    sub_record(0, args);
+}
+
+static void sub_b(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    (void)ctx;
+    (void)tick;
+    sub_record(1, args);
+}
+
+static void sub_c(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)len;
+    (void)ctx;
+    (void)tick;
+    sub_record(2, args);
+}
+
+static void run_workers_once(void)
+{
+    for (uintptr_t i = 0; i < UAT_WORKER_TASKS; i++)
+    {
+        run_handler_task_once(uAT_WorkerTask, (void *)i);
+    }
+}
+
+static uint32_t total_queued(void)
+{
+    uAT_WorkerStats_t stats;
+    uint32_t queued = 0;
+    for (uint32_t i = 0; i < UAT_WORKER_TASKS; i++)
+    {
+        uAT_GetWorkerStats(i, &stats);
+        queued += stats.queued;
+    }
+    return queued;
+}
+
+static void setup(void)
+{
+    csq_calls = 0;
+    csq_args[0] = '\0';
+    ring_calls = 0;
+    seq_calls = 0;
+    memset(seq, 0, sizeof(seq));
+    memset(sub_calls, 0, sizeof(sub_calls));
+    task_harness_init();
+}
+
+void test_workers_handoff(void)
+{
+    TEST_SUITE_START("Workers_Handoff");
+
+    setup();
+    uAT_RegisterCommand("+CSQ:", csq_handler);
+
+    receive("+CSQ: 21,99\r\n");
+    TEST_ASSERT_EQUAL_INT(0, csq_calls, "Handler should not run in uAT_Task");
+    TEST_ASSERT_EQUAL_INT(1, (int)total_queued(), "Line should be queued to a worker");
+
+    run_workers_once();
+    TEST_ASSERT_EQUAL_INT(1, csq_calls, "Worker should run the handler");
+    TEST_ASSERT_EQUAL_STRING("21,99\r\n", csq_args, "Handler should get the arguments");
+    TEST_ASSERT_EQUAL_INT(0, (int)total_queued(), "Queue should be empty again");
+
+    run_workers_once();
+    TEST_ASSERT_EQUAL_INT(1, csq_calls, "Handler should run only once");
+
+    TEST_SUITE_END("Workers_Handoff");
+}
+
+void test_workers_order(void)
+{
+    TEST_SUITE_START("Workers_Order");
+
+    setup();
+    uAT_RegisterCommandEx("+QIRD:", seq_handler, seq);
+
+    mock_tick_count = 42;
+    receive("+QIRD: 0\r\n+QIRD: 1\r\n+QIRD: 2\r\n");
+
+    // All lines for one handler wait for the same worker
+    uAT_WorkerStats_t stats[UAT_WORKER_TASKS];
+    int busy = 0;
+    for (uint32_t i = 0; i < UAT_WORKER_TASKS; i++)
+    {
+        uAT_GetWorkerStats(i, &stats[i]);
+        if (stats[i].queued == 3)
+        {
+            busy++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(1, busy, "One worker should hold every line of the handler");
+
+    run_workers_once();
+    TEST_ASSERT_EQUAL_INT(3, seq_calls, "All lines should be handled");
+    TEST_ASSERT_TRUE(seq[0] == 0 && seq[1] == 1 && seq[2] == 2, "Lines should be handled in order");
+    TEST_ASSERT_EQUAL_INT(42, (int)seq_tick, "Receive tick should travel with the line");
+
+    // A new handler for the command takes over the same worker
+    seq_calls = 0;
+    receive("+QIRD: 0\r\n+QIRD: 1\r\n");
+    uAT_RegisterCommandEx("+QIRD:", seq_handler_b, seq);
+    receive("+QIRD: 2\r\n");
+    busy = 0;
+    for (uint32_t i = 0; i < UAT_WORKER_TASKS; i++)
+    {
+        uAT_GetWorkerStats(i, &stats[i]);
+        if (stats[i].queued == 3)
+        {
+            busy++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(1, busy, "Replaced handler should keep the command's worker");
+    run_workers_once();
+    TEST_ASSERT_TRUE(seq_calls == 3 && seq[0] == 0 && seq[1] == 1 && seq[2] == 2, "Lines should stay in order across a replacement");
+
+    TEST_SUITE_END("Workers_Order");
+}
+
+void test_workers_urc(void)
+{
+    TEST_SUITE_START("Workers_URC");
+
+    setup();
+    uAT_RegisterURC("RING", ring_handler);
+
+    receive("RING\r\n");
+    TEST_ASSERT_EQUAL_INT(0, (int)total_queued(), "URC should not be queued to a worker");
+    run_handler_task_once(uAT_URCTask, NULL);
+    TEST_ASSERT_EQUAL_INT(1, ring_calls, "URC task should run the URC");
+
+    TEST_SUITE_END("Workers_URC");
+}
+
+void test_workers_full(void)
+{
+    TEST_SUITE_START("Workers_Full");
+
+    setup();
+    uAT_RegisterCommandEx("+QIRD:", seq_handler, seq);
+    run_workers_once();
+
+    // More lines than one queue holds: uAT_Task waits for the worker
+    mock_semaphore_take_hook = run_workers_once;
+    receive("+QIRD: 0\r\n+QIRD: 1\r\n+QIRD: 2\r\n+QIRD: 3\r\n+QIRD: 4\r\n+QIRD: 5\r\n");
+    mock_semaphore_take_hook = NULL;
+    run_workers_once();
+
+    TEST_ASSERT_EQUAL_INT(6, seq_calls, "No line should be lost when a queue is full");
+    int in_order = 1;
+    for (int i = 0; i < 6; i++)
+    {
+        if (seq[i] != i)
+        {
+            in_order = 0;
+        }
+    }
+    TEST_ASSERT_TRUE(in_order, "Lines should be handled in order across a full queue");
+
+    uAT_WorkerStats_t stats;
+    uint32_t stalls = 0;
+    uint32_t highWater = 0;
+    for (uint32_t i = 0; i < UAT_WORKER_TASKS; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(UAT_OK, uAT_GetWorkerStats(i, &stats), "Should read worker stats");
+        TEST_ASSERT_EQUAL_INT(UAT_WORKER_QUEUE_LEN, (int)stats.queueLen, "Queue length should be reported");
+        stalls += stats.stalls;
+        if (stats.highWater > highWater)
+        {
+            highWater = stats.highWater;
+        }
+    }
+    TEST_ASSERT_TRUE(stalls >= 1, "Waiting for a full queue should be counted");
+    TEST_ASSERT_EQUAL_INT(UAT_WORKER_QUEUE_LEN, (int)highWater, "High water should reach the queue length");
+
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetWorkerStats(UAT_WORKER_TASKS, &stats), "Unknown worker should be rejected");
+    TEST_ASSERT_EQUAL_INT(UAT_ERR_INVALID_ARG, uAT_GetWorkerStats(0, NULL), "NULL stats should be rejected");
+
+    TEST_SUITE_END("Workers_Full");
+}
+
+void test_workers_subscribers(void)
+{
+    TEST_SUITE_START("Workers_Subscribers");
+
+    setup();
+    uAT_Subscribe("+QIURC:", sub_a, NULL);
+    uAT_Subscribe("+QIURC:", sub_b, NULL);
+    uAT_Subscribe("+QIURC:", sub_c, NULL);
+
+    receive("+QIURC: \"recv\",0\r\n");
+    TEST_ASSERT_EQUAL_INT(3, (int)total_queued(), "Line should be queued once per subscriber");
+    run_workers_once();
+    TEST_ASSERT_TRUE(sub_calls[0] == 1 && sub_calls[1] == 1 && sub_calls[2] == 1, "Every subscriber should get the line");
+    TEST_ASSERT_TRUE(sub_args[0] == sub_args[1] && sub_args[1] == sub_args[2], "Subscribers should share one copy of the line");
+    TEST_ASSERT_EQUAL_STRING("\"recv\",0\r\n", sub_args[0], "Shared copy should hold the arguments");
+
+    // Buffers come back to the pool once every subscriber has run
+    mock_semaphore_take_hook = run_workers_once;
+    for (int i = 0; i < 2 * UAT_LINE_POOL_SIZE; i++)
+    {
+        receive("+QIURC: \"recv\",1\r\n");
+    }
+    mock_semaphore_take_hook = NULL;
+    run_workers_once();
+    int all = 1;
+    for (int i = 0; i < 3; i++)
+    {
+        if (sub_calls[i] != 1 + 2 * UAT_LINE_POOL_SIZE)
+        {
+            all = 0;
+        }
+    }
+    TEST_ASSERT_TRUE(all, "Lines beyond the pool size should reach every subscriber");
+
+    TEST_SUITE_END("Workers_Subscribers");
+}
+
+int main(void)
+{
+    printf("=== uAT Worker Task Tests ===\n");
+    test_framework_init();
+
+    test_workers_handoff();
+    test_workers_order();
+    test_workers_urc();
+    test_workers_full();
+    test_workers_subscribers();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}
@@ -0,0 +1,331 @@
+/**
+ * @file test_zero_copy.c
+ * @brief Tests for zero-copy line extraction from the circular DMA buffer
+ *
+ * uat_freertos.c is built with UAT_DMA_ZERO_COPY and UAT_DMA_RX_EVENT for this
+ * test, with a 64 byte DMA buffer and UAT_RX_BUFFER_SIZE of 32 so lines wrap
+ * the ring and overrun it within a few writes. As in test_rx_event.c, the test
+ * plays the DMA controller by writing into the buffer handed to the mocked
+ * ReceiveToIdle start and raises HAL_UARTEx_RxEventCallback() the way HAL
+ * does. uAT_Task is run for a single pass after each event by leaving it with
+ * longjmp() when it blocks in xTaskNotifyWait(), unless the test stalls it to
+ * let the DMA run ahead.
+ */
+
+#include "test_framework.h"
+#include "task_harness.h"
+#include <stdio.h>
+#include <string.h>
+
+static size_t dma_pos;     // Simulated DMA write position
+static bool task_stalled;  // Events are raised but uAT_Task does not get to run
+
+// Extended handler: records every view it was given
+typedef struct
+{
+    int calls;
+    char args[8][32];
+    size_t len;
+    bool inRing;
+} view_record_t;
+
+static view_record_t rec;
+
+// Called from inside the handler on its first call, e.g. to let the DMA run on
+static void (*during_handler)(const char *args, size_t len);
+
+static bool in_ring(const char *p)
+{
+    return p >= (const char *)mock_uart_rx_buf && p < (const char *)mock_uart_rx_buf + mock_uart_rx_size;
+}
+
+static void view_handler(const char *args, size_t len, void *ctx, TickType_t tick)
+{
+    (void)ctx;
+    (void)tick;
+    if (rec.calls < 8)
+    {
+        snprintf(rec.args[rec.calls], sizeof(rec.args[0]), "%.*s", (int)len, args);
+    }
+    rec.calls++;
+    rec.len = len;
+    rec.inRing = in_ring(args);
+
+    if (during_handler != NULL)
+    {
+        void (*hook)(const char *, size_t) = during_handler;
+        during_handler = NULL;
+        hook(args, len);
+    }
+}
+
+static void rx_event(void)
+{
+    HAL_UARTEx_RxEventCallback(&test_huart, (uint16_t)dma_pos);
+    if (!task_stalled)
+    {
+        run_task_once();
+    }
+}
+
+// Write data into the DMA buffer, raising HT/TC events as the DMA would
+static void dma_write(const char *data)
+{
+    size_t len = strlen(data);
+    for (size_t i = 0; i < len; i++)
+    {
+        mock_uart_rx_buf[dma_pos++] = (uint8_t)data[i];
+
+        if (dma_pos == mock_uart_rx_size / 2)
+        {
+            rx_event(); // Half transfer
+        }
+        else if (dma_pos == mock_uart_rx_size)
+        {
+            rx_event(); // Transfer complete
+            dma_pos = 0;
+        }
+    }
+}
+
+// Data followed by an idle line
+static void dma_receive(const char *data)
+{
+    dma_write(data);
+    rx_event();
+}
+
+// Receive unhandled lines until the DMA reaches pos
+static void fill_to(size_t pos)
+{
+    while (dma_pos != pos)
+    {
+        size_t n = (pos + mock_uart_rx_size - dma_pos) % mock_uart_rx_size;
+        char line[16];
+        if (n > 12)
+        {
+            n = 10;
+        }
+        memset(line, 'Z', n - 2);
+        memcpy(&line[n - 2], "\r\n", 3);
+        dma_receive(line);
+    }
+}
+
+static void setup(void)
+{
+    dma_pos = 0;
+    task_stalled = false;
+    during_handler = NULL;
+    memset(&rec, 0, sizeof(rec));
+    task_harness_init();
+    uAT_RegisterCommandEx("+QIRD:", view_handler, NULL);
+}
+
+void test_zero_copy_in_place(void)
+{
+    TEST_SUITE_START("ZeroCopy_InPlace");
+
+    setup();
+    TEST_ASSERT_EQUAL_INT(UAT_DMA_RX_SIZE, mock_uart_rx_size, "Init should start DMA on the whole ring");
+
+    dma_receive("+QIRD: 0123456789\r\n");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Line should be dispatched");
+    TEST_ASSERT_EQUAL_STRING("0123456789", rec.args[0], "Handler should get the arguments");
+    TEST_ASSERT_TRUE(rec.inRing, "Line should be viewed in place in the DMA buffer");
+
+    // The half-transfer event comes in the middle of this line
+    dma_receive("+QIRD: abcdefghij\r\n");
+    TEST_ASSERT_EQUAL_INT(2, rec.calls, "Line across the half-transfer event should be dispatched once");
+    TEST_ASSERT_EQUAL_STRING("abcdefghij", rec.args[1], "Line should be joined across events");
+    TEST_ASSERT_TRUE(rec.inRing, "Line should still be viewed in place");
+
+    // 38 + 27 bytes run past the end of the ring
+    dma_receive("+QIRD: abcdefghijklmnopqr\r\n");
+    TEST_ASSERT_EQUAL_INT(1, (int)dma_pos, "Line should have wrapped the ring");
+    TEST_ASSERT_EQUAL_INT(3, rec.calls, "Wrapped line should be dispatched once");
+    TEST_ASSERT_EQUAL_STRING("abcdefghijklmnopqr", rec.args[2], "Wrapped line should be stitched in order");
+    TEST_ASSERT_FALSE(rec.inRing, "Wrapped line should be viewed from the stitch buffer");
+
+    dma_receive("+QIRD: 1\r\n");
+    TEST_ASSERT_EQUAL_STRING("1", rec.args[3], "Line after the wrap should be dispatched");
+    TEST_ASSERT_TRUE(rec.inRing, "Line after the wrap should be viewed in place again");
+
+    uAT_RxStats_t stats;
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.dmaOverruns, "Nothing should be overrun");
+    TEST_ASSERT_EQUAL_INT(75, (int)stats.bytesReceived, "Every byte should be counted once");
+
+    TEST_SUITE_END("ZeroCopy_InPlace");
+}
+
+void test_zero_copy_split_terminator(void)
+{
+    TEST_SUITE_START("ZeroCopy_SplitTerminator");
+
+    // CR is the last byte of the ring, LF the first
+    setup();
+    fill_to(51);
+    dma_write("+QIRD: split\r");
+    TEST_ASSERT_EQUAL_INT(0, (int)dma_pos, "CR should end the lap");
+    TEST_ASSERT_EQUAL_INT(0, rec.calls, "Line should wait for the rest of its terminator");
+    dma_receive("\n");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Line should end on the LF after the wrap");
+    TEST_ASSERT_EQUAL_STRING("split", rec.args[0], "Arguments should stop before the terminator");
+    TEST_ASSERT_EQUAL_INT(5, (int)rec.len, "Terminator should not be part of the arguments");
+
+    // A lone LF before the CR does not end a line
+    dma_receive("+QIRD: a\nb\r\n");
+    TEST_ASSERT_EQUAL_INT(2, rec.calls, "Only CRLF should end a line");
+    TEST_ASSERT_EQUAL_STRING("a\nb", rec.args[1], "Lone LF should stay in the line");
+
+    // Prompt split across the wrap
+    fill_to(63);
+    dma_write(">");
+    dma_receive(" ");
+    uAT_RxStats_t stats;
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.resyncs, "Nothing should be lost");
+    dma_receive("+QIRD: 2\r\n");
+    TEST_ASSERT_EQUAL_STRING("2", rec.args[2], "Prompt should not be joined to the next line");
+
+    TEST_SUITE_END("ZeroCopy_SplitTerminator");
+}
+
+void test_zero_copy_overrun(void)
+{
+    TEST_SUITE_START("ZeroCopy_Overrun");
+
+    setup();
+    uAT_RxStats_t stats;
+
+    // The task is held up while the DMA laps it
+    task_stalled = true;
+    for (int i = 0; i < 7; i++)
+    {
+        dma_write("+QIRD: 0\r\n");
+    }
+    dma_write("+QIRD: 7");
+    rx_event();
+    task_stalled = false;
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaOverruns, "Lap over unparsed data should be counted");
+
+    run_task_once();
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.resyncs, "Task should resync after the overrun");
+    TEST_ASSERT_EQUAL_INT(0, rec.calls, "Overwritten lines should not be dispatched");
+
+    // Parsing resumes after the line the overrun cut
+    dma_receive("\r\n+QIRD: 8\r\n");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Cut line should be dropped, the next one dispatched");
+    TEST_ASSERT_EQUAL_STRING("8", rec.args[0], "Line after the resync should be intact");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaOverruns, "No further overrun");
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.resyncs, "No further resync");
+
+    TEST_SUITE_END("ZeroCopy_Overrun");
+}
+
+void test_zero_copy_over_length(void)
+{
+    TEST_SUITE_START("ZeroCopy_OverLength");
+
+    setup();
+    uAT_RxStats_t stats;
+
+    // Longer than UAT_RX_BUFFER_SIZE, and wrapping the ring on the way
+    fill_to(40);
+    dma_receive("+QIRD: xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\r\n");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, rec.calls, "Over-length line should not be dispatched");
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.linesTruncated, "Over-length line should be counted");
+
+    dma_receive("+QIRD: 9\r\n");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Line after the dropped one should be dispatched");
+    TEST_ASSERT_EQUAL_STRING("9", rec.args[0], "Line after the dropped one should be intact");
+
+    // Dropped up to its terminator even when the CR lands on the cut
+    dma_receive("+QIRD: yyyyyyyyyyyyyyyyyyyyyyyy\r\n");
+    dma_receive("+QIRD: 10\r\n");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, (int)stats.linesTruncated, "Line filling the buffer should be counted");
+    TEST_ASSERT_EQUAL_INT(2, rec.calls, "Only the line after it should be dispatched");
+    TEST_ASSERT_EQUAL_STRING("10", rec.args[1], "Line after the cut should be intact");
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.resyncs, "Dropping a long line is not a resync");
+
+    TEST_SUITE_END("ZeroCopy_OverLength");
+}
+
+// The DMA keeps receiving while the handler runs, short of a lap
+static void dma_short_of_lap(const char *args, size_t len)
+{
+    task_stalled = true;
+    dma_write("+QIRD: 1\r\n+QIRD: 2\r\n+QIRD: 3\r\n+QIRD: 4\r\n");
+    rx_event();
+    task_stalled = false;
+    rec.inRing = rec.inRing && len == 1 && args[0] == '0';
+}
+
+// The DMA laps the line being handled and the one after it
+static void dma_lap(const char *args, size_t len)
+{
+    (void)args;
+    (void)len;
+    task_stalled = true;
+    for (int i = 0; i < 6; i++)
+    {
+        dma_write("+QIRD: 9\r\n");
+    }
+    task_stalled = false;
+}
+
+void test_zero_copy_handler_overwrite(void)
+{
+    TEST_SUITE_START("ZeroCopy_HandlerOverwrite");
+
+    setup();
+    uAT_RxStats_t stats;
+
+    // Bytes are not given back to the DMA before the handler returns
+    during_handler = dma_short_of_lap;
+    dma_receive("+QIRD: 0\r\n");
+    TEST_ASSERT_TRUE(rec.inRing, "View should stay intact while the DMA runs on");
+    run_task_once();
+    TEST_ASSERT_EQUAL_INT(5, rec.calls, "Lines received during the handler should follow");
+    TEST_ASSERT_EQUAL_STRING("4", rec.args[4], "Lines received during the handler should be intact");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, (int)stats.dmaOverruns, "Less than a lap is no overrun");
+
+    // A lap during the handler is caught before the next line is dispatched
+    setup();
+    during_handler = dma_lap;
+    dma_receive("+QIRD: 0\r\n+QIRD: 1\r\n");
+    uAT_GetRxStats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.dmaOverruns, "Lap over the line being handled should be counted");
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.resyncs, "Task should resync before the next line");
+    TEST_ASSERT_EQUAL_INT(1, rec.calls, "Overwritten line should not be dispatched");
+
+    rx_event();
+    TEST_ASSERT_EQUAL_INT(2, rec.calls, "Lines after the resync should be dispatched");
+    TEST_ASSERT_EQUAL_STRING("9", rec.args[1], "Lines after the resync should be intact");
+    dma_receive("+QIRD: 2\r\n");
+    TEST_ASSERT_EQUAL_STRING("2", rec.args[2], "Reception should continue after the lap");
+
+    TEST_SUITE_END("ZeroCopy_HandlerOverwrite");
+}
+
+int main(void)
+{
+    printf("=== uAT Zero-Copy DMA Tests ===\n");
+    test_framework_init();
+
+    test_zero_copy_in_place();
+    test_zero_copy_split_terminator();
+    test_zero_copy_overrun();
+    test_zero_copy_over_length();
+    test_zero_copy_handler_overwrite();
+
+    test_framework_summary();
+    return test_framework_get_result();
+}